@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+namespace redman {
+namespace detail {
+
+/** Replace `file` by `content` atomically.
+ *  Writes and syncs a uniquely named temporary file in the same directory
+ *  first and renames it, so that readers never see partial files, even
+ *  after a crash, and concurrent writers, also in other processes, do not
+ *  interfere.  The replaced file's mode is kept, new files are created
+ *  with the mode given by the umask.
+ */
+void replace_file(std::string const& file, std::string const& content);
+
+} // detail
+} // redman
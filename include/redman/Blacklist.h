@@ -7,11 +7,18 @@
 
 #include "redman/Policy.h"
 
+#ifndef PYPLUSPLUS
+#include "redman/storage/algorithm.h"
+#endif // PYPLUSPLUS
+
 namespace redman {
 
 struct Blacklist :
 	public Policy
 {
+	/// The selection holds the disabled resources.
+	static bool const stores_enabled = false;
+
 	template<typename Set, typename Predicate>
 	static
 	void enable_all(Set& set, Predicate const&)
@@ -24,11 +31,7 @@ struct Blacklist :
 	void disable_all(Set& set, Predicate const& predicate)
 	{
 #ifndef PYPLUSPLUS
-		set.clear();
-		for (auto res : predicate)
-		{
-			set.insert(res);
-		}
+		storage::fill(set, predicate);
 #endif // PYPLUSPLUS
 	}
 
@@ -36,68 +39,182 @@ struct Blacklist :
 	static
 	bool has(Set const& set, typename Set::const_reference val)
 	{
-		if (set.find(val) == set.end())
-			return true;
-		return false;
+		return set.count(val) == 0;
 	}
 
 	template<typename Set>
 	static
 	void enable(Set& set, typename Set::const_reference val, switch_mode::type mode = switch_mode::THROW)
 	{
-		typename Set::const_iterator it = set.find(val);
-		if (it == set.end()) {
+		if (set.erase(val) == 0) {
 			if (mode == switch_mode::NONTHROW) return;
 			std::stringstream error_msg;
 			error_msg << "could not enable resource: " << val;
 			throw std::runtime_error(error_msg.str().c_str());
 		}
-		set.erase(it);
 	}
 
 	template<typename Set>
 	static
 	void disable(Set& set, typename Set::const_reference val, switch_mode::type mode = switch_mode::THROW)
 	{
-		std::pair<typename Set::iterator, bool> r = set.insert(val);
-		if ((mode == switch_mode::THROW) && !r.second) {
+		bool const inserted = set.insert(val).second;
+		if ((mode == switch_mode::THROW) && !inserted) {
 			std::stringstream error_msg;
 			error_msg << "could not disable resource: " << val;
 			throw std::runtime_error(error_msg.str().c_str());
 		}
 	}
 
+	template<typename Set>
+	static
+	size_t available(Set const& set, size_t const cardinality)
+	{
+		return cardinality - set.size();
+	}
+
+	template<typename Set, typename Predicate, typename Other>
+	static
+	void from_set(
+		Set& set,
+		Predicate const& predicate,
+		Other const& other)
+	{
+#ifndef PYPLUSPLUS
+		storage::assign_complement(set, other, predicate);
+#endif // PYPLUSPLUS
+	}
+
+#ifndef PYPLUSPLUS
+	/// Enable a sorted range of distinct resources, return the number changed.
+	template<typename Set, typename InputIterator>
+	static
+	size_t enable_many(Set& set, InputIterator first, InputIterator last)
+	{
+		return storage::erase_many(set, first, last);
+	}
+
+	/// Disable a sorted range of distinct resources, return the number changed.
+	template<typename Set, typename InputIterator>
+	static
+	size_t disable_many(Set& set, InputIterator first, InputIterator last)
+	{
+		return storage::insert_many(set, first, last);
+	}
+
+	/* Order statistics on the enabled resources, i.e. the resources
+	   accepted by the predicate minus the selection.  Counting and searching
+	   valid indices is constant time for `DefaultPredicate` and predicates
+	   with a validity mask, the selection is queried per stored resource. */
+
+	template<typename Set, typename Predicate>
+	static
+	size_t rank(Set const& set, Predicate const& predicate, typename Set::const_reference val)
+	{
+		typedef redman::detail::ResourceIndex<typename Set::value_type> index_mapping;
+		return redman::detail::PredicateScan<Predicate>::rank(predicate, index_mapping::get(val)) -
+		       storage::rank(set, val);
+	}
+
+	/// Binary search for the first index preceded by more than `k` enabled resources.
+	template<typename Set, typename Predicate>
+	static
+	typename Set::value_type select(Set const& set, Predicate const& predicate, size_t k)
+	{
+		typedef typename Set::value_type resource_type;
+		typedef redman::detail::ResourceIndex<resource_type> index_mapping;
+		typedef typename Predicate::index_type index_type;
+		typedef typename index_type::value_type index_value_type;
+		typedef redman::detail::PredicateScan<Predicate> scan;
+
+		index_value_type lo = index_type::begin;
+		index_value_type hi = index_type::end - 1;
+		while (lo < hi) {
+			index_value_type const mid = lo + (hi - lo) / 2;
+			resource_type const next = index_mapping::make(mid + 1);
+			size_t const before = scan::rank(predicate, mid + 1) - storage::rank(set, next);
+			if (before > k)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return index_mapping::make(lo);
+	}
+
+	template<typename Set, typename Predicate>
+	static
+	boost::optional<typename Set::value_type>
+	next(Set const& set, Predicate const& predicate, typename Set::const_reference val)
+	{
+		typedef redman::detail::ResourceIndex<typename Set::value_type> index_mapping;
+		typedef redman::detail::PredicateScan<Predicate> scan;
+		typedef typename Predicate::index_type index_type;
+
+		for (auto idx = scan::next(predicate, index_mapping::get(val) + 1);
+		     idx < index_type::end; idx = scan::next(predicate, idx + 1)) {
+			auto const res = index_mapping::make(idx);
+			if (!set.count(res))
+				return res;
+		}
+		return boost::none;
+	}
+
 	template<typename Set, typename Predicate>
 	static
-	size_t available(Set const& set, Predicate const& pred)
+	boost::optional<typename Set::value_type>
+	prev(Set const& set, Predicate const& predicate, typename Set::const_reference val)
 	{
-		size_t all = 0;
+		typedef redman::detail::ResourceIndex<typename Set::value_type> index_mapping;
+		typedef redman::detail::PredicateScan<Predicate> scan;
+		typedef typename Predicate::index_type index_type;
+
+		for (auto idx = scan::prev(predicate, index_mapping::get(val));
+		     idx != index_type::end; idx = scan::prev(predicate, idx)) {
+			auto const res = index_mapping::make(idx);
+			if (!set.count(res))
+				return res;
+		}
+		return boost::none;
+	}
+#endif // PYPLUSPLUS
+
+	/* Set algebra on the enabled resources of two managers sharing the same
+	   predicate, expressed in terms of their selections of disabled
+	   resources (E = P \ D). */
 
+	template<typename Set, typename Predicate>
+	static
+	void merge(Set& set, Set const& other, Predicate const&)
+	{
+#ifndef PYPLUSPLUS
+		storage::intersection(set, other);
+#endif // PYPLUSPLUS
+	}
 
+	template<typename Set, typename Predicate>
+	static
+	void intersection(Set& set, Set const& other, Predicate const&)
+	{
 #ifndef PYPLUSPLUS
-		for (auto it = begin(pred); it != end(pred); ++it)
-			++all;
+		storage::merge(set, other);
 #endif // PYPLUSPLUS
+	}
 
-		return all - set.size();
+	template<typename Set, typename Predicate>
+	static
+	void difference(Set& set, Set const& other, Predicate const& predicate)
+	{
+#ifndef PYPLUSPLUS
+		storage::merge_complement(set, other, predicate);
+#endif // PYPLUSPLUS
 	}
 
 	template<typename Set, typename Predicate>
 	static
-	void from_set(
-		Set& set,
-		Predicate const& predicate,
-		Set const& other)
+	void symmetric_difference(Set& set, Set const& other, Predicate const& predicate)
 	{
 #ifndef PYPLUSPLUS
-		disable_all(set, predicate);
-		Set res;
-		std::set_difference(
-			set.begin(), set.end(),
-			other.begin(), other.end(),
-			std::inserter(res, res.begin()),
-			typename Set::key_compare());
-		set = std::move(res);
+		storage::symmetric_difference_complement(set, other, predicate);
 #endif // PYPLUSPLUS
 	}
 };
@@ -0,0 +1,451 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#include <boost/optional.hpp>
+
+#include "redman/ResourceManager.h"
+
+/* Lazy set algebra on the enabled resources of resource managers.
+ * Combining managers with `&`, `|`, `-` and `^` builds an expression tree
+ * instead of copying and modifying managers.  Queries on an expression are
+ * answered in a single pass over the resources of the operand that bounds
+ * the result, testing membership in the other operands on the fly:
+ * \code
+ * auto const usable = (neurons & analog) - merger_blacklist;
+ * size_t const n = usable.count();
+ * bool const ok = usable.is_subset_of(other);
+ * \endcode
+ * Expressions store references to the managers they are built from, which
+ * therefore have to outlive them and must not be modified meanwhile.
+ * All operands have to manage the same resource type, ordered by
+ * `std::less`.
+ */
+
+namespace redman {
+namespace expression {
+
+/** Base class of all expressions, provides the queries.
+ *  Derived classes implement
+ *  - `bool contains(resource_type const&) const`,
+ *  - `cursor_type cursor() const`, a cursor at the smallest resource and
+ *  - `size_t bound() const`, an upper bound of the number of resources.
+ *
+ *  Cursors visit the resources of the result in order, they provide
+ *  `bool done() const`, `resource_type value() const` and `void advance()`.
+ *  A cursor refers to the expression it was obtained from.
+ */
+template<typename Derived>
+struct Expression
+{
+	Derived const& derived() const
+	{
+		return static_cast<Derived const&>(*this);
+	}
+
+	/// Number of resources in the result.
+	size_t count() const
+	{
+		size_t n = 0;
+		for (auto cur = derived().cursor(); !cur.done(); cur.advance())
+			++n;
+		return n;
+	}
+
+	/// Whether the result contains any resource, stops at the first one.
+	bool any() const
+	{
+		return !derived().cursor().done();
+	}
+
+	/// Whether every resource of the result is contained in `other`.
+	template<typename Other>
+	bool is_subset_of(Other const& other) const;
+
+	/// Whether the result shares at least one resource with `other`.
+	template<typename Other>
+	bool overlaps(Other const& other) const;
+};
+
+/// Leaf of an expression, the enabled resources of a manager.
+template<typename Manager>
+class Operand :
+	public Expression<Operand<Manager> >
+{
+public:
+	typedef typename Manager::resource resource_type;
+
+	/// Walks the enabled resources with the manager's iterator.
+	class Cursor
+	{
+	public:
+		explicit Cursor(Manager const& manager) :
+			mIt(manager.begin()), mEnd(manager.end())
+		{}
+
+		bool done() const
+		{
+			return mIt == mEnd;
+		}
+
+		resource_type value() const
+		{
+			return *mIt;
+		}
+
+		void advance()
+		{
+			++mIt;
+		}
+
+	private:
+		typename Manager::iterator_type mIt;
+		typename Manager::iterator_type mEnd;
+	};
+	typedef Cursor cursor_type;
+
+	explicit Operand(Manager const& manager) : mManager(&manager) {}
+
+	bool contains(resource_type const& val) const
+	{
+		return mManager->has_nothrow(val);
+	}
+
+	cursor_type cursor() const
+	{
+		return cursor_type(*mManager);
+	}
+
+	size_t bound() const
+	{
+		return mManager->available();
+	}
+
+	size_t count() const
+	{
+		return mManager->available();
+	}
+
+private:
+	Manager const* mManager;
+};
+
+/* Binary operations.  Intersections and differences visit the resources
+   of one operand and keep those passing the membership test of the other,
+   unions and symmetric differences visit the resources of both operands
+   in order. */
+
+struct And
+{
+	static bool apply(bool lhs, bool rhs) { return lhs && rhs; }
+};
+
+struct Minus
+{
+	static bool apply(bool lhs, bool rhs) { return lhs && !rhs; }
+};
+
+struct Or
+{
+	static bool apply(bool lhs, bool rhs) { return lhs || rhs; }
+};
+
+struct Xor
+{
+	static bool apply(bool lhs, bool rhs) { return lhs != rhs; }
+};
+
+template<typename Operation, typename Lhs, typename Rhs>
+class Binary :
+	public Expression<Binary<Operation, Lhs, Rhs> >
+{
+	static_assert(std::is_same<typename Lhs::resource_type, typename Rhs::resource_type>::value,
+	              "Expressions can only combine managers of the same resource type");
+
+	/// Whether only resources of the left or right operand can be in the result.
+	static bool const filters = std::is_same<Operation, And>::value ||
+	                            std::is_same<Operation, Minus>::value;
+
+public:
+	typedef typename Lhs::resource_type resource_type;
+
+	/** Keeps a cursor per visited operand, each of which is only advanced
+	 *  past the resources it contributed.  Thus every operand is walked
+	 *  once per pass over the result.
+	 */
+	class Cursor
+	{
+	public:
+		explicit Cursor(Binary const& expr) :
+			mExpr(&expr), mLhs(), mRhs(), mTakeLhs(false), mTakeRhs(false), mCurrent()
+		{
+			if (!filters || !expr.mDriveRight)
+				mLhs = expr.mLhs.cursor();
+			if (!filters || expr.mDriveRight)
+				mRhs = expr.mRhs.cursor();
+			settle();
+		}
+
+		bool done() const
+		{
+			return !mCurrent;
+		}
+
+		resource_type value() const
+		{
+			return *mCurrent;
+		}
+
+		void advance()
+		{
+			step();
+			settle();
+		}
+
+	private:
+		/// Advance the operand cursors past the current resource.
+		void step()
+		{
+			if (filters) {
+				if (mLhs)
+					mLhs->advance();
+				else
+					mRhs->advance();
+				return;
+			}
+			if (mTakeLhs)
+				mLhs->advance();
+			if (mTakeRhs)
+				mRhs->advance();
+		}
+
+		/// Advance the operand cursors until they point to a resource of the result.
+		void settle()
+		{
+			if (filters) {
+				if (mLhs)
+					filter(*mLhs, mExpr->mRhs);
+				else
+					filter(*mRhs, mExpr->mLhs);
+				return;
+			}
+
+			std::less<resource_type> const cmp;
+			for (;;) {
+				bool const lhs = !mLhs->done();
+				bool const rhs = !mRhs->done();
+				if (!lhs && !rhs) {
+					mCurrent = boost::none;
+					return;
+				}
+				mTakeLhs = lhs && (!rhs || !cmp(mRhs->value(), mLhs->value()));
+				mTakeRhs = rhs && (!lhs || !cmp(mLhs->value(), mRhs->value()));
+				mCurrent = mTakeLhs ? mLhs->value() : mRhs->value();
+				if (Operation::apply(mTakeLhs, mTakeRhs))
+					return;
+				step();
+			}
+		}
+
+		/// Skip the resources of `driver` that do not pass the operation.
+		template<typename Driver, typename Other>
+		void filter(Driver& driver, Other const& other)
+		{
+			while (!driver.done() && !Operation::apply(true, other.contains(driver.value())))
+				driver.advance();
+			if (driver.done())
+				mCurrent = boost::none;
+			else
+				mCurrent = driver.value();
+		}
+
+		Binary const* mExpr;
+		boost::optional<typename Lhs::cursor_type> mLhs;
+		boost::optional<typename Rhs::cursor_type> mRhs;
+		/// Operands the current resource was taken from when merging.
+		bool mTakeLhs;
+		bool mTakeRhs;
+		boost::optional<resource_type> mCurrent;
+	};
+	typedef Cursor cursor_type;
+
+	Binary(Lhs const& lhs, Rhs const& rhs) :
+		mLhs(lhs), mRhs(rhs),
+		// Intersections are driven by the smaller operand.
+		mDriveRight(std::is_same<Operation, And>::value && rhs.bound() < lhs.bound())
+	{}
+
+	bool contains(resource_type const& val) const
+	{
+		return Operation::apply(mLhs.contains(val), mRhs.contains(val));
+	}
+
+	cursor_type cursor() const
+	{
+		return cursor_type(*this);
+	}
+
+	size_t bound() const
+	{
+		if (std::is_same<Operation, And>::value)
+			return std::min(mLhs.bound(), mRhs.bound());
+		if (std::is_same<Operation, Minus>::value)
+			return mLhs.bound();
+		return mLhs.bound() + mRhs.bound();
+	}
+
+	/** Number of resources in the result.
+	 *  Unions and symmetric differences are counted via the intersection of
+	 *  their operands, i.e. |A| + |B| - |A & B| and |A| + |B| - 2 |A & B|.
+	 */
+	size_t count() const
+	{
+		if (filters)
+			return Expression<Binary>::count();
+		size_t const both = Binary<And, Lhs, Rhs>(mLhs, mRhs).count();
+		size_t const total = mLhs.count() + mRhs.count();
+		return std::is_same<Operation, Or>::value ? total - both : total - 2 * both;
+	}
+
+private:
+	Lhs mLhs;
+	Rhs mRhs;
+	bool mDriveRight;
+};
+
+namespace detail {
+
+/// Expression type used for `T`, managers are wrapped into an `Operand`.
+template<typename T, typename Enable = void>
+struct AsExpression
+{
+	static bool const value = false;
+};
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+struct AsExpression<ResourceManager<Res, Pol, Pred, Cmp, Sto> >
+{
+	static bool const value = true;
+	typedef Operand<ResourceManager<Res, Pol, Pred, Cmp, Sto> > type;
+
+	static type wrap(ResourceManager<Res, Pol, Pred, Cmp, Sto> const& manager)
+	{
+		return type(manager);
+	}
+};
+
+template<typename T>
+struct AsExpression<T, typename std::enable_if<std::is_base_of<Expression<T>, T>::value>::type>
+{
+	static bool const value = true;
+	typedef T type;
+
+	static T const& wrap(T const& expr)
+	{
+		return expr;
+	}
+};
+
+/// Result type of combining `Lhs` and `Rhs`, empty unless both are expressions.
+template<typename Operation, typename Lhs, typename Rhs, typename Enable = void>
+struct BinaryResult
+{};
+
+template<typename Operation, typename Lhs, typename Rhs>
+struct BinaryResult<Operation, Lhs, Rhs,
+	typename std::enable_if<AsExpression<Lhs>::value && AsExpression<Rhs>::value>::type>
+{
+	typedef Binary<Operation,
+		typename AsExpression<Lhs>::type, typename AsExpression<Rhs>::type> type;
+};
+
+template<typename Operation, typename Lhs, typename Rhs>
+typename BinaryResult<Operation, Lhs, Rhs>::type
+make_binary(Lhs const& lhs, Rhs const& rhs)
+{
+	return typename BinaryResult<Operation, Lhs, Rhs>::type(
+		AsExpression<Lhs>::wrap(lhs), AsExpression<Rhs>::wrap(rhs));
+}
+
+template<typename Lhs, typename Rhs, typename Result>
+struct EnableIfExpressions :
+	std::enable_if<AsExpression<Lhs>::value && AsExpression<Rhs>::value, Result>
+{};
+
+} // detail
+
+template<typename Derived>
+template<typename Other>
+bool Expression<Derived>::is_subset_of(Other const& other) const
+{
+	return !detail::make_binary<Minus>(derived(), other).any();
+}
+
+template<typename Derived>
+template<typename Other>
+bool Expression<Derived>::overlaps(Other const& other) const
+{
+	return detail::make_binary<And>(derived(), other).any();
+}
+
+/// Wrap a manager (or expression) into an expression.
+template<typename T>
+typename detail::AsExpression<T>::type make_expression(T const& val)
+{
+	return detail::AsExpression<T>::wrap(val);
+}
+
+} // expression
+
+/// Resources enabled in both `lhs` and `rhs`.
+template<typename Lhs, typename Rhs>
+typename expression::detail::BinaryResult<expression::And, Lhs, Rhs>::type
+operator&(Lhs const& lhs, Rhs const& rhs)
+{
+	return expression::detail::make_binary<expression::And>(lhs, rhs);
+}
+
+/// Resources enabled in `lhs` or `rhs`.
+template<typename Lhs, typename Rhs>
+typename expression::detail::BinaryResult<expression::Or, Lhs, Rhs>::type
+operator|(Lhs const& lhs, Rhs const& rhs)
+{
+	return expression::detail::make_binary<expression::Or>(lhs, rhs);
+}
+
+/// Resources enabled in `lhs` but not in `rhs`.
+template<typename Lhs, typename Rhs>
+typename expression::detail::BinaryResult<expression::Minus, Lhs, Rhs>::type
+operator-(Lhs const& lhs, Rhs const& rhs)
+{
+	return expression::detail::make_binary<expression::Minus>(lhs, rhs);
+}
+
+/// Resources enabled in exactly one of `lhs` and `rhs`.
+template<typename Lhs, typename Rhs>
+typename expression::detail::BinaryResult<expression::Xor, Lhs, Rhs>::type
+operator^(Lhs const& lhs, Rhs const& rhs)
+{
+	return expression::detail::make_binary<expression::Xor>(lhs, rhs);
+}
+
+/// Whether every resource enabled in (or resulting from) `lhs` is in `rhs`.
+template<typename Lhs, typename Rhs>
+typename expression::detail::EnableIfExpressions<Lhs, Rhs, bool>::type
+is_subset_of(Lhs const& lhs, Rhs const& rhs)
+{
+	return expression::make_expression(lhs).is_subset_of(rhs);
+}
+
+/// Whether `lhs` and `rhs` share at least one resource.
+template<typename Lhs, typename Rhs>
+typename expression::detail::EnableIfExpressions<Lhs, Rhs, bool>::type
+overlaps(Lhs const& lhs, Rhs const& rhs)
+{
+	return expression::make_expression(lhs).overlaps(rhs);
+}
+
+} // redman
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <stdexcept>
 
 #ifndef PYPLUSPLUS
@@ -12,6 +13,8 @@
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/serialization/serialization.hpp>
 
+#include "redman/ValidityMask.h"
+
 namespace redman {
 
 struct Predicate
@@ -26,6 +29,43 @@ struct HasEnumType : boost::false_type {};
 template <typename T>
 struct HasEnumType <T, typename boost::enable_if_has_type<typename T::enum_type>::type> : boost::true_type {};
 
+/** Maps a resource onto the index space used by `DefaultPredicate`.
+ *  Resources without `enum_type` are their own index.
+ */
+template <typename Resource, typename Enable = void>
+struct ResourceIndex
+{
+	typedef Resource index_type;
+	typedef typename index_type::value_type value_type;
+
+	static value_type get(Resource const& res)
+	{
+		return res.value();
+	}
+
+	static Resource make(value_type idx)
+	{
+		return Resource(index_type(idx));
+	}
+};
+
+template <typename Resource>
+struct ResourceIndex<Resource, typename boost::enable_if_c<HasEnumType<Resource>::value>::type>
+{
+	typedef typename Resource::enum_type index_type;
+	typedef typename index_type::value_type value_type;
+
+	static value_type get(Resource const& res)
+	{
+		return res.toEnum().value();
+	}
+
+	static Resource make(value_type idx)
+	{
+		return Resource(index_type(idx));
+	}
+};
+
 } // namespace detail
 
 
@@ -68,6 +108,131 @@ struct DefaultPredicate<Resource, typename boost::enable_if_c<detail::HasEnumTyp
 	}
 };
 
+namespace detail {
+
+template <typename Predicate>
+struct IsDefaultPredicate : boost::false_type {};
+
+template <typename Resource, typename Enable>
+struct IsDefaultPredicate<DefaultPredicate<Resource, Enable> > : boost::true_type {};
+
+template <typename Predicate, typename = void>
+struct HasValidityMask : boost::false_type {};
+
+template <typename Predicate>
+struct HasValidityMask<Predicate, typename boost::enable_if_has_type<typename Predicate::has_validity_mask>::type> : boost::true_type {};
+
+/** Tests, searches and counts valid indices of a predicate, using its
+ *  validity mask if it provides one (see `ValidityMask`).
+ *  `next()` returns the first valid index at or after, `prev()` the last
+ *  valid index before the given one (`index_type::end` if there is none),
+ *  `rank()` the number of valid indices before the given one.
+ */
+template <typename Predicate, typename Enable = void>
+struct PredicateScan
+{
+	typedef typename Predicate::index_type index_type;
+	typedef typename index_type::value_type index_value_type;
+
+	static bool valid(Predicate const& pred, index_value_type idx)
+	{
+		return pred(pred.construct(index_type(idx)));
+	}
+
+	static index_value_type next(Predicate const& pred, index_value_type idx)
+	{
+		for (; idx < index_type::end; ++idx)
+		{
+			if (valid(pred, idx))
+				break;
+		}
+		return idx;
+	}
+
+	static index_value_type prev(Predicate const& pred, index_value_type idx)
+	{
+		if (idx > index_type::end)
+			idx = index_type::end;
+		while (idx > index_type::begin)
+		{
+			if (valid(pred, --idx))
+				return idx;
+		}
+		return index_type::end;
+	}
+
+	static size_t rank(Predicate const& pred, index_value_type idx)
+	{
+		size_t count = 0;
+		for (index_value_type ii = index_type::begin; ii < idx && ii < index_type::end; ++ii)
+			count += valid(pred, ii);
+		return count;
+	}
+};
+
+template <typename Predicate>
+struct PredicateScan<Predicate, typename boost::enable_if_c<HasValidityMask<Predicate>::value>::type>
+{
+	typedef typename Predicate::index_type index_type;
+	typedef typename index_type::value_type index_value_type;
+
+	static bool valid(Predicate const& pred, index_value_type idx)
+	{
+		return pred.validity_mask().test(idx);
+	}
+
+	static index_value_type next(Predicate const& pred, index_value_type idx)
+	{
+		return pred.validity_mask().next(idx);
+	}
+
+	static index_value_type prev(Predicate const& pred, index_value_type idx)
+	{
+		return pred.validity_mask().prev(idx);
+	}
+
+	static size_t rank(Predicate const& pred, index_value_type idx)
+	{
+		return pred.validity_mask().rank(idx);
+	}
+};
+
+/// `DefaultPredicate` accepts the whole index range.
+template <typename Predicate>
+struct PredicateScan<Predicate, typename boost::enable_if_c<IsDefaultPredicate<Predicate>::value>::type>
+{
+	typedef typename Predicate::index_type index_type;
+	typedef typename index_type::value_type index_value_type;
+
+	static bool valid(Predicate const&, index_value_type idx)
+	{
+		return idx >= index_type::begin && idx < index_type::end;
+	}
+
+	static index_value_type next(Predicate const&, index_value_type idx)
+	{
+		if (idx < index_type::begin)
+			return index_type::begin;
+		return idx < index_type::end ? idx : index_value_type(index_type::end);
+	}
+
+	static index_value_type prev(Predicate const&, index_value_type idx)
+	{
+		if (idx <= index_type::begin)
+			return index_type::end;
+		return idx > index_type::end ? index_type::end - 1 : idx - 1;
+	}
+
+	static size_t rank(Predicate const&, index_value_type idx)
+	{
+		if (idx <= index_type::begin)
+			return 0;
+		return (idx < index_type::end ? idx : index_value_type(index_type::end)) - index_type::begin;
+	}
+};
+
+} // namespace detail
+
 template<typename Predicate>
 class PredicateIterator :
 	public boost::iterator_facade<
@@ -82,6 +247,8 @@ class PredicateIterator :
 
 	typedef typename index_type::value_type index_value_type;
 
+	typedef detail::PredicateScan<Predicate> scan;
+
 	inline resource_type make_resource(index_value_type v) const
 	{
 		return mPredicate.construct(index_type(v));
@@ -91,7 +258,7 @@ class PredicateIterator :
 	typename boost::enable_if_c<boost::is_unsigned<T>::value && index_type::begin==0>::type
 	range_check(T const idx) const
 	{
-		if (idx < index_type::end && !mPredicate(make_resource(idx)))
+		if (idx < index_type::end && !scan::valid(mPredicate, idx))
 			throw std::invalid_argument("Index not valid or rejected by predicate.");
 	}
 
@@ -99,7 +266,7 @@ class PredicateIterator :
 	typename boost::enable_if_c<!boost::is_unsigned<T>::value || index_type::begin!=0>::type
 	range_check(T const idx) const
 	{
-		if (idx < index_type::begin || (idx < index_type::end && !mPredicate(make_resource(idx))))
+		if (idx < index_type::begin || (idx < index_type::end && !scan::valid(mPredicate, idx)))
 			throw std::invalid_argument("Index not valid or rejected by predicate.");
 	}
 
@@ -129,14 +296,7 @@ private:
 		if (mIndex >= index_type::end)
 			return;
 
-		index_value_type next = mIndex + 1;
-		for (; next < index_type::end; ++next)
-		{
-			if (mPredicate(make_resource(next)))
-				break;
-		}
-
-		mIndex = next;
+		mIndex = scan::next(mPredicate, mIndex + 1);
 	}
 
 	resource_type dereference() const
@@ -151,6 +311,11 @@ private:
 	index_value_type mIndex;
 };
 
+/** Return the number of resources accepted by the given predicate.
+ */
+template<typename Predicate>
+size_t cardinality(Predicate const& pred);
+
 } // redman
 
 #ifndef PYPLUSPLUS
@@ -159,7 +324,9 @@ template<typename Predicate>
 typename std::enable_if<std::is_base_of<redman::Predicate, Predicate>::value, redman::PredicateIterator<Predicate> >::type
 begin(Predicate const& pred)
 {
-	return { Predicate::index_type::begin, pred };
+	// start at the first valid index, constructing the iterator at an
+	// index rejected by the predicate would throw
+	return { detail::PredicateScan<Predicate>::next(pred, Predicate::index_type::begin), pred };
 }
 
 template<typename Predicate>
@@ -170,6 +337,59 @@ end(Predicate const& pred)
 }
 } // redman
 
+namespace redman {
+
+/** Number of resources accepted by a predicate.
+ *  Generic predicates are evaluated once for every index, callers should
+ *  cache the result (see `ResourceManager`).
+ */
+template<typename Predicate>
+struct PredicateCardinality
+{
+	static size_t count(Predicate const& pred)
+	{
+		return count(pred, detail::HasValidityMask<Predicate>());
+	}
+
+private:
+	static size_t count(Predicate const& pred, boost::true_type)
+	{
+		return pred.validity_mask().count();
+	}
+
+	static size_t count(Predicate const& pred, boost::false_type)
+	{
+		size_t all = 0;
+		for (auto it = begin(pred); it != end(pred); ++it)
+			++all;
+		return all;
+	}
+};
+
+/** `DefaultPredicate` accepts the whole index range, its cardinality is a
+ *  compile-time constant.
+ */
+template<typename Resource, typename Enable>
+struct PredicateCardinality<DefaultPredicate<Resource, Enable> >
+{
+	typedef typename DefaultPredicate<Resource, Enable>::index_type index_type;
+
+	static size_t const value = index_type::end - index_type::begin;
+
+	static size_t count(DefaultPredicate<Resource, Enable> const&)
+	{
+		return value;
+	}
+};
+
+template<typename Predicate>
+size_t cardinality(Predicate const& pred)
+{
+	return PredicateCardinality<Predicate>::count(pred);
+}
+
+} // redman
+
 namespace boost {
 namespace serialization {
 template<typename Archive, typename Resource>
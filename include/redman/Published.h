@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include <boost/shared_ptr.hpp>
+
+namespace redman {
+
+/** Holds the current snapshot of an immutable object for concurrent readers.
+ *  Readers access the snapshot through a `Reader`, which only increments
+ *  and decrements an atomic counter and never blocks.  Writers replace
+ *  the snapshot with `publish()`, which swaps a pointer atomically and then
+ *  waits until all readers that might still see the previous snapshot are
+ *  done before releasing it.  Readers thus always see one complete
+ *  snapshot, either the old or the new one.
+ *  \code
+ *  Published<Wafer::frozen_type> current(wafer.freeze());
+ *  // worker threads
+ *  auto const snapshot = current.read();
+ *  snapshot->get(hicann)->neurons()->has(neuron);
+ *  // operator thread
+ *  current.publish(wafer.freeze());
+ *  \endcode
+ *  @tparam T Type of the snapshot, only accessed via const references.
+ */
+template<typename T>
+class Published
+{
+	typedef boost::shared_ptr<T const> pointer_type;
+
+public:
+	class Reader;
+
+	explicit Published(pointer_type snapshot) :
+		mCurrent(new pointer_type(snapshot)), mEpoch(0), mWriteMutex()
+	{
+		mReaders[0] = 0;
+		mReaders[1] = 0;
+	}
+
+	~Published()
+	{
+		delete mCurrent.load();
+	}
+
+	Published(Published const&) = delete;
+	Published& operator=(Published const&) = delete;
+
+	/// Start reading the current snapshot, wait-free unless a writer publishes meanwhile.
+	Reader read() const
+	{
+		return Reader(*this);
+	}
+
+	/// Return an owning pointer to the current snapshot.
+	pointer_type load() const
+	{
+		return read().shared();
+	}
+
+	/** Replace the current snapshot.
+	 *  Blocks until no reader accesses the previous snapshot any more,
+	 *  owning pointers obtained from `load()` or `Reader::shared()` keep it
+	 *  alive beyond that.  Concurrent writers are serialized.
+	 */
+	void publish(pointer_type snapshot)
+	{
+		std::lock_guard<std::mutex> lock(mWriteMutex);
+		pointer_type* const previous = mCurrent.exchange(new pointer_type(snapshot));
+
+		// Readers registered in the previous epoch may still use `previous`,
+		// readers registering from now on validate against the new epoch.
+		unsigned const epoch = mEpoch.fetch_add(1);
+		while (mReaders[epoch % 2].load() != 0)
+			std::this_thread::yield();
+		delete previous;
+	}
+
+	/** Access to the snapshot that was current when reading started.
+	 *  Must not outlive the `Published` object and should be short-lived,
+	 *  as it delays writers.
+	 */
+	class Reader
+	{
+	public:
+		Reader(Reader&& other) : mParent(other.mParent), mEpoch(other.mEpoch), mSnapshot(other.mSnapshot)
+		{
+			other.mParent = nullptr;
+		}
+
+		Reader(Reader const&) = delete;
+		Reader& operator=(Reader const&) = delete;
+
+		~Reader()
+		{
+			if (mParent)
+				--mParent->mReaders[mEpoch % 2];
+		}
+
+		T const& operator*() const
+		{
+			return **mSnapshot;
+		}
+
+		T const* operator->() const
+		{
+			return mSnapshot->get();
+		}
+
+		/// Owning pointer to the snapshot, may outlive the reader.
+		pointer_type shared() const
+		{
+			return *mSnapshot;
+		}
+
+	private:
+		friend class Published;
+
+		explicit Reader(Published const& parent) : mParent(&parent), mEpoch(), mSnapshot()
+		{
+			for (;;) {
+				mEpoch = parent.mEpoch.load();
+				++parent.mReaders[mEpoch % 2];
+				if (parent.mEpoch.load() == mEpoch)
+					break;
+				// A writer advanced the epoch meanwhile and might not wait for us.
+				--parent.mReaders[mEpoch % 2];
+			}
+			mSnapshot = parent.mCurrent.load();
+		}
+
+		Published const* mParent;
+		unsigned mEpoch;
+		pointer_type const* mSnapshot;
+	};
+
+private:
+	std::atomic<pointer_type*> mCurrent;
+	std::atomic<unsigned> mEpoch;
+	/// Number of active readers per epoch parity.
+	mutable std::atomic<unsigned> mReaders[2];
+	std::mutex mWriteMutex;
+};
+
+} // redman
@@ -7,13 +7,18 @@
 #ifndef PYPLUSPLUS
 #include <type_traits>
 #include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <boost/range.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "redman/SelectionIterator.h"
 #endif // PYPLUSPLUS
 
 #include <algorithm>
 
-#include <boost/iterator/filter_iterator.hpp>
-
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/nvp.hpp>
 #include <boost/serialization/set.hpp>
@@ -22,9 +27,23 @@
 #include "redman/Whitelist.h"
 #include "redman/Blacklist.h"
 #include "redman/Predicate.h"
+#include "redman/Storage.h"
+#include "redman/storage/Set.h"
+#include "redman/storage/Bitset.h"
+#include "redman/storage/Compressed.h"
+#include "redman/storage/Flat.h"
+#include "redman/storage/Adaptive.h"
+#include "redman/storage/CopyOnWrite.h"
 
 namespace redman {
 
+#ifndef PYPLUSPLUS
+namespace expression {
+template<typename Manager>
+class Operand;
+} // expression
+#endif // PYPLUSPLUS
+
 /** Manages a set of working or defect resources.
  *  @tparam Resource Underlying type for the managed resource.
  *          Will usually be one of the *halbe* coordinate types.
@@ -34,10 +53,17 @@ namespace redman {
  *          match this predicate.  May be used to restrict resources
  *          to a subset of all possible coordinates.
  *  @tparam Compare Comparison function to be used by internal data structures.
+ *  @tparam Storage Container used for the selection, e.g. `storage::Set`
+ *          (sparse, default), `storage::FlatSet` (sparse, compact),
+ *          `storage::Bitset` (dense, O(1) access), `storage::Compressed`
+ *          (large index spaces, clustered selections) or `storage::Adaptive`
+ *          (switches between flat and bitset depending on the density).
+ *          The serialized format does not depend on the storage.
  */
 template<typename Resource, typename Policy,
 	typename Predicate = DefaultPredicate<Resource>,
-	typename Compare = std::less<Resource> >
+	typename Compare = std::less<Resource>,
+	typename Storage = storage::Set>
 class ResourceManager
 {
 #ifndef PYPLUSPLUS
@@ -47,25 +73,35 @@ class ResourceManager
 	static_assert(std::is_base_of<redman::Predicate, Predicate>::value,
 	              "Predicate has wrong base class.");
 
-	typedef std::function<bool(Resource const&)> filter_type;
+	static_assert(std::is_base_of<redman::Storage, Storage>::value,
+	              "Storage has wrong base class.");
 #endif // PYPLUSPLUS
 
-	typedef ResourceManager<Resource, Policy, Predicate, Compare> manager;
+	typedef ResourceManager<Resource, Policy, Predicate, Compare, Storage> manager;
 
 public:
 	typedef std::set<Resource, Compare> set_type;
+	typedef typename Storage::template selection<Resource, Predicate, Compare>::type
+		storage_type;
 	typedef Resource resource;
 
 #ifndef PYPLUSPLUS
 	typedef Policy policy;
 	typedef Predicate predicate;
 
-	typedef boost::filter_iterator<filter_type,
-		PredicateIterator<Predicate> > iterator_type;
+	typedef StoredIterator<Predicate, storage_type, Compare> stored_iterator;
+	typedef ComplementIterator<Predicate, storage_type, Compare> complement_iterator;
+
+	/// Iterator over enabled resources.
+	typedef typename std::conditional<Policy::stores_enabled,
+		stored_iterator, complement_iterator>::type iterator_type;
+	/// Iterator over disabled resources.
+	typedef typename std::conditional<Policy::stores_enabled,
+		complement_iterator, stored_iterator>::type disabled_iterator_type;
 #endif // PYPLUSPLUS
 
 	ResourceManager(Predicate const& f = Predicate()) :
-		mPredicate(f), mSelection(), mHasValue(false)
+		mPredicate(f), mCardinality(cardinality(f)), mSelection(), mHasValue(false)
 	{}
 
 	/** Construct the resource manager with initially enabled resources.
@@ -75,12 +111,20 @@ public:
 	 */
 	ResourceManager(set_type const& set_available,
 					Predicate const& f = Predicate()) :
-		mPredicate(f), mSelection(), mHasValue(false)
+		mPredicate(f), mCardinality(cardinality(f)), mSelection(), mHasValue(false)
 	{
 		from_set(set_available);
 	}
 
 #ifndef PYPLUSPLUS
+	/* Depending on the policy one of enabled() and disabled() walks the
+	   stored selection, the other one its complement with respect to the
+	   predicate.  Both skip over the selection instead of testing every
+	   resource, so the cost of finding e.g. the few disabled resources of a
+	   blacklist only scales with their number.
+	   Iterators stay valid if the resource they point to is enabled or
+	   disabled, any other modification invalidates them. */
+
 	/// Return an iterator to the beginning of all enabled resources.
 	iterator_type begin() const;
 	/// Return an iterator to the end of all enabled resources.
@@ -90,12 +134,12 @@ public:
 	boost::iterator_range<iterator_type> enabled() const;
 
 	/// Return an iterator to the beginning of all disabled resources.
-	iterator_type begin_disabled() const;
+	disabled_iterator_type begin_disabled() const;
 	/// Return an iterator to the end of all disabled resources.
-	iterator_type end_disabled() const;
+	disabled_iterator_type end_disabled() const;
 
 	/// Return iterable over all disabled resources.
-	boost::iterator_range<iterator_type> disabled() const;
+	boost::iterator_range<disabled_iterator_type> disabled() const;
 #endif // PYPLUSPLUS
 
 	/** Reset enabled resources to policy default.
@@ -114,6 +158,16 @@ public:
 	 */
 	void from_set(set_type const& other);
 
+#ifndef PYPLUSPLUS
+	/** Enable all resources contained in set, taking ownership of it.
+	 *  For `Whitelist` managers using `std::set` storage the set becomes the
+	 *  selection without copying.
+	 *  \throws std::invalid_argument When any resource in the set does not
+	 *          fulfill the predicate.
+	 */
+	void from_set(set_type&& other);
+#endif // PYPLUSPLUS
+
 	/** Enable the given resource.
 	 *  \param  val The resource to enable.
 	 *  \throws std::invalid_argument When the resource does not
@@ -130,6 +184,46 @@ public:
 	 */
 	void disable(Resource const& val, switch_mode::type mode = switch_mode::THROW);
 
+#ifndef PYPLUSPLUS
+	/* Batch versions of enable(), disable() and has().  All resources are
+	   checked against the predicate before anything is modified and
+	   failures are reported once for the whole batch.  The range may be in
+	   any order, it is sorted and applied to the selection at once. */
+
+	/** Enable all resources in [first, last).
+	 *  \return The number of resources that were disabled before.
+	 *  \throws std::invalid_argument When any resource does not fulfill the
+	 *          predicate, listing all rejected resources.
+	 *  \throws std::runtime_error When any resource is already enabled and mode
+	 *          is THROW, listing all of them.
+	 *  Nothing is modified if an exception is thrown.
+	 */
+	template<typename InputIterator>
+	size_t enable_many(InputIterator first, InputIterator last,
+	                   switch_mode::type mode = switch_mode::THROW);
+
+	/** Disable all resources in [first, last).
+	 *  \return The number of resources that were enabled before.
+	 *  \throws std::invalid_argument When any resource does not fulfill the
+	 *          predicate, listing all rejected resources.
+	 *  \throws std::runtime_error When any resource is already disabled and mode
+	 *          is THROW, listing all of them.
+	 *  Nothing is modified if an exception is thrown.
+	 */
+	template<typename InputIterator>
+	size_t disable_many(InputIterator first, InputIterator last,
+	                    switch_mode::type mode = switch_mode::THROW);
+
+	/** Check whether the resources in [first, last) are available.
+	 *  Writes one `bool` per resource to `out`, in the order of the range.
+	 *  \return Output iterator past the last written value.
+	 *  \throws std::invalid_argument When any resource does not fulfill the
+	 *          predicate, listing all rejected resources.
+	 */
+	template<typename ForwardIterator, typename OutputIterator>
+	OutputIterator has_many(ForwardIterator first, ForwardIterator last, OutputIterator out) const;
+#endif // PYPLUSPLUS
+
 	/** Enable all resources.
 	 */
 	void enable_all();
@@ -138,35 +232,66 @@ public:
 	 */
 	void disable_all();
 
+	/* The set operations below work directly on the stored selections.  As
+	   long as both managers share the same predicate (always the case for
+	   stateless predicates) no resource is validated or looked up
+	   individually. */
+
 	/** Only keep resources that are not enabled in another resource manager.
-	 *  \throws std::invalid_argument When any resource copied from the other
-	 *          manager does not fulfill the predicate of this manager.
 	 */
 	void difference(manager const& other);
 
 	/** Only keep resources that are not enabled in both resource managers.
-	 *  \throws std::invalid_argument When any resource copied from the other
-	 *          manager does not fulfill the predicate of this manager.
+	 *  Resources of the other manager rejected by the predicate of this
+	 *  manager are ignored.
 	 */
 	void symmetric_difference(manager const& other);
 
 
 	/** Only keep resources that are enabled in both resource managers.
-	 *  \throws std::invalid_argument When any resource copied from the other
-	 *          manager does not fulfill the predicate of this manager.
 	 */
 	void intersection(manager const& other);
 
 	/** Also enable resources that are enabled in another resource manager.
-	 *  \throws std::invalid_argument When any resource copied from the other
-	 *          manager does not fulfill the predicate of this manager.
+	 *  Resources of the other manager rejected by the predicate of this
+	 *  manager are ignored, use `from_set()` to have them rejected.
 	 */
 	void merge(manager const& other);
 
 	/** Return the number of enabled resources.
+	 *  Constant time, the number of resources matching the predicate is
+	 *  determined once on construction.
 	 */
 	size_t available() const;
 
+	/* Order statistics over the enabled resources in index order.  With
+	   bitset, compressed, flat or adaptive storage and `DefaultPredicate`
+	   (or a predicate with validity mask) these take constant or
+	   logarithmic time, `std::set` storage has to walk the tree. */
+
+	/** Return the number of enabled resources preceding the given one.
+	 */
+	size_t rank(Resource const& val) const;
+
+	/** Return the `k`-th enabled resource (counting from zero).
+	 *  \throws std::out_of_range When `k` is not less than available().
+	 */
+	Resource select(size_t k) const;
+
+	/** Return the number of enabled resources in [first, last).
+	 */
+	size_t count_range(Resource const& first, Resource const& last) const;
+
+#ifndef PYPLUSPLUS
+	/** Return the first enabled resource after the given one, if any.
+	 */
+	boost::optional<Resource> next_enabled(Resource const& val) const;
+
+	/** Return the last enabled resource before the given one, if any.
+	 */
+	boost::optional<Resource> prev_enabled(Resource const& val) const;
+#endif // PYPLUSPLUS
+
 	/** Check if a resource is available.
 	 */
 	bool has(Resource const& val) const;
@@ -176,24 +301,100 @@ public:
 	 */
 	bool has_value() const;
 
+	/** Check if both managers share their selection.
+	 *  Copies of a manager share its selection until either one is modified,
+	 *  copying a manager is thus cheap regardless of its size.
+	 */
+	bool shares_selection(ResourceManager const& other) const;
+
+#ifndef PYPLUSPLUS
+	/** Stop sharing the selection with copies of this manager.
+	 *  Copies the selection if it is shared, afterwards modifications of
+	 *  former copies no longer touch it, not even its reference count.
+	 *  \see freeze()
+	 */
+	void detach();
+#endif // PYPLUSPLUS
+
 	bool operator==(ResourceManager const& rhs) const;
 	bool operator!=(ResourceManager const& rhs) const;
 
 private:
+	/// Like has(), but returns false for resources rejected by the predicate.
+	bool has_nothrow(Resource const& val) const;
+
+	/// Whether the predicates of all managers of this type accept the same resources.
+	static bool shares_predicate();
+
+#ifndef PYPLUSPLUS
+	/// Throw if any resource in [first, last) is rejected by the predicate.
+	template<typename ForwardIterator>
+	void check_batch(ForwardIterator first, ForwardIterator last) const;
+
+	/// Sorted copy of [first, last) without duplicates, checked against the predicate.
+	template<typename InputIterator>
+	std::vector<Resource> make_batch(InputIterator first, InputIterator last) const;
+
+	/// Throw if `batch` contains resources whose availability is `state`.
+	void check_switch(std::vector<Resource> const& batch, bool state, char const* action) const;
+
+	/// Error message listing (at most the first few of) the given resources.
+	static std::string batch_error(char const* what, std::vector<Resource> const& resources);
+#endif // PYPLUSPLUS
+
+#ifndef PYPLUSPLUS
+	// Expressions test membership via has_nothrow().
+	template<typename Manager>
+	friend class expression::Operand;
+#endif // PYPLUSPLUS
+
 	/* mPredicate should essentially be treated as const.
 	   The only reason it is not declared as const is boost::serialize. */
 	Predicate mPredicate;
-	set_type mSelection;
+	/* Number of resources accepted by mPredicate, not serialized. */
+	size_t mCardinality;
+	/* Shared between copies until one of them is modified, so copying a
+	   manager is cheap regardless of the size of its selection. */
+	storage::CopyOnWrite<storage_type> mSelection;
 	bool mHasValue;
 
+	/* The selection is always archived as `set_type`, so that datasets do
+	   not depend on the storage of the manager writing or reading them. */
+	template <typename Archiver>
+	static void load_selection(Archiver& ar, set_type& selection)
+	{
+		ar & boost::serialization::make_nvp("selection", selection);
+	}
+
+	template <typename Archiver, typename Selection>
+	static void load_selection(Archiver& ar, Selection& selection)
+	{
+		set_type tmp;
+		ar & boost::serialization::make_nvp("selection", tmp);
+		selection.assign(tmp.begin(), tmp.end());
+	}
+
+	template <typename Archiver, typename Selection>
+	static void save_selection(Archiver& ar, Selection const& selection)
+	{
+		// archives take non-const references, also when saving
+		set_type tmp(selection.begin(), selection.end());
+		ar & boost::serialization::make_nvp("selection", tmp);
+	}
+
 	/* increment version in components.h */
 	friend class boost::serialization::access;
 	template <typename Archiver>
 	void serialize(Archiver& ar, unsigned int const version) {
 		using namespace boost::serialization;
 
-		ar & make_nvp("predicate", mPredicate)
-		   & make_nvp("selection", mSelection);
+		ar & make_nvp("predicate", mPredicate);
+		if (typename Archiver::is_loading()) {
+			load_selection(ar, mSelection.reset());
+			mCardinality = cardinality(mPredicate);
+		} else {
+			save_selection(ar, *mSelection);
+		}
 
 		switch (version) {
 			case 0:
@@ -217,108 +418,270 @@ private:
 #ifndef PYPLUSPLUS
 namespace redman {
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::reset() {
-	mSelection.clear();
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::reset() {
+	mSelection.reset();
 	mHasValue = false;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::enable_all() {
-	Pol::enable_all(mSelection, mPredicate);
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::enable_all() {
+	Pol::enable_all(mSelection.reset(), mPredicate);
 	mHasValue = true;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::disable_all() {
-	Pol::disable_all(mSelection, mPredicate);
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::disable_all() {
+	Pol::disable_all(mSelection.reset(), mPredicate);
 	mHasValue = true;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-bool ResourceManager<Res, Pol, Pred, Cmp>::has(Res const& val) const {
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+bool ResourceManager<Res, Pol, Pred, Cmp, Sto>::has(Res const& val) const {
 	if (!mPredicate(val))
 		throw std::invalid_argument(
 			"Resource rejected by predicate.");
 
-	return Pol::has(mSelection, val);
+	return Pol::has(*mSelection, val);
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+size_t ResourceManager<Res, Pol, Pred, Cmp, Sto>::available() const {
+	return Pol::available(*mSelection, mCardinality);
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-size_t ResourceManager<Res, Pol, Pred, Cmp>::available() const {
-	return Pol::available(mSelection, mPredicate);
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+size_t ResourceManager<Res, Pol, Pred, Cmp, Sto>::rank(Res const& val) const {
+	return Pol::rank(*mSelection, mPredicate, val);
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::enable(Res const& val, switch_mode::type mode) {
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+Res ResourceManager<Res, Pol, Pred, Cmp, Sto>::select(size_t k) const {
+	if (k >= available()) {
+		std::stringstream error_msg;
+		error_msg << "cannot select resource " << k << " of " << available();
+		throw std::out_of_range(error_msg.str());
+	}
+	return Pol::select(*mSelection, mPredicate, k);
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+size_t ResourceManager<Res, Pol, Pred, Cmp, Sto>::count_range(
+	Res const& first, Res const& last) const {
+	if (!Cmp()(first, last))
+		return 0;
+	return rank(last) - rank(first);
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+boost::optional<Res> ResourceManager<Res, Pol, Pred, Cmp, Sto>::next_enabled(Res const& val) const {
+	return Pol::next(*mSelection, mPredicate, val);
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+boost::optional<Res> ResourceManager<Res, Pol, Pred, Cmp, Sto>::prev_enabled(Res const& val) const {
+	return Pol::prev(*mSelection, mPredicate, val);
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::enable(Res const& val, switch_mode::type mode) {
 	if (!mPredicate(val))
 		throw std::invalid_argument(
 			"Resource rejected by predicate.");
 
-	Pol::enable(mSelection, val, mode);
+	Pol::enable(mSelection.mutate(), val, mode);
 	mHasValue = true;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::disable(Res const& val, switch_mode::type mode) {
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::disable(Res const& val, switch_mode::type mode) {
 	if (!mPredicate(val))
 		throw std::invalid_argument(
 			"Resource rejected by predicate.");
 
-	Pol::disable(mSelection, val, mode);
+	Pol::disable(mSelection.mutate(), val, mode);
 	mHasValue = true;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::difference(manager const& other) {
-	set_type diff;
-	std::set_difference(
-		begin(), end(),
-		other.begin(), other.end(),
-		std::inserter(diff, diff.begin()), Cmp());
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+template<typename InputIterator>
+size_t ResourceManager<Res, Pol, Pred, Cmp, Sto>::enable_many(
+	InputIterator first, InputIterator last, switch_mode::type mode) {
+	std::vector<Res> const batch = make_batch(first, last);
+	if (mode == switch_mode::THROW)
+		check_switch(batch, true, "enable");
 
-	Pol::from_set(mSelection, mPredicate, diff);
+	size_t const changed = Pol::enable_many(mSelection.mutate(), batch.begin(), batch.end());
 	mHasValue = true;
+	return changed;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::symmetric_difference(manager const& other) {
-	set_type diff;
-	std::set_symmetric_difference(
-		begin(), end(),
-		other.begin(), other.end(),
-		std::inserter(diff, diff.begin()), Cmp());
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+template<typename InputIterator>
+size_t ResourceManager<Res, Pol, Pred, Cmp, Sto>::disable_many(
+	InputIterator first, InputIterator last, switch_mode::type mode) {
+	std::vector<Res> const batch = make_batch(first, last);
+	if (mode == switch_mode::THROW)
+		check_switch(batch, false, "disable");
 
-	Pol::from_set(mSelection, mPredicate, diff);
+	size_t const changed = Pol::disable_many(mSelection.mutate(), batch.begin(), batch.end());
 	mHasValue = true;
+	return changed;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::intersection(manager const& other) {
-	set_type diff;
-	std::set_intersection(
-		begin(), end(),
-		other.begin(), other.end(),
-		std::inserter(diff, diff.begin()), Cmp());
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+template<typename ForwardIterator, typename OutputIterator>
+OutputIterator ResourceManager<Res, Pol, Pred, Cmp, Sto>::has_many(
+	ForwardIterator first, ForwardIterator last, OutputIterator out) const {
+	check_batch(first, last);
+	for (; first != last; ++first)
+		*out++ = Pol::has(*mSelection, *first);
+	return out;
+}
 
-	Pol::from_set(mSelection, mPredicate, diff);
-	mHasValue = has_value() || other.has_value();
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+template<typename ForwardIterator>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::check_batch(
+	ForwardIterator first, ForwardIterator last) const {
+	std::vector<Res> rejected;
+	for (; first != last; ++first) {
+		if (!mPredicate(*first))
+			rejected.push_back(*first);
+	}
+	if (!rejected.empty())
+		throw std::invalid_argument(batch_error("resources rejected by predicate", rejected));
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+template<typename InputIterator>
+std::vector<Res> ResourceManager<Res, Pol, Pred, Cmp, Sto>::make_batch(
+	InputIterator first, InputIterator last) const {
+	Cmp const cmp;
+	std::vector<Res> batch(first, last);
+	if (!std::is_sorted(batch.begin(), batch.end(), cmp))
+		std::sort(batch.begin(), batch.end(), cmp);
+	batch.erase(
+		std::unique(batch.begin(), batch.end(),
+		            [&cmp](Res const& a, Res const& b) { return !cmp(a, b); }),
+		batch.end());
+	check_batch(batch.begin(), batch.end());
+	return batch;
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::check_switch(
+	std::vector<Res> const& batch, bool state, char const* action) const {
+	std::vector<Res> unchanged;
+	for (auto const& res : batch) {
+		if (Pol::has(*mSelection, res) == state)
+			unchanged.push_back(res);
+	}
+	if (!unchanged.empty()) {
+		std::string what = "could not ";
+		what += action;
+		what += " resources";
+		throw std::runtime_error(batch_error(what.c_str(), unchanged));
+	}
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+std::string ResourceManager<Res, Pol, Pred, Cmp, Sto>::batch_error(
+	char const* what, std::vector<Res> const& resources) {
+	size_t const listed = 16;
+	std::stringstream error_msg;
+	error_msg << what << " (" << resources.size() << "):";
+	for (size_t ii = 0; ii < std::min(listed, resources.size()); ++ii)
+		error_msg << " " << resources[ii];
+	if (resources.size() > listed)
+		error_msg << " ...";
+	return error_msg.str();
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+bool ResourceManager<Res, Pol, Pred, Cmp, Sto>::has_nothrow(Res const& val) const {
+	return mPredicate(val) && Pol::has(*mSelection, val);
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+bool ResourceManager<Res, Pol, Pred, Cmp, Sto>::shares_predicate() {
+	// Predicates without state can not differ between instances.
+	return std::is_empty<Pred>::value;
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::difference(manager const& other) {
+	if (this == &other) {
+		Pol::disable_all(mSelection.reset(), mPredicate);
+	} else if (shares_predicate()) {
+		Pol::difference(mSelection.mutate(), *other.mSelection, mPredicate);
+	} else {
+		// Disabling the current resource does not invalidate the iterator,
+		// as long as the selection is not copied meanwhile.
+		mSelection.mutate();
+		for (auto it = begin(); it != end(); ++it) {
+			Res const res = *it;
+			if (other.has_nothrow(res))
+				Pol::disable(mSelection.mutate(), res, switch_mode::NONTHROW);
+		}
+	}
+	mHasValue = true;
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::symmetric_difference(manager const& other) {
+	if (this == &other) {
+		Pol::disable_all(mSelection.reset(), mPredicate);
+	} else if (shares_predicate()) {
+		Pol::symmetric_difference(mSelection.mutate(), *other.mSelection, mPredicate);
+	} else {
+		for (auto res : other) {
+			if (!mPredicate(res))
+				continue;
+			if (Pol::has(*mSelection, res))
+				Pol::disable(mSelection.mutate(), res);
+			else
+				Pol::enable(mSelection.mutate(), res);
+		}
+	}
+	mHasValue = true;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::merge(manager const& other) {
-	set_type diff;
-	std::set_union(
-		begin(), end(),
-		other.begin(), other.end(),
-		std::inserter(diff, diff.begin()), Cmp());
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::intersection(manager const& other) {
+	if (this == &other) {
+		// nothing to do
+	} else if (shares_predicate()) {
+		Pol::intersection(mSelection.mutate(), *other.mSelection, mPredicate);
+	} else {
+		// Disabling the current resource does not invalidate the iterator,
+		// as long as the selection is not copied meanwhile.
+		mSelection.mutate();
+		for (auto it = begin(); it != end(); ++it) {
+			Res const res = *it;
+			if (!other.has_nothrow(res))
+				Pol::disable(mSelection.mutate(), res, switch_mode::NONTHROW);
+		}
+	}
+	mHasValue = has_value() || other.has_value();
+}
 
-	Pol::from_set(mSelection, mPredicate, diff);
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::merge(manager const& other) {
+	if (this == &other) {
+		// nothing to do
+	} else if (shares_predicate()) {
+		Pol::merge(mSelection.mutate(), *other.mSelection, mPredicate);
+	} else {
+		for (auto res : other) {
+			if (mPredicate(res))
+				Pol::enable(mSelection.mutate(), res, switch_mode::NONTHROW);
+		}
+	}
 	mHasValue = has_value() || other.has_value();
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-void ResourceManager<Res, Pol, Pred, Cmp>::from_set(set_type const& other) {
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::from_set(set_type const& other) {
 	auto const& predicate = mPredicate;
 	auto is_invalid = [&predicate](Res const& val) -> bool {
 		return !predicate(val);
@@ -327,76 +690,94 @@ void ResourceManager<Res, Pol, Pred, Cmp>::from_set(set_type const& other) {
 	if (any_of(other.begin(), other.end(), is_invalid))
 		throw std::invalid_argument(
 			"Resource in set rejected by predicate.");
-	Pol::from_set(mSelection, mPredicate, other);
+	Pol::from_set(mSelection.reset(), mPredicate, other);
 	mHasValue = true;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-bool ResourceManager<Res, Pol, Pred, Cmp>::has_value() const{
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::from_set(set_type&& other) {
+	auto const& predicate = mPredicate;
+	auto is_invalid = [&predicate](Res const& val) -> bool {
+		return !predicate(val);
+	};
+
+	if (any_of(other.begin(), other.end(), is_invalid))
+		throw std::invalid_argument(
+			"Resource in set rejected by predicate.");
+	Pol::from_set(mSelection.reset(), mPredicate, std::move(other));
+	mHasValue = true;
+}
+
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+bool ResourceManager<Res, Pol, Pred, Cmp, Sto>::has_value() const{
 	return mHasValue;
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-bool ResourceManager<Res, Pol, Pred, Cmp>::operator==(manager const& rhs) const {
-	return (mSelection == rhs.mSelection) && (mHasValue == rhs.mHasValue);
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+bool ResourceManager<Res, Pol, Pred, Cmp, Sto>::shares_selection(manager const& other) const {
+	return mSelection.shares(other.mSelection);
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-bool ResourceManager<Res, Pol, Pred, Cmp>::operator!=(manager const& rhs) const {
-	return !(*this == rhs);
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+void ResourceManager<Res, Pol, Pred, Cmp, Sto>::detach() {
+	mSelection.mutate();
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-auto ResourceManager<Res, Pol, Pred, Cmp>::begin() const -> iterator_type {
-	filter_type filter = std::bind(
-		&manager::has,
-		this, std::placeholders::_1);
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+bool ResourceManager<Res, Pol, Pred, Cmp, Sto>::operator==(manager const& rhs) const {
+	return (mSelection.shares(rhs.mSelection) || *mSelection == *rhs.mSelection) &&
+	       (mHasValue == rhs.mHasValue);
+}
 
-	return boost::make_filter_iterator(
-		filter, redman::begin(mPredicate), redman::end(mPredicate));
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+bool ResourceManager<Res, Pol, Pred, Cmp, Sto>::operator!=(manager const& rhs) const {
+	return !(*this == rhs);
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-auto ResourceManager<Res, Pol, Pred, Cmp>::end() const -> iterator_type {
-	filter_type filter = std::bind(
-		&manager::has,
-		this, std::placeholders::_1);
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+auto ResourceManager<Res, Pol, Pred, Cmp, Sto>::begin() const -> iterator_type {
+	return iterator_type(mPredicate, *mSelection, false);
+}
 
-	return boost::make_filter_iterator(
-		filter, redman::end(mPredicate), redman::end(mPredicate));
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+auto ResourceManager<Res, Pol, Pred, Cmp, Sto>::end() const -> iterator_type {
+	return iterator_type(mPredicate, *mSelection, true);
 }
 
-template <typename Res, typename Pol, typename Pred, typename Cmp>
-auto ResourceManager<Res, Pol, Pred, Cmp>::enabled() const -> boost::iterator_range<iterator_type>
+template <typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+auto ResourceManager<Res, Pol, Pred, Cmp, Sto>::enabled() const -> boost::iterator_range<iterator_type>
 {
 	return boost::make_iterator_range(begin(), end());
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-auto ResourceManager<Res, Pol, Pred, Cmp>::begin_disabled() const -> iterator_type {
-	filter_type filter = [this](Res const& r) -> bool {
-		return !this->has(r);
-	};
-
-	return boost::make_filter_iterator(
-		filter, redman::begin(mPredicate), redman::end(mPredicate));
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+auto ResourceManager<Res, Pol, Pred, Cmp, Sto>::begin_disabled() const -> disabled_iterator_type {
+	return disabled_iterator_type(mPredicate, *mSelection, false);
 }
 
-template<typename Res, typename Pol, typename Pred, typename Cmp>
-auto ResourceManager<Res, Pol, Pred, Cmp>::end_disabled() const -> iterator_type {
-	filter_type filter = [this](Res const& r) -> bool {
-		return !this->has(r);
-	};
-
-	return boost::make_filter_iterator(
-		filter, redman::end(mPredicate), redman::end(mPredicate));
+template<typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+auto ResourceManager<Res, Pol, Pred, Cmp, Sto>::end_disabled() const -> disabled_iterator_type {
+	return disabled_iterator_type(mPredicate, *mSelection, true);
 }
 
-template <typename Res, typename Pol, typename Pred, typename Cmp>
-auto ResourceManager<Res, Pol, Pred, Cmp>::disabled() const -> boost::iterator_range<iterator_type>
+template <typename Res, typename Pol, typename Pred, typename Cmp, typename Sto>
+auto ResourceManager<Res, Pol, Pred, Cmp, Sto>::disabled() const -> boost::iterator_range<disabled_iterator_type>
 {
 	return boost::make_iterator_range(begin_disabled(), end_disabled());
 }
 
+/** Return an immutable snapshot of a resource manager (or component).
+ *  The snapshot holds its own copy of the selection, laid out without
+ *  spare capacity and not shared with any other manager.  Its const
+ *  member functions can thus be called from any number of threads while
+ *  `manager` is modified, see also `redman::Published`.
+ */
+template<typename Manager>
+boost::shared_ptr<Manager const> freeze(Manager const& manager) {
+	auto snapshot = boost::make_shared<Manager>(manager);
+	snapshot->detach();
+	return snapshot;
+}
+
 } // redman
 #endif // PYPLUSPLUS
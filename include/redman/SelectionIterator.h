@@ -0,0 +1,283 @@
+#pragma once
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/optional.hpp>
+
+#include "redman/Predicate.h"
+#include "redman/Storage.h"
+
+/* Iterators over the resources of a `ResourceManager`.
+ * Depending on the policy one of enabled() and disabled() walks the stored
+ * selection (`StoredIterator`), the other one its complement with respect
+ * to the predicate (`ComplementIterator`).  Both are concrete types, so the
+ * tests for policy and predicate are inlined into the loop.
+ * Enabling or disabling the resource an iterator currently points to does
+ * not invalidate it.  Any other modification of the selection invalidates
+ * iterators over the complement, as they cache the next stored resource:
+ * they may skip resources enabled or yield resources disabled after the
+ * cursor.
+ */
+
+namespace redman {
+
+/** Visits all resources in the selection.
+ *  The current resource may be removed from the selection at any time, so
+ *  the iterator continues from its value via `upper_bound()` instead of
+ *  from its position.
+ *  @tparam Predicate Predicate of the resource manager.
+ *  @tparam Selection Container holding the selection in `Compare` order.
+ *  @tparam Compare Comparison function of the resource manager.
+ */
+template<typename Predicate, typename Selection, typename Compare,
+         bool Stable = storage::HasStableIterators<Selection>::value>
+class StoredIterator :
+	public boost::iterator_facade<
+	StoredIterator<Predicate, Selection, Compare, Stable>,
+	typename Predicate::resource_type,
+	boost::forward_traversal_tag,
+	// Return copy instead of reference:
+	typename Predicate::resource_type>
+{
+	typedef typename Predicate::resource_type resource_type;
+
+public:
+	StoredIterator(Predicate const&, Selection const& selection, bool at_end) :
+		mSelection(&selection), mCurrent()
+	{
+		if (!at_end && !selection.empty())
+			mCurrent = *selection.begin();
+	}
+
+private:
+	friend class boost::iterator_core_access;
+
+	bool equal(StoredIterator const& other) const
+	{
+		if (!mCurrent || !other.mCurrent)
+			return !mCurrent && !other.mCurrent;
+		Compare const cmp;
+		return !cmp(*mCurrent, *other.mCurrent) && !cmp(*other.mCurrent, *mCurrent);
+	}
+
+	void increment()
+	{
+		auto const next = mSelection->upper_bound(*mCurrent);
+		if (next != mSelection->end())
+			mCurrent = *next;
+		else
+			mCurrent = boost::none;
+	}
+
+	resource_type dereference() const
+	{
+		return *mCurrent;
+	}
+
+	Selection const* mSelection;
+	boost::optional<resource_type> mCurrent;
+};
+
+/** Selections whose iterators stay valid when the pointed to resource is
+ *  erased are walked with their own iterator.
+ */
+template<typename Predicate, typename Selection, typename Compare>
+class StoredIterator<Predicate, Selection, Compare, true> :
+	public boost::iterator_facade<
+	StoredIterator<Predicate, Selection, Compare, true>,
+	typename Predicate::resource_type,
+	boost::forward_traversal_tag,
+	// Return copy instead of reference:
+	typename Predicate::resource_type>
+{
+	typedef typename Predicate::resource_type resource_type;
+
+public:
+	StoredIterator(Predicate const&, Selection const& selection, bool at_end) :
+		mIt(at_end ? selection.end() : selection.begin())
+	{}
+
+private:
+	friend class boost::iterator_core_access;
+
+	bool equal(StoredIterator const& other) const
+	{
+		return mIt == other.mIt;
+	}
+
+	void increment()
+	{
+		++mIt;
+	}
+
+	resource_type dereference() const
+	{
+		return *mIt;
+	}
+
+	typename Selection::const_iterator mIt;
+};
+
+
+/** Visits all resources matching the predicate that are not in the selection.
+ *  The predicate range is merged with the (sorted) selection, which is only
+ *  searched again after the iterator passed the next stored resource.
+ *  Hence stored resources are skipped without a per-resource lookup.
+ *  \note Invalidated by modifications of the selection other than of the
+ *        current resource, see above.
+ *  @tparam Predicate Predicate of the resource manager.
+ *  @tparam Selection Container holding the selection in `Compare` order.
+ *  @tparam Compare Comparison function of the resource manager.
+ */
+template<typename Predicate, typename Selection, typename Compare,
+         bool Default = detail::IsDefaultPredicate<Predicate>::value>
+class ComplementIterator :
+	public boost::iterator_facade<
+	ComplementIterator<Predicate, Selection, Compare, Default>,
+	typename Predicate::resource_type,
+	boost::forward_traversal_tag,
+	// Return copy instead of reference:
+	typename Predicate::resource_type>
+{
+	typedef typename Predicate::resource_type resource_type;
+	typedef PredicateIterator<Predicate> predicate_iterator;
+
+public:
+	ComplementIterator(Predicate const& pred, Selection const& selection, bool at_end) :
+		mIt(at_end ? redman::end(pred) : redman::begin(pred)),
+		mEnd(redman::end(pred)),
+		mSelection(&selection),
+		mNextStored()
+	{
+		if (mIt != mEnd) {
+			find_next_stored();
+			skip_stored();
+		}
+	}
+
+private:
+	friend class boost::iterator_core_access;
+
+	/// Look up the first stored resource not before the current one.
+	void find_next_stored()
+	{
+		auto const it = mSelection->lower_bound(*mIt);
+		if (it != mSelection->end())
+			mNextStored = *it;
+		else
+			mNextStored = boost::none;
+	}
+
+	/// Advance until mIt points to a resource not contained in the selection.
+	void skip_stored()
+	{
+		Compare const cmp;
+		while (mIt != mEnd && mNextStored) {
+			resource_type const current = *mIt;
+			if (cmp(current, *mNextStored))
+				break;
+			if (!cmp(*mNextStored, current)) {
+				++mIt;
+				if (mIt == mEnd)
+					break;
+			}
+			find_next_stored();
+		}
+	}
+
+	bool equal(ComplementIterator const& other) const
+	{
+		return mIt == other.mIt;
+	}
+
+	void increment()
+	{
+		++mIt;
+		skip_stored();
+	}
+
+	resource_type dereference() const
+	{
+		return *mIt;
+	}
+
+	predicate_iterator mIt;
+	predicate_iterator mEnd;
+	Selection const* mSelection;
+	boost::optional<resource_type> mNextStored;
+};
+
+/** `DefaultPredicate` accepts every index, so the complement is formed on
+ *  plain indices without constructing resources or calling the predicate.
+ */
+template<typename Predicate, typename Selection, typename Compare>
+class ComplementIterator<Predicate, Selection, Compare, true> :
+	public boost::iterator_facade<
+	ComplementIterator<Predicate, Selection, Compare, true>,
+	typename Predicate::resource_type,
+	boost::forward_traversal_tag,
+	// Return copy instead of reference:
+	typename Predicate::resource_type>
+{
+	typedef typename Predicate::resource_type resource_type;
+	typedef detail::ResourceIndex<resource_type> index_mapping;
+	typedef typename Predicate::index_type index_type;
+	typedef typename index_type::value_type index_value_type;
+
+public:
+	ComplementIterator(Predicate const&, Selection const& selection, bool at_end) :
+		mIndex(at_end ? index_type::end : index_type::begin),
+		mSelection(&selection),
+		mNextStored(index_type::end)
+	{
+		if (mIndex < index_type::end) {
+			find_next_stored();
+			skip_stored();
+		}
+	}
+
+private:
+	friend class boost::iterator_core_access;
+
+	/// Look up the index of the first stored resource not before mIndex.
+	void find_next_stored()
+	{
+		auto const it = mSelection->lower_bound(index_mapping::make(mIndex));
+		mNextStored = it != mSelection->end()
+			? static_cast<index_value_type>(index_mapping::get(*it))
+			: static_cast<index_value_type>(index_type::end);
+	}
+
+	void skip_stored()
+	{
+		while (mIndex == mNextStored) {
+			if (++mIndex >= index_type::end)
+				return;
+			find_next_stored();
+		}
+	}
+
+	bool equal(ComplementIterator const& other) const
+	{
+		return mIndex == other.mIndex;
+	}
+
+	void increment()
+	{
+		++mIndex;
+		if (mIndex >= mNextStored && mIndex < index_type::end) {
+			find_next_stored();
+			skip_stored();
+		}
+	}
+
+	resource_type dereference() const
+	{
+		return index_mapping::make(mIndex);
+	}
+
+	index_value_type mIndex;
+	Selection const* mSelection;
+	index_value_type mNextStored;
+};
+
+} // redman
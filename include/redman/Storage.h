@@ -0,0 +1,28 @@
+#pragma once
+
+#include <boost/type_traits/integral_constant.hpp>
+
+namespace redman {
+
+/** Base class of all storage tags.
+ *  A storage tag selects the container a `ResourceManager` uses to hold its
+ *  selection (i.e. the disabled resources for `Blacklist` and the enabled
+ *  resources for `Whitelist`).  Each tag provides a nested template
+ *  `selection<Resource, Predicate, Compare>::type` naming the container.
+ */
+struct Storage
+{
+};
+
+namespace storage {
+
+/** Whether iterators of a selection container stay valid when the resource
+ *  they point to is erased (or any other resource inserted or erased).
+ *  Specialized by containers whose iterators merely hold an index.
+ */
+template<typename Selection>
+struct HasStableIterators : boost::false_type {};
+
+} // storage
+
+} // redman
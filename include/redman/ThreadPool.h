@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace redman {
+namespace detail {
+
+/** Fixed number of worker threads executing submitted tasks in order.
+ *  The destructor finishes all pending tasks before joining the workers.
+ */
+class ThreadPool
+{
+public:
+	/// Start `threads` workers, one per hardware thread if zero.
+	explicit ThreadPool(size_t threads = 0);
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	size_t size() const;
+
+	/** Queue `task` for execution.
+	 *  Its result, or the exception it throws, is delivered via the future.
+	 */
+	template<typename Task>
+	std::future<typename std::result_of<Task()>::type> submit(Task task);
+
+private:
+	void push(std::function<void()> job);
+	void work();
+
+	std::vector<std::thread> mWorkers;
+	std::deque<std::function<void()> > mQueue;
+	std::mutex mMutex;
+	std::condition_variable mPending;
+	bool mStopping;
+};
+
+template<typename Task>
+std::future<typename std::result_of<Task()>::type> ThreadPool::submit(Task task)
+{
+	typedef typename std::result_of<Task()>::type result_type;
+	// std::function needs a copyable target
+	auto const job = std::make_shared<std::packaged_task<result_type()> >(std::move(task));
+	auto result = job->get_future();
+	push([job]() { (*job)(); });
+	return result;
+}
+
+/** Pool shared by the asynchronous operations of backends and resources.
+ *  Created on first use, with at least four workers as its tasks mostly
+ *  wait for I/O.  Tasks must not wait for other tasks of this pool.
+ */
+ThreadPool& io_pool();
+
+} // detail
+} // redman
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+
+#include <boost/cstdint.hpp>
+
+namespace redman {
+
+/** Bitmap of the indices accepted by a predicate.
+ *  Predicates can publish such a mask to let `PredicateIterator` jump to the
+ *  next valid index with a count-trailing-zeros scan instead of evaluating
+ *  the predicate for every index in between.  To do so a predicate defines
+ *  `typedef void has_validity_mask;` and a member function
+ *  `ValidityMask<index_type> const& validity_mask() const`, see
+ *  `StaticValidityMask` for stateless predicates.
+ *  @tparam Index Index type of the predicate, providing `begin` and `end`.
+ */
+template<typename Index>
+class ValidityMask
+{
+public:
+	typedef boost::uint64_t word_type;
+	typedef typename Index::value_type value_type;
+
+	static std::size_t const word_bits = 64;
+	static std::size_t const words = (std::size_t(Index::end) + word_bits - 1) / word_bits;
+
+	/// Evaluate `predicate` once for every index.
+	template<typename Predicate>
+	explicit ValidityMask(Predicate const& predicate) :
+		mCount(0)
+	{
+		for (std::size_t w = 0; w < words; ++w)
+			mWords[w] = 0;
+		for (value_type idx = Index::begin; idx < Index::end; ++idx) {
+			if (predicate(predicate.construct(Index(idx))))
+				mWords[idx / word_bits] |= word_type(1) << (idx % word_bits);
+		}
+		for (std::size_t w = 0; w < words; ++w) {
+			mRank[w] = mCount;
+			mCount += __builtin_popcountll(mWords[w]);
+		}
+	}
+
+	/// Whether the index is accepted, indices outside the range are not.
+	bool test(value_type idx) const
+	{
+		if (idx < Index::begin || idx >= Index::end)
+			return false;
+		return (mWords[idx / word_bits] >> (idx % word_bits)) & 1;
+	}
+
+	/// First accepted index at or after `idx`, `Index::end` if none.
+	value_type next(value_type idx) const
+	{
+		if (idx < Index::begin)
+			idx = Index::begin;
+		if (idx >= Index::end)
+			return Index::end;
+
+		std::size_t w = idx / word_bits;
+		word_type word = mWords[w] & (~word_type(0) << (idx % word_bits));
+		while (!word) {
+			if (++w == words)
+				return Index::end;
+			word = mWords[w];
+		}
+		return static_cast<value_type>(w * word_bits + __builtin_ctzll(word));
+	}
+
+	/// Last accepted index before `idx`, `Index::end` if none.
+	value_type prev(value_type idx) const
+	{
+		if (idx <= Index::begin)
+			return Index::end;
+		if (idx > Index::end)
+			idx = Index::end;
+
+		std::size_t w = (idx - 1) / word_bits;
+		std::size_t const shift = word_bits - 1 - (idx - 1) % word_bits;
+		word_type word = (mWords[w] << shift) >> shift;
+		while (!word) {
+			if (w-- == 0)
+				return Index::end;
+			word = mWords[w];
+		}
+		return static_cast<value_type>(w * word_bits + word_bits - 1 - __builtin_clzll(word));
+	}
+
+	/// Number of accepted indices before `idx`, constant time.
+	std::size_t rank(value_type idx) const
+	{
+		if (idx >= Index::end)
+			return mCount;
+		if (idx < Index::begin)
+			return 0;
+		std::size_t const w = idx / word_bits;
+		word_type const below = (word_type(1) << (idx % word_bits)) - 1;
+		return mRank[w] + __builtin_popcountll(mWords[w] & below);
+	}
+
+	/// Number of accepted indices.
+	std::size_t count() const
+	{
+		return mCount;
+	}
+
+private:
+	word_type mWords[words];
+	/// Number of accepted indices in all words before.
+	std::size_t mRank[words];
+	std::size_t mCount;
+};
+
+/** Mixin for stateless predicates computing their validity mask once on
+ *  first use.  Usage:
+ *  \code
+ *  struct EvenPredicate : DefaultPredicate<Res>, StaticValidityMask<EvenPredicate> { ... };
+ *  \endcode
+ *  \note The predicate must not have state, as the mask is shared by all
+ *        instances.
+ */
+template<typename Derived>
+struct StaticValidityMask
+{
+	typedef void has_validity_mask;
+
+	template<typename D = Derived>
+	ValidityMask<typename D::index_type> const& validity_mask() const
+	{
+		static ValidityMask<typename D::index_type> const mask(static_cast<D const&>(*this));
+		return mask;
+	}
+};
+
+} // redman
@@ -8,21 +8,24 @@
 
 #include "redman/Policy.h"
 
+#ifndef PYPLUSPLUS
+#include "redman/storage/algorithm.h"
+#endif // PYPLUSPLUS
+
 namespace redman {
 
 struct Whitelist :
 	public Policy
 {
+	/// The selection holds the enabled resources.
+	static bool const stores_enabled = true;
+
 	template<typename Set, typename Predicate>
 	static
 	void enable_all(Set& set, Predicate const& predicate)
 	{
 #ifndef PYPLUSPLUS
-		set.clear();
-		for (auto res : predicate)
-		{
-			set.insert(res);
-		}
+		storage::fill(set, predicate);
 #endif // PYPLUSPLUS
 	}
 
@@ -37,17 +40,15 @@ struct Whitelist :
 	static
 	bool has(Set const& set, typename Set::const_reference val)
 	{
-		if (set.find(val) == set.end())
-			return false;
-		return true;
+		return set.count(val) != 0;
 	}
 
 	template<typename Set>
 	static
 	void enable(Set& set, typename Set::const_reference val, switch_mode::type mode = switch_mode::THROW)
 	{
-		std::pair<typename Set::iterator, bool> r = set.insert(val);
-		if ((mode == switch_mode::THROW) && !r.second) {
+		bool const inserted = set.insert(val).second;
+		if ((mode == switch_mode::THROW) && !inserted) {
 			std::stringstream error_msg;
 			error_msg << "could not enable resource: " << val;
 			throw std::runtime_error(error_msg.str().c_str());
@@ -58,39 +59,136 @@ struct Whitelist :
 	static
 	void disable(Set& set, typename Set::const_reference val, switch_mode::type mode = switch_mode::THROW)
 	{
-		typename Set::const_iterator it = set.find(val);
-		if (it == set.end()) {
+		if (set.erase(val) == 0) {
 			if (mode == switch_mode::NONTHROW) return;
 			std::stringstream error_msg;
 			error_msg << "could not disable resource: " << val;
 			throw std::runtime_error(error_msg.str().c_str());
 		}
-		set.erase(it);
 	}
 
-	template<typename Set, typename Predicate>
+	template<typename Set>
 	static
-	size_t available(Set const& set, Predicate const&)
+	size_t available(Set const& set, size_t const /*cardinality*/)
 	{
 		return set.size();
 	}
 
-	template<typename Set, typename Predicate>
+	template<typename Set, typename Predicate, typename Other>
 	static
 	void from_set(
 		Set& set,
 		Predicate const& predicate,
-		Set const& other)
+		Other const& other)
+	{
+#ifndef PYPLUSPLUS
+		set.clear();
+		for (auto const& res : other)
+		{
+			if (predicate(res))
+				set.insert(set.end(), res);
+		}
+#endif // PYPLUSPLUS
+	}
+
+	/// Take over `other` as selection, it must only contain valid resources.
+	template<typename Set, typename Predicate>
+	static
+	void from_set(
+		Set& set,
+		Predicate const&,
+		Set&& other)
+	{
+		set = std::move(other);
+	}
+
+#ifndef PYPLUSPLUS
+	/// Enable a sorted range of distinct resources, return the number changed.
+	template<typename Set, typename InputIterator>
+	static
+	size_t enable_many(Set& set, InputIterator first, InputIterator last)
+	{
+		return storage::insert_many(set, first, last);
+	}
+
+	/// Disable a sorted range of distinct resources, return the number changed.
+	template<typename Set, typename InputIterator>
+	static
+	size_t disable_many(Set& set, InputIterator first, InputIterator last)
+	{
+		return storage::erase_many(set, first, last);
+	}
+
+	/* Order statistics on the enabled resources, which are exactly the
+	   selection. */
+
+	template<typename Set, typename Predicate>
+	static
+	size_t rank(Set const& set, Predicate const&, typename Set::const_reference val)
+	{
+		return storage::rank(set, val);
+	}
+
+	template<typename Set, typename Predicate>
+	static
+	typename Set::value_type select(Set const& set, Predicate const&, size_t k)
+	{
+		return storage::select(set, k);
+	}
+
+	template<typename Set, typename Predicate>
+	static
+	boost::optional<typename Set::value_type>
+	next(Set const& set, Predicate const&, typename Set::const_reference val)
+	{
+		return storage::next(set, val);
+	}
+
+	template<typename Set, typename Predicate>
+	static
+	boost::optional<typename Set::value_type>
+	prev(Set const& set, Predicate const&, typename Set::const_reference val)
+	{
+		return storage::prev(set, val);
+	}
+#endif // PYPLUSPLUS
+
+	/* Set algebra on the enabled resources of two managers sharing the same
+	   predicate, which are exactly their selections. */
+
+	template<typename Set, typename Predicate>
+	static
+	void merge(Set& set, Set const& other, Predicate const&)
+	{
+#ifndef PYPLUSPLUS
+		storage::merge(set, other);
+#endif // PYPLUSPLUS
+	}
+
+	template<typename Set, typename Predicate>
+	static
+	void intersection(Set& set, Set const& other, Predicate const&)
+	{
+#ifndef PYPLUSPLUS
+		storage::intersection(set, other);
+#endif // PYPLUSPLUS
+	}
+
+	template<typename Set, typename Predicate>
+	static
+	void difference(Set& set, Set const& other, Predicate const&)
+	{
+#ifndef PYPLUSPLUS
+		storage::difference(set, other);
+#endif // PYPLUSPLUS
+	}
+
+	template<typename Set, typename Predicate>
+	static
+	void symmetric_difference(Set& set, Set const& other, Predicate const&)
 	{
 #ifndef PYPLUSPLUS
-		enable_all(set, predicate);
-		Set res;
-		std::set_intersection(
-			set.begin(), set.end(),
-			other.begin(), other.end(),
-			std::inserter(res, res.begin()),
-			typename Set::key_compare());
-		set = std::move(res);
+		storage::symmetric_difference(set, other);
 #endif // PYPLUSPLUS
 	}
 };
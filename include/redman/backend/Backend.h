@@ -4,6 +4,11 @@
 #include <string>
 #include <map>
 
+#ifndef PYPLUSPLUS
+#include <future>
+#include <vector>
+#endif // PYPLUSPLUS
+
 #include <boost/serialization/assume_abstract.hpp>
 #include <boost/serialization/serialization.hpp>
 
@@ -33,6 +38,7 @@ private:
 };
 
 class Library;
+class Compression;
 class Backend
 {
 public:
@@ -50,6 +56,46 @@ public:
 
 	virtual void store(std::string const& id, resources::Base const&) = 0;
 
+	/** Token identifying the stored version of the data set `id`.
+	 *  It changes whenever the data set changes, also if it is written by
+	 *  another process, see `file_revision()`.  Returns an empty string
+	 *  if the backend cannot tell, which is the default.
+	 */
+	virtual std::string revision(std::string const& id) const;
+
+#ifndef PYPLUSPLUS
+	/** Start loading the resource with the given id.
+	 *  By default `load()` is run on a thread pool shared by all backends,
+	 *  backends with native asynchronous I/O may override this.  The backend
+	 *  and the resource have to outlive the returned future, the resource
+	 *  must not be accessed until it is ready.  Errors, e.g.
+	 *  `not_found_error`, are rethrown by `future::get()`.
+	 */
+	virtual std::future<void> load_async(std::string const& id, resources::Base&);
+
+	/** Start storing the resource with the given id, see `load_async()`.
+	 *  The resource must not be modified until the returned future is ready.
+	 */
+	virtual std::future<void> store_async(std::string const& id, resources::Base const&);
+
+	/** Load `resources[i]` from the data set `ids[i]` for all `i`.
+	 *  Returns whether each data set was found, resources whose data set
+	 *  is missing are left unchanged instead of throwing `not_found_error`.
+	 *  By default calls `load()` for each resource, backends that can read
+	 *  several data sets in one operation or transaction should override it.
+	 */
+	virtual std::vector<bool> load_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base*> const& resources);
+
+	/** Store `resources[i]` as data set `ids[i]` for all `i`.
+	 *  By default calls `store()` for each resource, see `load_many()`.
+	 */
+	virtual void store_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base const*> const& resources);
+#endif // PYPLUSPLUS
+
 protected:
 	typedef boost::variant<std::string, int> config_value_t;
 	typedef std::map<std::string, config_value_t> config_map_t;
@@ -59,6 +105,27 @@ protected:
 
 	bool exists(std::string const& key) const;
 
+	/** Compression of stored payloads as configured by `compression`
+	 *  (`none` or `zlib`) and `compression_level` (0 to 9, as integer or
+	 *  string).  Throws `std::invalid_argument` for invalid settings.
+	 *  File based backends should compress what they store and pass what
+	 *  they load through `Compression::decompress()`.
+	 */
+	Compression compression() const;
+
+	/// Throw if the compression settings are invalid, call it in `init()`.
+	void check_compression() const;
+
+	/** Non-negative size configured for `key`, as integer or as string.
+	 *  Throws `std::invalid_argument` for invalid values.
+	 */
+	size_t get_size(std::string const& key) const;
+
+	/** Revision of a file made of its inode, size and modification time,
+	 *  `-` if it does not exist.
+	 */
+	static std::string file_revision(std::string const& file);
+
 	template<typename T>
 	T& get(std::string const& key);
 
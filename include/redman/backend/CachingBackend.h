@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/serialization/export.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "redman/backend/Backend.h"
+
+namespace redman {
+namespace backend {
+
+/** Hit/miss counters of a `CachingBackend`.
+ */
+struct CacheStatistics
+{
+	CacheStatistics();
+
+	/// Loads served from the cache.
+	size_t hits;
+	/// Loads forwarded to the wrapped backend.
+	size_t misses;
+	/// Entries dropped because the data set was stored or changed on disk.
+	size_t invalidations;
+	/// Entries dropped to stay within the capacity.
+	size_t evictions;
+	/// Number and total size in bytes of the cached payloads.
+	size_t entries;
+	size_t bytes;
+};
+
+/** Keeps the data sets loaded through another backend in memory.
+ *  Resources are cached as serialized payloads in an LRU of at most
+ *  `cache_size` bytes (configured before `init()` as integer or string,
+ *  64 MiB by default).
+ *  Before serving a hit the entry's `Backend::revision()` is compared to
+ *  the current one, i.e. data sets changed by other processes are
+ *  reloaded.  Data sets stored through this backend are dropped from the
+ *  cache.  If the wrapped backend does not provide revisions, changes
+ *  made behind its back are only seen after `invalidate()`.
+ *
+ *  The wrapped backend is configured and initialized by the caller, share
+ *  one instance between resources to profit from the cache:
+ *  \code
+ *  auto backend = boost::make_shared<CachingBackend>(loadBackend(lib));
+ *  \endcode
+ *  Archives hold the wrapped backend and the capacity, not the cache.
+ */
+class CachingBackend :
+	public Backend
+{
+public:
+	/// Capacity in bytes if `cache_size` is not configured.
+	static size_t const default_capacity;
+
+	explicit CachingBackend(boost::shared_ptr<Backend> backend);
+	virtual ~CachingBackend();
+
+	virtual void init();
+
+	virtual void load(std::string const& id, resources::Base&);
+
+	virtual void store(std::string const& id, resources::Base const&);
+
+	virtual std::string revision(std::string const& id) const;
+
+#ifndef PYPLUSPLUS
+	virtual std::vector<bool> load_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base*> const& resources);
+
+	virtual void store_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base const*> const& resources);
+#endif // PYPLUSPLUS
+
+	boost::shared_ptr<Backend> backend() const;
+
+	/// Drop the cached data set `id`.
+	void invalidate(std::string const& id);
+
+	/// Drop all cached data sets.
+	void clear();
+
+	CacheStatistics statistics() const;
+
+	/// Reset the hit, miss, invalidation and eviction counters.
+	void reset_statistics();
+
+private:
+	/// For deserialization only.
+	CachingBackend();
+
+	struct Entry
+	{
+		std::string id;
+		std::string revision;
+		std::string payload;
+	};
+	typedef std::list<Entry> lru_type;
+	typedef std::unordered_map<std::string, lru_type::iterator> index_type;
+
+	/** Copy the cached data set into `res` if it is still at `revision`.
+	 *  `generation` is set to the value `insert()` expects on a miss.
+	 */
+	bool lookup(
+		std::string const& id, std::string const& revision,
+		resources::Base& res, size_t& generation);
+
+	/** Cache `res` as data set `id` unless anything was stored or
+	 *  invalidated since `lookup()` returned `generation`.
+	 */
+	void insert(
+		std::string const& id, std::string const& revision,
+		resources::Base const& res, size_t generation);
+
+	void invalidate(std::vector<std::string> const& ids);
+
+	/// Drop entries until they fit into the capacity, requires `mMutex`.
+	void shrink();
+
+	/// Drop the given entry, requires `mMutex`.
+	void erase(index_type::iterator it);
+
+	boost::shared_ptr<Backend> mBackend;
+	size_t mCapacity;
+
+	mutable std::mutex mMutex;
+	/// Most recently used entries first.
+	lru_type mEntries;
+	index_type mIndex;
+	/// Incremented on every store and invalidation.
+	size_t mGeneration;
+	CacheStatistics mStatistics;
+
+	friend class boost::serialization::access;
+	template<typename Archiver>
+	void serialize(Archiver& ar, unsigned int const);
+};
+
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_KEY(redman::backend::CachingBackend)
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+
+namespace redman {
+namespace backend {
+
+/** Compression of the payloads written by backends.
+ *  Compressed payloads are gzip streams, i.e. compressed files can be
+ *  inspected with `zcat`.  `decompress()` recognizes them by their magic
+ *  bytes, so backends read compressed and uncompressed data alike.
+ *  See `Backend::compression()` for the configuration.
+ */
+class Compression
+{
+public:
+	enum Method
+	{
+		NONE,
+		ZLIB
+	};
+
+	/// Level used if none is configured, trading speed for size.
+	static int const default_level;
+
+	/// No compression.
+	Compression();
+
+	/** Throws `std::invalid_argument` for levels outside of [0, 9].
+	 */
+	explicit Compression(Method method, int level = default_level);
+
+	/** Parse the method name, `none` or `zlib`.
+	 *  Throws `std::invalid_argument` for unknown or unsupported methods.
+	 */
+	Compression(std::string const& method, int level = default_level);
+
+	Method method() const;
+	int level() const;
+
+	/// Compress `data`, returns it unchanged for `NONE`.
+	std::string compress(std::string const& data) const;
+
+	/// Whether `data` starts like a compressed payload.
+	static bool is_compressed(std::string const& data);
+
+	/** Decompress `data` if it is compressed, otherwise return it unchanged.
+	 *  Throws `std::runtime_error` for corrupt compressed data.
+	 */
+	static std::string decompress(std::string const& data);
+
+private:
+	Method mMethod;
+	int    mLevel;
+};
+
+} // backend
+} // redman
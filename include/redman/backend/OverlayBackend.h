@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/serialization/export.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "redman/backend/Backend.h"
+
+namespace redman {
+namespace backend {
+
+/** Stacks backends on top of each other, e.g. a local writable directory
+ *  over shared read-only defect data.  Stores go to the top layer only.
+ *  How loads are resolved is chosen by the `mode` config:
+ *
+ *  - `first` (default): the data set of the topmost layer holding it.
+ *  - `intersection`: the data sets of all layers holding it, intersected
+ *    per component, i.e. a resource is only enabled if enabled in all of
+ *    them.
+ *  - `merge`: the data sets of all layers holding it, merged per
+ *    component, i.e. a resource is enabled if enabled in any of them.
+ *
+ *  Loads throw `not_found_error` if no layer holds the data set.  The
+ *  combining modes support the wafer, HICANN and FPGA resources.
+ *  The layers are configured and initialized by the caller, archives hold
+ *  them together with the mode.
+ */
+class OverlayBackend :
+	public Backend
+{
+public:
+	enum Mode
+	{
+		FIRST,
+		INTERSECTION,
+		MERGE
+	};
+
+	OverlayBackend();
+
+	/// Layers ordered from top to bottom.
+	explicit OverlayBackend(std::vector<boost::shared_ptr<Backend> > const& layers);
+
+	virtual ~OverlayBackend();
+
+	virtual void init();
+
+	virtual void load(std::string const& id, resources::Base&);
+
+	virtual void store(std::string const& id, resources::Base const&);
+
+	/// Revisions of all layers, empty if any of them cannot tell.
+	virtual std::string revision(std::string const& id) const;
+
+#ifndef PYPLUSPLUS
+	/// Loads with one `load_many()` per layer.
+	virtual std::vector<bool> load_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base*> const& resources);
+
+	virtual void store_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base const*> const& resources);
+#endif // PYPLUSPLUS
+
+	/// Add a layer below all present ones, must not be called concurrently to loads.
+	void add_layer(boost::shared_ptr<Backend> layer);
+
+	std::vector<boost::shared_ptr<Backend> > const& layers() const;
+
+	Mode mode() const;
+
+private:
+	/// The top layer, throws if there is none.
+	Backend& top() const;
+
+	std::vector<boost::shared_ptr<Backend> > mLayers;
+	Mode mMode;
+
+	friend class boost::serialization::access;
+	template<typename Archiver>
+	void serialize(Archiver& ar, unsigned int const);
+};
+
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_KEY(redman::backend::OverlayBackend)
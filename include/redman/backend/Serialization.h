@@ -0,0 +1,34 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+namespace redman {
+namespace resources {
+class Base;
+} // resources
+
+namespace backend {
+
+/* Binary archives of resources as written by the binary, bundle and SQLite
+ * backends and kept by the caching backend.  Resources are archived via a
+ * pointer to `resources::Base`, so they are restored as their dynamic type
+ * and copied into the target with `Base::copy()`.
+ */
+
+/// Write `res` as binary archive to `stream`.
+void save_resource(std::ostream& stream, resources::Base const& res);
+
+/// Read a binary archive written by `save_resource()` into `res`.
+void load_resource(std::istream& stream, resources::Base& res);
+
+/// Binary archive of `res`.
+std::string serialize_resource(resources::Base const& res);
+
+/** Restore `res` from a payload of `serialize_resource()`, which may have
+ *  been compressed, see `Compression::decompress()`.
+ */
+void deserialize_resource(std::string const& payload, resources::Base& res);
+
+} // backend
+} // redman
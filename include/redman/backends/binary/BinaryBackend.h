@@ -0,0 +1,51 @@
+#pragma once
+
+#include <boost/serialization/export.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include "redman/backend/Backend.h"
+
+namespace redman {
+namespace backend {
+
+/** Stores each resource as Boost binary archive in `<path>/<id>.bin`.
+ *  The archive is preceded by a small header holding a magic number, the
+ *  format version and the byte order of the writing machine.  Binary
+ *  archives are not portable, so files written with a different byte
+ *  order or a newer format version are rejected on load.
+ */
+class BinaryBackend :
+	public Backend
+{
+public:
+	/// Version of the file format written by this backend.
+	static unsigned int const format_version;
+
+	BinaryBackend();
+	virtual ~BinaryBackend();
+
+	virtual void init();
+
+	virtual void load(std::string const& id, resources::Base&);
+
+	virtual void store(std::string const& id, resources::Base const&);
+
+	virtual std::string revision(std::string const& id) const;
+
+private:
+	typedef boost::filesystem::path path;
+
+	path getFilename(std::string const& id) const;
+
+	path  mPath;
+
+	friend class boost::serialization::access;
+	template<typename Archiver>
+	void serialize(Archiver& ar, unsigned int const);
+};
+
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_KEY(redman::backend::BinaryBackend)
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/serialization/export.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include "redman/backend/Backend.h"
+
+namespace redman {
+namespace backend {
+
+/** Packs all resources of a wafer into a single file `<path>/wafer-<N>.bundle`.
+ *  The wafer `N` is the first number in the id, i.e. `wafer-…`,
+ *  `hicann-…` and `fpga-…` of the same wafer share a bundle.  A bundle
+ *  holds Boost binary archives of the resources followed by an index of
+ *  id -> (offset, length, CRC-32), located via a fixed-size header.
+ *
+ *  - `load()` reads one resource with a single `pread`, the index is
+ *    cached as long as the file does not change.
+ *  - `load_many()` reads each bundle with one sequential read.
+ *  - `store()` and `store_many()` append the new archives and a new
+ *    index, then point the header to it.  Writers hold an exclusive file
+ *    lock, readers never see partial updates.  Bundles are compacted
+ *    once most of their content is outdated.
+ */
+class BundleBackend :
+	public Backend
+{
+public:
+	BundleBackend();
+	virtual ~BundleBackend();
+
+	virtual void init();
+
+	virtual void load(std::string const& id, resources::Base&);
+
+	virtual void store(std::string const& id, resources::Base const&);
+
+	virtual std::string revision(std::string const& id) const;
+
+	virtual std::vector<bool> load_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base*> const& resources);
+
+	virtual void store_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base const*> const& resources);
+
+	/// Name of the bundle file holding the given id.
+	std::string bundle(std::string const& id) const;
+
+private:
+	typedef boost::filesystem::path path;
+
+	struct Entry
+	{
+		std::uint64_t offset;
+		std::uint64_t length;
+		std::uint32_t checksum;
+	};
+
+	typedef std::map<std::string, Entry> index_type;
+
+	struct CachedIndex
+	{
+		std::uint64_t inode;
+		std::uint64_t size;
+		std::int64_t mtime;
+		index_type index;
+	};
+
+	/// Look up `id` in the bundle opened as `fd`, using the cached index if possible.
+	bool lookup(int fd, std::string const& file, std::string const& id, Entry& entry) const;
+
+	void store_bundle(
+		std::string const& file,
+		std::vector<std::string> const& ids,
+		std::vector<std::string> const& payloads);
+
+	path  mPath;
+
+	mutable std::mutex mCacheMutex;
+	mutable std::map<std::string, CachedIndex> mIndexCache;
+
+	friend class boost::serialization::access;
+	template<typename Archiver>
+	void serialize(Archiver& ar, unsigned int const);
+};
+
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_KEY(redman::backend::BundleBackend)
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <boost/serialization/export.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "redman/backend/Backend.h"
+#include "redman/flat/File.h"
+
+namespace redman {
+namespace backend {
+
+/** Stores the components of wafers, HICANNs and FPGAs in the flat format
+ *  of `redman/flat/Format.h` as `<path>/<id>.flat`.
+ *  Loading maps the file and copies the enabled resources into the
+ *  components, `view()` gives direct read-only access to the mapping
+ *  without copying anything.
+ *  As the files are mapped, they are never compressed: `init()` throws
+ *  `std::invalid_argument` if a `compression` other than `none` is
+ *  configured.
+ */
+class FlatBackend :
+	public Backend
+{
+public:
+	FlatBackend();
+	virtual ~FlatBackend();
+
+	virtual void init();
+
+	virtual void load(std::string const& id, resources::Base&);
+
+	virtual void store(std::string const& id, resources::Base const&);
+
+	virtual std::string revision(std::string const& id) const;
+
+	/** Map the data set with the given id read-only.
+	 *  Throws `not_found_error` if it does not exist.
+	 *  \see redman::flat::MappedResource::component()
+	 */
+	boost::shared_ptr<flat::MappedResource const> view(std::string const& id) const;
+
+private:
+	typedef boost::filesystem::path path;
+
+	path getFilename(std::string const& id) const;
+
+	path  mPath;
+
+	friend class boost::serialization::access;
+	template<typename Archiver>
+	void serialize(Archiver& ar, unsigned int const);
+};
+
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_KEY(redman::backend::FlatBackend)
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/serialization/export.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include "redman/backend/Backend.h"
+
+namespace redman {
+namespace backend {
+
+/** Stores resources as Boost binary archives in the SQLite database
+ *  `<path>/redman.sqlite` (the file name can be changed via the `file`
+ *  config), keyed by the resource id.
+ *
+ *  The database runs in WAL mode, i.e. readers proceed concurrently with
+ *  one writer, also across processes.  Each thread uses its own
+ *  connection with prepared statements, `store_many()` saves all
+ *  resources in a single transaction and `load_many()` fetches them with
+ *  one query per 500 ids.
+ */
+class SQLiteBackend :
+	public Backend
+{
+public:
+	SQLiteBackend();
+	virtual ~SQLiteBackend();
+
+	virtual void init();
+
+	virtual void load(std::string const& id, resources::Base&);
+
+	virtual void store(std::string const& id, resources::Base const&);
+
+	virtual std::string revision(std::string const& id) const;
+
+	virtual std::vector<bool> load_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base*> const& resources);
+
+	virtual void store_many(
+		std::vector<std::string> const& ids,
+		std::vector<resources::Base const*> const& resources);
+
+	/// Version of the database schema, stored as `PRAGMA user_version`.
+	static int const schema_version;
+
+private:
+	typedef boost::filesystem::path path;
+
+	class Connection;
+	struct Release
+	{
+		SQLiteBackend const* backend;
+		void operator()(Connection* connection) const;
+	};
+	typedef std::unique_ptr<Connection, Release> lease_type;
+
+	/// Idle connection of the pool, opens a new one if there is none.
+	lease_type connection() const;
+
+	path database() const;
+
+	path        mPath;
+	std::string mFile;
+
+	mutable std::mutex mPoolMutex;
+	mutable std::vector<std::unique_ptr<Connection> > mIdle;
+
+	friend class boost::serialization::access;
+	template<typename Archiver>
+	void serialize(Archiver& ar, unsigned int const);
+};
+
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_KEY(redman::backend::SQLiteBackend)
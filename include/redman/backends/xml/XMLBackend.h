@@ -26,6 +26,8 @@ public:
 
 	virtual void store(std::string const& id, resources::Base const&);
 
+	virtual std::string revision(std::string const& id) const;
+
 
 private:
 	typedef boost::filesystem::path path;
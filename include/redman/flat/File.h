@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "redman/Predicate.h"
+#include "redman/flat/Format.h"
+#include "redman/flat/View.h"
+
+namespace redman {
+namespace flat {
+
+/** Flat file mapped read-only into memory.
+ *  The mapping is shared with all other processes mapping the same file,
+ *  opening a file validates its header and the section payloads,
+ *  including the stored counts of enabled resources.
+ */
+class MappedResource
+{
+public:
+	/// Map the given file, throws `std::runtime_error` if it is no valid flat file.
+	static boost::shared_ptr<MappedResource const> open(std::string const& filename);
+
+	~MappedResource();
+
+	MappedResource(MappedResource const&) = delete;
+	MappedResource& operator=(MappedResource const&) = delete;
+
+	/// Names of the stored components.
+	std::vector<std::string> components() const;
+
+	bool has_component(std::string const& name) const;
+
+	/** Return a view of the enabled resources of the named component.
+	 *  `Component` is the type of the resource manager it was written from.
+	 *  The view keeps this mapping alive.
+	 */
+	template<typename Component>
+	View<typename Component::resource> component(std::string const& name) const;
+
+private:
+	MappedResource(std::string const& filename);
+
+	SectionEntry const* find(std::string const& name) const;
+	SectionEntry const& section(std::string const& name) const;
+
+	/// Owns the mapping, shared with all views.
+	boost::shared_ptr<void const> mMapping;
+	char const* mData;
+	std::size_t mSize;
+	FileHeader const* mHeader;
+	SectionEntry const* mSections;
+};
+
+/** Collects components and writes them as flat file.
+ */
+class Writer
+{
+public:
+	/// Add the enabled resources of `manager` as component `name`.
+	template<typename Manager>
+	void add(std::string const& name, Manager const& manager);
+
+	/// Write all components to `filename`, replacing it atomically.
+	void write(std::string const& filename) const;
+
+private:
+	struct Section
+	{
+		std::string name;
+		std::uint32_t index_size;
+		bool has_value;
+		std::vector<std::uint32_t> indices;
+	};
+
+	std::vector<Section> mSections;
+};
+
+template<typename Component>
+View<typename Component::resource> MappedResource::component(std::string const& name) const
+{
+	SectionEntry const& entry = section(name);
+	return View<typename Component::resource>(mMapping, entry, mData + entry.offset);
+}
+
+template<typename Manager>
+void Writer::add(std::string const& name, Manager const& manager)
+{
+	typedef redman::detail::ResourceIndex<typename Manager::resource> index_type;
+	Section section;
+	section.name = name;
+	section.index_size = index_type::index_type::end;
+	section.has_value = manager.has_value();
+	section.indices.reserve(manager.available());
+	for (auto const& res : manager)
+		section.indices.push_back(static_cast<std::uint32_t>(index_type::get(res)));
+	mSections.push_back(std::move(section));
+}
+
+} // flat
+} // redman
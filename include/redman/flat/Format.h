@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Flat defect format, designed to be queried in place after mapping the
+ * file into memory.  A file holds the components of one resource:
+ *
+ *   FileHeader | SectionEntry * sections | padding | payload | padding | ...
+ *
+ * Every payload starts at a multiple of `alignment` and holds the enabled
+ * indices of one component, either as bitmap of `index_size` bits in
+ * 64 bit words or as list of half-open runs `[begin, end)` of 32 bit
+ * integers, whichever is smaller.  All integers are stored in the byte
+ * order of the writing machine, files with a foreign byte order are
+ * rejected.
+ */
+
+namespace redman {
+namespace flat {
+
+/// Offset alignment of payloads, one cache line.
+std::size_t const alignment = 64;
+
+/// Version of the format written by this library.
+std::uint32_t const format_version = 1;
+
+/// Written in native byte order to detect files of foreign machines.
+std::uint32_t const byte_order_mark = 0x01020304;
+
+struct Encoding
+{
+	enum type : std::uint32_t { BITMAP = 0, RUNS = 1 };
+};
+
+struct FileHeader
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byte_order;
+	std::uint32_t sections;
+	std::uint32_t reserved;
+};
+
+struct SectionEntry
+{
+	enum flag_type : std::uint32_t {
+		/// The component was modified, see `ResourceManager::has_value()`.
+		HAS_VALUE = 1
+	};
+
+	/// Component name, zero-terminated.
+	char name[28];
+	std::uint32_t flags;
+	std::uint32_t encoding;
+	/// Number of indices of the component's resource type.
+	std::uint32_t index_size;
+	/// Number of enabled resources.
+	std::uint64_t count;
+	/// Offset of the payload from the start of the file.
+	std::uint64_t offset;
+	/// Number of 64 bit words (bitmap) or runs.
+	std::uint64_t length;
+};
+
+static_assert(sizeof(FileHeader) == 24, "unexpected padding in flat::FileHeader");
+static_assert(sizeof(SectionEntry) == 64, "unexpected padding in flat::SectionEntry");
+
+extern char const magic[8];
+
+} // flat
+} // redman
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <type_traits>
+
+#include "redman/resources/Fpga.h"
+#include "redman/resources/Hicann.h"
+#include "redman/resources/Wafer.h"
+
+/* Components of the resources, as stored in flat files.  Components are
+ * named as in the serialized archives.  `Function` is called as
+ * `f(name, component)` with a (possibly null) shared pointer to each
+ * component, const for const resources.
+ */
+
+namespace redman {
+namespace flat {
+
+namespace detail {
+
+template<typename T, typename Resource>
+struct EnableIfResource :
+	std::enable_if<std::is_same<typename std::remove_const<T>::type, Resource>::value>
+{};
+
+} // detail
+
+template<typename HicannT, typename Function>
+typename detail::EnableIfResource<HicannT, resources::Hicann>::type
+for_each_component(HicannT& hicann, Function& f)
+{
+	f("neurons", hicann.neurons());
+	f("synapses", hicann.synapses());
+	f("drivers", hicann.drivers());
+	f("synaptic_inputs", hicann.synaptic_inputs());
+	f("hbuses", hicann.hbuses());
+	f("vbuses", hicann.vbuses());
+	f("merger0", hicann.mergers0());
+	f("merger1", hicann.mergers1());
+	f("merger2", hicann.mergers2());
+	f("merger3", hicann.mergers3());
+	f("dnc_merger", hicann.dncmergers());
+	f("synapserows", hicann.synapserows());
+	f("analogs", hicann.analogs());
+	f("backgroundgenerators", hicann.backgroundgenerators());
+	f("fgblocks", hicann.fgblocks());
+	f("vrepeaters", hicann.vrepeaters());
+	f("hrepeaters", hicann.hrepeaters());
+	f("synapseswitches", hicann.synapseswitches());
+	f("crossbarswitches", hicann.crossbarswitches());
+	f("synapseswitchrows", hicann.synapseswitchrows());
+	f("synapsearrays", hicann.synapsearrays());
+}
+
+template<typename FpgaT, typename Function>
+typename detail::EnableIfResource<FpgaT, resources::Fpga>::type
+for_each_component(FpgaT& fpga, Function& f)
+{
+	f("hslinks", fpga.hslinks());
+}
+
+template<typename WaferT, typename Function>
+typename detail::EnableIfResource<WaferT, resources::Wafer>::type
+for_each_component(WaferT& wafer, Function& f)
+{
+	f("hicanns", wafer.hicanns());
+	f("fpgas", wafer.fpgas());
+}
+
+} // flat
+} // redman
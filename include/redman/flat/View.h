@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "redman/Predicate.h"
+#include "redman/ResourceManager.h"
+#include "redman/flat/Format.h"
+
+namespace redman {
+namespace flat {
+
+/** Read-only view of the enabled resources of one component of a mapped
+ *  flat file, see `MappedResource::component()`.
+ *  Queries read the mapped bytes directly, nothing is deserialized.  The
+ *  view keeps the mapping alive and can be copied and read concurrently.
+ */
+template<typename Resource>
+class View
+{
+	typedef redman::detail::ResourceIndex<Resource> index_type;
+
+public:
+	typedef Resource resource;
+
+	class const_iterator :
+		public boost::iterator_facade<
+			const_iterator,
+			Resource const,
+			boost::forward_traversal_tag,
+			// Return copy instead of reference:
+			Resource>
+	{
+	public:
+		const_iterator() : mView(nullptr), mIndex(0) {}
+
+	private:
+		friend class View;
+		friend class boost::iterator_core_access;
+
+		const_iterator(View const* view, std::size_t index) : mView(view), mIndex(index) {}
+
+		bool equal(const_iterator const& other) const
+		{
+			return mIndex == other.mIndex;
+		}
+
+		void increment()
+		{
+			mIndex = mView->next(mIndex + 1);
+		}
+
+		Resource dereference() const
+		{
+			return index_type::make(mIndex);
+		}
+
+		View const* mView;
+		std::size_t mIndex;
+	};
+
+	typedef const_iterator iterator;
+
+	View(boost::shared_ptr<void const> owner, SectionEntry const& section, char const* payload) :
+		mOwner(owner), mSection(&section),
+		mWords(reinterpret_cast<std::uint64_t const*>(payload)),
+		mRuns(reinterpret_cast<std::uint32_t const*>(payload))
+	{
+		if (section.index_size != index_type::index_type::end)
+			throw std::runtime_error(
+				std::string("index range of flat section does not match component: ") +
+				section.name);
+	}
+
+	bool has(Resource const& val) const
+	{
+		std::size_t const idx = index_type::get(val);
+		if (mSection->encoding == Encoding::BITMAP)
+			return (mWords[idx / 64] >> (idx % 64)) & 1;
+		std::size_t const run = run_after(idx);
+		return run < mSection->length && mRuns[2 * run] <= idx;
+	}
+
+	/// Number of enabled resources.
+	std::size_t available() const
+	{
+		return mSection->count;
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, next(0));
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, mSection->index_size);
+	}
+
+	/// Whether the written component was modified, see `ResourceManager::has_value()`.
+	bool has_value() const
+	{
+		return mSection->flags & SectionEntry::HAS_VALUE;
+	}
+
+	/** Make `manager` manage exactly the resources enabled in this view.
+	 *  Throws if one of them is invalid according to the manager's predicate.
+	 */
+	template<typename Manager>
+	void copy_to(Manager& manager) const
+	{
+		if (!has_value()) {
+			manager.reset();
+			return;
+		}
+		manager.disable_all();
+		manager.enable_many(begin(), end());
+	}
+
+private:
+	/// Smallest enabled index not smaller than `idx`, `index_size` if none.
+	std::size_t next(std::size_t idx) const
+	{
+		std::size_t const size = mSection->index_size;
+		if (idx >= size)
+			return size;
+
+		if (mSection->encoding == Encoding::BITMAP) {
+			std::size_t word = idx / 64;
+			std::uint64_t bits = mWords[word] & (~std::uint64_t(0) << (idx % 64));
+			std::size_t const words = (size + 63) / 64;
+			while (!bits) {
+				if (++word == words)
+					return size;
+				bits = mWords[word];
+			}
+			return std::min(size, word * 64 + __builtin_ctzll(bits));
+		}
+
+		std::size_t const run = run_after(idx);
+		if (run == mSection->length)
+			return size;
+		return std::max<std::size_t>(idx, mRuns[2 * run]);
+	}
+
+	/// First run ending after `idx`, i.e. the one containing it or the next one.
+	std::size_t run_after(std::size_t idx) const
+	{
+		std::size_t lo = 0, hi = mSection->length;
+		while (lo < hi) {
+			std::size_t const mid = (lo + hi) / 2;
+			if (mRuns[2 * mid + 1] <= idx)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	boost::shared_ptr<void const> mOwner;
+	SectionEntry const* mSection;
+	std::uint64_t const* mWords;
+	std::uint32_t const* mRuns;
+};
+
+} // flat
+} // redman
@@ -48,6 +48,23 @@ public:
 	 */
 	void intersection(Fpga const& other);
 
+	/** Perform merge for all components
+	 */
+	void merge(Fpga const& other);
+
+	/** Return an independent copy of this FPGA.
+	 *  In contrast to `copy()` the components are not shared.  Component
+	 *  selections are copied lazily on their first modification.
+	 */
+	boost::shared_ptr<Fpga> clone() const;
+
+#ifndef PYPLUSPLUS
+	/** Return an immutable snapshot of this FPGA, safe to read concurrently
+	 *  while this FPGA is modified.  \see redman::Published
+	 */
+	boost::shared_ptr<Fpga const> freeze() const;
+#endif // PYPLUSPLUS
+
 	void copy(Base const&) PYPP_OVERRIDE;
 
 	// factory function for Py++
@@ -88,10 +105,27 @@ public:
 	static boost::shared_ptr<FpgaWithBackend> create(
 	    boost::shared_ptr<backend::Backend> backend, id_type id, bool ignore_missing = true);
 
+#ifndef PYPLUSPLUS
+	/** Asynchronous counterpart of `save()` via `Backend::store_async()`.
+	 *  This FPGA must neither be modified nor destroyed until the returned
+	 *  future is ready.
+	 */
+	std::future<void> save_async() const;
+
+	/** Asynchronous counterpart of `create()`, loads on the I/O pool.
+	 */
+	static std::future<boost::shared_ptr<FpgaWithBackend> > create_async(
+	    boost::shared_ptr<backend::Backend> backend, id_type id, bool ignore_missing = true);
+#endif // PYPLUSPLUS
+
 	/** id used for the seralization backend, e.g. the basename of the file for xml
 	 */
 	std::string id_for_backend() const;
 
+	/** id used for the seralization backend for the given FPGA
+	 */
+	static std::string backend_id(id_type const& id);
+
 private:
 	void load(bool ignore_missing);
 
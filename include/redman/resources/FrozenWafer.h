@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "redman/resources/Fpga.h"
+#include "redman/resources/Hicann.h"
+#include "redman/resources/components.h"
+
+namespace redman {
+namespace resources {
+
+/** Immutable snapshot of a wafer, see `Wafer::freeze()`.
+ *  Provides the read-only interface of `Wafer`.  HICANN and FPGA resources
+ *  are stored in arrays indexed by their enum, neither components nor
+ *  resources are shared with the wafer, so a snapshot can be read from any
+ *  number of threads without locking while the wafer is modified.
+ */
+class FrozenWafer
+{
+public:
+	typedef halco::hicann::v2::Wafer id_type;
+
+	id_type id() const;
+
+	/** Check whether the given HICANN is enabled on this wafer.
+	 */
+	bool has(halco::hicann::v2::HICANNOnWafer const&) const;
+
+	/** Check whether the given FPGA is enabled on this wafer.
+	 */
+	bool has(halco::hicann::v2::FPGAOnWafer const&) const;
+
+	boost::shared_ptr<components::Hicanns const> hicanns() const;
+	boost::shared_ptr<components::Fpgas const> fpgas() const;
+
+	/** Get the HICANN resource.
+	 *  Returns what `Wafer::get()` returned from the cache when freezing,
+	 *  i.e. `nullptr` for HICANNs that were not cached and for disabled ones
+	 *  unless missing HICANNs were ignored.
+	 */
+	boost::shared_ptr<Hicann const> get(halco::hicann::v2::HICANNOnWafer const&) const;
+
+	/** Get the FPGA resource, see above.
+	 */
+	boost::shared_ptr<Fpga const> get(halco::hicann::v2::FPGAOnWafer const&) const;
+
+private:
+	friend class Wafer;
+
+	typedef std::vector<boost::shared_ptr<Hicann const> > hicann_resources;
+	typedef std::vector<boost::shared_ptr<Fpga const> > fpga_resources;
+
+	FrozenWafer(
+	    id_type const& id,
+	    boost::shared_ptr<components::Hicanns const> hicanns,
+	    boost::shared_ptr<components::Fpgas const> fpgas,
+	    hicann_resources&& hicann_resources,
+	    fpga_resources&& fpga_resources);
+
+	id_type const mId;
+	boost::shared_ptr<components::Hicanns const> const mHicanns;
+	boost::shared_ptr<components::Fpgas const> const mFpgas;
+	hicann_resources const mHicannResources;
+	fpga_resources const mFpgaResources;
+};
+
+} // resources
+} // redman
@@ -48,6 +48,26 @@ public:
 	 */
 	void intersection(Hicann const& other);
 
+	/** Perform merge for all components
+	 */
+	void merge(Hicann const& other);
+
+	/** Return an independent copy of this HICANN.
+	 *  In contrast to `copy()` the components are not shared, modifying the
+	 *  clone leaves this HICANN unchanged.  Component selections are copied
+	 *  lazily on their first modification, so cloning itself is cheap.
+	 */
+	boost::shared_ptr<Hicann> clone() const;
+
+#ifndef PYPLUSPLUS
+	/** Return an immutable snapshot of this HICANN.
+	 *  No component selection is shared with any other object, so the
+	 *  snapshot can be read concurrently from any number of threads while
+	 *  this HICANN is modified.  \see redman::Published
+	 */
+	boost::shared_ptr<Hicann const> freeze() const;
+#endif // PYPLUSPLUS
+
 #ifndef PYPLUSPLUS
 	boost::shared_ptr<components::Neurons const>        neurons()  const { return mNeurons; }
 	boost::shared_ptr<components::Synapses const>       synapses() const { return mSynapses; }
@@ -106,6 +126,12 @@ private:
 	boost::shared_ptr<components::Mergers3> mMergers3;
 	boost::shared_ptr<components::DNCMergers> mDNCMergers;
 
+#ifndef PYPLUSPLUS
+	/// Copy of this HICANN with every component replaced by `f(component)`.
+	template<typename Function>
+	boost::shared_ptr<Hicann> transform_components(Function const& f) const;
+#endif // PYPLUSPLUS
+
 	friend class boost::serialization::access;
 	template<typename Archiver>
 	void serialize(Archiver& ar, unsigned int const);
@@ -135,7 +161,25 @@ public:
 		halco::hicann::v2::HICANNGlobal id,
 		bool ignore_missing = true);
 
+#ifndef PYPLUSPLUS
+	/** Asynchronous counterpart of `save()` via `Backend::store_async()`.
+	 *  This HICANN must neither be modified nor destroyed until the returned
+	 *  future is ready.
+	 */
+	std::future<void> save_async();
+
+	/** Asynchronous counterpart of `create()`, loads on the I/O pool.
+	 */
+	static std::future<boost::shared_ptr<HicannWithBackend> > create_async(
+		boost::shared_ptr<backend::Backend> backend,
+		halco::hicann::v2::HICANNGlobal id,
+		bool ignore_missing = true);
+#endif // PYPLUSPLUS
+
 	std::string id_for_backend() const;
+
+	/// Id used by the backend for the HICANN with the given coordinate.
+	static std::string backend_id(halco::hicann::v2::HICANNGlobal const& id);
 private:
 	void load(bool ignore_missing);
 
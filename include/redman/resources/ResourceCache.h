@@ -0,0 +1,171 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "redman/Predicate.h"
+
+namespace redman {
+namespace resources {
+namespace detail {
+
+/** Thread-safe cache of resources indexed by coordinate.
+ *  Holds one slot per index of the coordinate's enum, e.g. 384 for
+ *  `HICANNOnWafer`.  Slots are read and written with the atomic
+ *  `boost::shared_ptr` operations, so hits never block on other threads.
+ *  Concurrent misses on the same slot are single-flighted: exactly one
+ *  caller of `get()` runs the loader, the others wait for its result.
+ *  Batch loads take part in this via `claim()` and `publish()`.
+ *  \note Copies share the cached resources, but not pending loads.
+ */
+template<typename Coordinate, typename Resource>
+class ResourceCache
+{
+	typedef redman::detail::ResourceIndex<Coordinate> index_type;
+
+public:
+	typedef boost::shared_ptr<Resource> pointer_type;
+
+	/// Number of slots.
+	static size_t const size = index_type::index_type::end;
+
+	ResourceCache() : mSlots(size), mMutex(), mLoaded(), mLoading(size, false) {}
+
+	ResourceCache(ResourceCache const& other) :
+		mSlots(other.slots()), mMutex(), mLoaded(), mLoading(size, false)
+	{}
+
+	ResourceCache& operator=(ResourceCache const& other)
+	{
+		if (this != &other) {
+			auto const slots = other.slots();
+			for (size_t ii = 0; ii < size; ++ii)
+				boost::atomic_store(&mSlots[ii], slots[ii]);
+		}
+		return *this;
+	}
+
+	/// Return the cached resource, `nullptr` if there is none.
+	pointer_type find(Coordinate const& c) const
+	{
+		return boost::atomic_load(&mSlots[index(c)]);
+	}
+
+	/** Return the cached resource, calling `load()` to create it on a miss.
+	 *  If `load()` throws, nothing is cached and waiting callers retry.
+	 *  A resource inserted while loading takes precedence over the loaded one.
+	 */
+	template<typename Load>
+	pointer_type get(Coordinate const& c, Load const& load)
+	{
+		size_t const idx = index(c);
+		pointer_type res = boost::atomic_load(&mSlots[idx]);
+		if (res)
+			return res;
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		for (;;) {
+			res = boost::atomic_load(&mSlots[idx]);
+			if (res)
+				return res;
+			if (!mLoading[idx])
+				break;
+			mLoaded.wait(lock);
+		}
+		mLoading[idx] = true;
+		lock.unlock();
+
+		try {
+			res = load();
+		} catch (...) {
+			finish(idx, pointer_type());
+			throw;
+		}
+		return finish(idx, res);
+	}
+
+	/** Claim the slot for loading it outside of `get()`, e.g. in a batch.
+	 *  Returns `false` if the resource is cached or being loaded already.
+	 *  Otherwise concurrent callers of `get()` wait until the claimed slot
+	 *  is passed to `publish()`, which has to happen exactly once.
+	 */
+	bool claim(Coordinate const& c)
+	{
+		size_t const idx = index(c);
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mLoading[idx] || boost::atomic_load(&mSlots[idx]))
+			return false;
+		mLoading[idx] = true;
+		return true;
+	}
+
+	/** Publish the result of loading a claimed slot and return the cached
+	 *  resource.  Publishing `nullptr` releases the slot without caching
+	 *  anything, waiting callers of `get()` then retry.
+	 */
+	pointer_type publish(Coordinate const& c, pointer_type res)
+	{
+		return finish(index(c), res);
+	}
+
+	/// Replace the cached resource.
+	void insert(Coordinate const& c, pointer_type res)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		boost::atomic_store(&mSlots[index(c)], res);
+	}
+
+	/// Call `f(coordinate, resource)` for every cached resource.
+	template<typename Function>
+	void for_each(Function f) const
+	{
+		for (size_t ii = 0; ii < size; ++ii) {
+			if (auto const res = boost::atomic_load(&mSlots[ii]))
+				f(index_type::make(ii), res);
+		}
+	}
+
+private:
+	static size_t index(Coordinate const& c)
+	{
+		return index_type::get(c);
+	}
+
+	std::vector<pointer_type> slots() const
+	{
+		std::vector<pointer_type> res(size);
+		for (size_t ii = 0; ii < size; ++ii)
+			res[ii] = boost::atomic_load(&mSlots[ii]);
+		return res;
+	}
+
+	/// Publish the result of a load and wake up waiting callers.
+	pointer_type finish(size_t idx, pointer_type res)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mLoading[idx] = false;
+		if (auto const current = boost::atomic_load(&mSlots[idx]))
+			res = current;
+		else if (res)
+			boost::atomic_store(&mSlots[idx], res);
+		mLoaded.notify_all();
+		return res;
+	}
+
+	std::vector<pointer_type> mSlots;
+	std::mutex mMutex;
+	std::condition_variable mLoaded;
+	/// Whether a load is in flight, per slot, guarded by `mMutex`.
+	std::vector<bool> mLoading;
+};
+
+template<typename Coordinate, typename Resource>
+size_t const ResourceCache<Coordinate, Resource>::size;
+
+} // detail
+} // resources
+} // redman
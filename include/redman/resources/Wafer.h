@@ -1,7 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #ifndef PYPLUSPLUS
-#include <unordered_map>
+#include "redman/resources/ResourceCache.h"
 #endif // PYPLUSPLUS
 
 #include <boost/serialization/serialization.hpp>
@@ -21,9 +23,12 @@
 namespace redman {
 namespace resources {
 
+class FrozenWafer;
+
 class Wafer : public Base {
 public:
 	typedef halco::hicann::v2::Wafer id_type;
+	typedef FrozenWafer frozen_type;
 	Wafer(id_type const& id = id_type());
 	virtual ~Wafer();
 
@@ -61,6 +66,8 @@ public:
 	/** Get the HICANN resource
 	 * Priority: 1. runtime cache, 2. via backend, 3. new if ignore_hicann_missing
 	 * 2 and 3 are then also inserted into the runtime cache
+	 * Safe to call concurrently, if several threads miss the same HICANN it
+	 * is loaded only once and all of them receive the same resource.
 	 */
 	boost::shared_ptr<resources::Hicann> get(halco::hicann::v2::HICANNOnWafer const&) const;
 
@@ -70,6 +77,33 @@ public:
 	 */
 	boost::shared_ptr<resources::Fpga> get(halco::hicann::v2::FPGAOnWafer const&) const;
 
+#ifndef PYPLUSPLUS
+	/** Asynchronous counterparts of `get()`, loading on the I/O pool.
+	 *  Cached resources are returned as ready futures.  This wafer has to
+	 *  outlive the returned futures.
+	 */
+	std::future<boost::shared_ptr<resources::Hicann> > get_async(
+	    halco::hicann::v2::HICANNOnWafer const&) const;
+	std::future<boost::shared_ptr<resources::Fpga> > get_async(
+	    halco::hicann::v2::FPGAOnWafer const&) const;
+#endif // PYPLUSPLUS
+
+	/** Load the given HICANN and FPGA resources in parallel.
+	 *  Splits the resources that are not cached yet into one batch per
+	 *  worker thread (one per hardware thread if `threads` is zero), each
+	 *  loaded with a single `Backend::load_many()` call, and returns once
+	 *  all of them are cached.  The first exception thrown by a batch is
+	 *  rethrown after all batches finished.
+	 */
+	void prefetch(
+	    std::vector<halco::hicann::v2::HICANNOnWafer> const& hicanns,
+	    std::vector<halco::hicann::v2::FPGAOnWafer> const& fpgas,
+	    size_t threads = 0) const;
+
+	/** Load all enabled HICANN and FPGA resources in parallel, see above.
+	 */
+	void prefetch(size_t threads = 0) const;
+
 	boost::shared_ptr<components::Hicanns>       hicanns();
 	boost::shared_ptr<components::Fpgas>         fpgas();
 
@@ -90,10 +124,45 @@ public:
 	 */
 	void save();
 
+	/** Store all cached Hicann and Fpga resources with a single
+	 * `Backend::store_many()` call, backend must be set.
+	 */
+	void save_resources() const;
+
+#ifndef PYPLUSPLUS
+	/** Asynchronous counterpart of `save()` via `Backend::store_async()`.
+	 *  The components must neither be modified nor destroyed until the
+	 *  returned future is ready.
+	 */
+	std::future<void> save_async();
+#endif // PYPLUSPLUS
+
 	/** Perform intersection for all components
 	 */
 	void intersection(Wafer const& other);
 
+	/** Perform merge for all components
+	 */
+	void merge(Wafer const& other);
+
+	/** Return an independent copy of this wafer.
+	 *  Components and all cached HICANN and FPGA resources are cloned, the
+	 *  backend is shared.  Component selections are copied lazily on their
+	 *  first modification, so cloning a fully cached wafer is cheap.
+	 */
+	boost::shared_ptr<Wafer> clone() const;
+
+#ifndef PYPLUSPLUS
+	/** Return an immutable snapshot of this wafer.
+	 *  The components and the cached HICANN and FPGA resources that `get()`
+	 *  would return are frozen, nothing is loaded from the backend.  Call
+	 *  `prefetch()` first to include resources not cached yet.  The snapshot
+	 *  can be read from any number of threads while this wafer is modified,
+	 *  publish it with `redman::Published`.
+	 */
+	boost::shared_ptr<FrozenWafer const> freeze() const;
+#endif // PYPLUSPLUS
+
 #ifndef PYPLUSPLUS
 	boost::shared_ptr<components::Hicanns const> hicanns() const;
 	boost::shared_ptr<components::Fpgas const> fpgas() const;
@@ -110,12 +179,22 @@ public:
 	/// not touch resource caches
 	void load();
 
+#ifndef PYPLUSPLUS
+	/// Asynchronous counterpart of `load()`, runs it on the I/O pool.
+	std::future<void> load_async();
+#endif // PYPLUSPLUS
+
 protected:
 	void set_id(id_type const& id);
 
 private:
 	void set_backend_behavior(backend_behavior const& behavior);
 
+	/// Load the given resources that are not cached yet via `Backend::load_many()`.
+	void load_batch(
+	    std::vector<halco::hicann::v2::HICANNOnWafer> const& hicanns,
+	    std::vector<halco::hicann::v2::FPGAOnWafer> const& fpgas) const;
+
 	id_type mId;
 	boost::shared_ptr<backend::Backend> mBackend;
 
@@ -126,8 +205,8 @@ private:
 	get_behavior mGetBehavior;
 
 #ifndef PYPLUSPLUS
-	mutable std::unordered_map<halco::hicann::v2::HICANNOnWafer, boost::shared_ptr<Hicann> > mHicannResourceCache;
-	mutable std::unordered_map<halco::hicann::v2::FPGAOnWafer, boost::shared_ptr<Fpga> > mFpgaResourceCache;
+	mutable detail::ResourceCache<halco::hicann::v2::HICANNOnWafer, Hicann> mHicannResourceCache;
+	mutable detail::ResourceCache<halco::hicann::v2::FPGAOnWafer, Fpga> mFpgaResourceCache;
 #endif // PYPLUSPLUS
 
 	friend class boost::serialization::access;
@@ -24,11 +24,36 @@ namespace components {
 
 namespace detail {
 
+/** Return an independent copy of the component, `nullptr` stays `nullptr`.
+ *  The copy shares the selection until either one is modified.
+ */
+template <typename Component>
+boost::shared_ptr<Component> clone(boost::shared_ptr<Component> const& component) {
+	if (!component)
+		return component;
+	return boost::make_shared<Component>(*component);
+}
+
+#ifndef PYPLUSPLUS
+/** Return a copy of the component that does not share its selection,
+ *  `nullptr` stays `nullptr`.
+ */
+template <typename Component>
+boost::shared_ptr<Component> freeze(boost::shared_ptr<Component> const& component) {
+	if (!component)
+		return component;
+	auto res = boost::make_shared<Component>(*component);
+	res->detach();
+	return res;
+}
+#endif // PYPLUSPLUS
+
 template <typename Derived, typename Resource, typename Policy,
           typename Predicate = DefaultPredicate<Resource>,
-          typename Compare = std::less<Resource> >
+          typename Compare = std::less<Resource>,
+          typename Storage = storage::Set>
 class ResourceWithFactory
-    : public ResourceManager<Resource, Policy, Predicate, Compare> {
+    : public ResourceManager<Resource, Policy, Predicate, Compare, Storage> {
 	// factory function for Py++
 	static boost::shared_ptr<Derived> create() {
 		return boost::make_shared<Derived>();
@@ -43,40 +68,45 @@ class ResourceWithFactory
 
 } // redman
 
-#define ADD_RESOURCE(name, res, version)									  \
+/* The storage only affects memory usage and performance, datasets written
+   with one storage can be read with any other.  Large index spaces whose
+   defects come in rows or columns use compressed storage, all other
+   components switch between sorted vector and bitset by density. */
+#define ADD_RESOURCE(name, res, version, storage)							  \
 	namespace redman { namespace resources { namespace components {		      \
-	class name : public detail::ResourceWithFactory<name, res, Blacklist> {}; \
+	class name : public detail::ResourceWithFactory<                          \
+		name, res, Blacklist, DefaultPredicate<res>, std::less<res>, storage> {}; \
 	} } }																      \
 	BOOST_CLASS_VERSION(redman::resources::components::name, version)
 
-ADD_RESOURCE(Hicanns, halco::hicann::v2::HICANNOnWafer, 1)
-
-ADD_RESOURCE(Neurons, halco::hicann::v2::NeuronOnHICANN, 1)
-
-ADD_RESOURCE(Synapses, halco::hicann::v2::SynapseOnHICANN, 1)
-ADD_RESOURCE(SynapseDrivers, halco::hicann::v2::SynapseDriverOnHICANN, 1)
-ADD_RESOURCE(SynapticInputs, halco::hicann::v2::SynapticInputOnHICANN, 1)
-ADD_RESOURCE(SynapseRows, halco::hicann::v2::SynapseRowOnHICANN, 1)
-ADD_RESOURCE(Analogs, halco::hicann::v2::AnalogOnHICANN, 1)
-ADD_RESOURCE(BackgroundGenerators, halco::hicann::v2::BackgroundGeneratorOnHICANN, 1)
-ADD_RESOURCE(FGBlocks, halco::hicann::v2::FGBlockOnHICANN, 1)
-ADD_RESOURCE(VRepeaters, halco::hicann::v2::VRepeaterOnHICANN, 1)
-ADD_RESOURCE(HRepeaters, halco::hicann::v2::HRepeaterOnHICANN, 1)
-ADD_RESOURCE(SynapseSwitches, halco::hicann::v2::SynapseSwitchOnHICANN, 1)
-ADD_RESOURCE(CrossbarSwitches, halco::hicann::v2::CrossbarSwitchOnHICANN, 1)
-ADD_RESOURCE(SynapseSwitchRows, halco::hicann::v2::SynapseSwitchRowOnHICANN, 1)
-ADD_RESOURCE(SynapseArrays, halco::hicann::v2::SynapseArrayOnHICANN, 1)
-
-ADD_RESOURCE(HorizontalBuses, halco::hicann::v2::HLineOnHICANN, 1)
-ADD_RESOURCE(VerticalBuses, halco::hicann::v2::VLineOnHICANN, 1)
-
-ADD_RESOURCE(Mergers0, halco::hicann::v2::Merger0OnHICANN, 1)
-ADD_RESOURCE(Mergers1, halco::hicann::v2::Merger1OnHICANN, 1)
-ADD_RESOURCE(Mergers2, halco::hicann::v2::Merger2OnHICANN, 1)
-ADD_RESOURCE(Mergers3, halco::hicann::v2::Merger3OnHICANN, 1)
-ADD_RESOURCE(DNCMergers, halco::hicann::v2::DNCMergerOnHICANN, 1)
-
-ADD_RESOURCE(HighspeedLinksOnDNC, halco::hicann::v2::HighspeedLinkOnDNC, 1)
-ADD_RESOURCE(Fpgas, halco::hicann::v2::FPGAOnWafer, 1)
+ADD_RESOURCE(Hicanns, halco::hicann::v2::HICANNOnWafer, 1, storage::Adaptive)
+
+ADD_RESOURCE(Neurons, halco::hicann::v2::NeuronOnHICANN, 1, storage::Adaptive)
+
+ADD_RESOURCE(Synapses, halco::hicann::v2::SynapseOnHICANN, 1, storage::Compressed)
+ADD_RESOURCE(SynapseDrivers, halco::hicann::v2::SynapseDriverOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(SynapticInputs, halco::hicann::v2::SynapticInputOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(SynapseRows, halco::hicann::v2::SynapseRowOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(Analogs, halco::hicann::v2::AnalogOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(BackgroundGenerators, halco::hicann::v2::BackgroundGeneratorOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(FGBlocks, halco::hicann::v2::FGBlockOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(VRepeaters, halco::hicann::v2::VRepeaterOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(HRepeaters, halco::hicann::v2::HRepeaterOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(SynapseSwitches, halco::hicann::v2::SynapseSwitchOnHICANN, 1, storage::Compressed)
+ADD_RESOURCE(CrossbarSwitches, halco::hicann::v2::CrossbarSwitchOnHICANN, 1, storage::Compressed)
+ADD_RESOURCE(SynapseSwitchRows, halco::hicann::v2::SynapseSwitchRowOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(SynapseArrays, halco::hicann::v2::SynapseArrayOnHICANN, 1, storage::Adaptive)
+
+ADD_RESOURCE(HorizontalBuses, halco::hicann::v2::HLineOnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(VerticalBuses, halco::hicann::v2::VLineOnHICANN, 1, storage::Adaptive)
+
+ADD_RESOURCE(Mergers0, halco::hicann::v2::Merger0OnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(Mergers1, halco::hicann::v2::Merger1OnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(Mergers2, halco::hicann::v2::Merger2OnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(Mergers3, halco::hicann::v2::Merger3OnHICANN, 1, storage::Adaptive)
+ADD_RESOURCE(DNCMergers, halco::hicann::v2::DNCMergerOnHICANN, 1, storage::Adaptive)
+
+ADD_RESOURCE(HighspeedLinksOnDNC, halco::hicann::v2::HighspeedLinkOnDNC, 1, storage::Adaptive)
+ADD_RESOURCE(Fpgas, halco::hicann::v2::FPGAOnWafer, 1, storage::Adaptive)
 
 #undef ADD_RESOURCE
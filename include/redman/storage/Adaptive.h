@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/optional.hpp>
+
+#include "redman/Storage.h"
+#include "redman/storage/Bitset.h"
+#include "redman/storage/Flat.h"
+
+namespace redman {
+namespace storage {
+
+/** Selection container switching between a sorted vector and a bitset.
+ *  The selection is kept in a `FlatSelection` as long as that needs less
+ *  memory than a `BitsetSelection` of the full index range and converted
+ *  to the latter once it grows beyond.  It is converted back after it
+ *  shrank to half of that limit, so that alternating insertions and
+ *  erasures close to the limit do not convert every time.
+ *  \note Like `BitsetSelection` this requires that `Compare` orders
+ *        resources by their index.
+ */
+template<typename Resource, typename Predicate, typename Compare>
+class AdaptiveSelection
+{
+	typedef FlatSelection<Resource, Predicate, Compare> sparse_type;
+	typedef BitsetSelection<Resource, Predicate, Compare> dense_type;
+
+public:
+	typedef Resource key_type;
+	typedef Resource value_type;
+	typedef Resource const& const_reference;
+	typedef Compare key_compare;
+	typedef std::size_t size_type;
+
+	/// Number of resources for which both representations need the same memory.
+	static size_type const dense_limit =
+		dense_type::words * sizeof(typename dense_type::word_type) / sizeof(Resource);
+
+	class const_iterator :
+		public boost::iterator_facade<
+			const_iterator,
+			Resource const,
+			boost::forward_traversal_tag,
+			// Return copy instead of reference:
+			Resource>
+	{
+	public:
+		const_iterator() : mIsDense(false), mSparse(), mDense() {}
+
+	private:
+		friend class AdaptiveSelection;
+		friend class boost::iterator_core_access;
+
+		const_iterator(typename sparse_type::const_iterator it) :
+			mIsDense(false), mSparse(it), mDense() {}
+
+		const_iterator(typename dense_type::const_iterator it) :
+			mIsDense(true), mSparse(), mDense(it) {}
+
+		bool equal(const_iterator const& other) const
+		{
+			return mIsDense ? mDense == other.mDense : mSparse == other.mSparse;
+		}
+
+		void increment()
+		{
+			if (mIsDense)
+				++mDense;
+			else
+				++mSparse;
+		}
+
+		Resource dereference() const
+		{
+			return mIsDense ? *mDense : *mSparse;
+		}
+
+		bool mIsDense;
+		typename sparse_type::const_iterator mSparse;
+		typename dense_type::const_iterator mDense;
+	};
+
+	typedef const_iterator iterator;
+
+	AdaptiveSelection() : mSparse(), mDense() {}
+
+	AdaptiveSelection(AdaptiveSelection const& other) :
+		mSparse(other.mSparse),
+		mDense(other.mDense ? new dense_type(*other.mDense) : nullptr)
+	{}
+
+	AdaptiveSelection(AdaptiveSelection&&) = default;
+
+	AdaptiveSelection& operator=(AdaptiveSelection const& other)
+	{
+		if (this != &other) {
+			mSparse = other.mSparse;
+			mDense.reset(other.mDense ? new dense_type(*other.mDense) : nullptr);
+		}
+		return *this;
+	}
+
+	AdaptiveSelection& operator=(AdaptiveSelection&&) = default;
+
+	/// Whether the selection is currently stored as bitset.
+	bool dense() const
+	{
+		return static_cast<bool>(mDense);
+	}
+
+	const_iterator begin() const
+	{
+		return dense() ? const_iterator(mDense->begin()) : const_iterator(mSparse.begin());
+	}
+
+	const_iterator end() const
+	{
+		return dense() ? const_iterator(mDense->end()) : const_iterator(mSparse.end());
+	}
+
+	size_type size() const
+	{
+		return dense() ? mDense->size() : mSparse.size();
+	}
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	size_type count(Resource const& val) const
+	{
+		return dense() ? mDense->count(val) : mSparse.count(val);
+	}
+
+	const_iterator lower_bound(Resource const& val) const
+	{
+		return dense() ? const_iterator(mDense->lower_bound(val))
+		               : const_iterator(mSparse.lower_bound(val));
+	}
+
+	const_iterator upper_bound(Resource const& val) const
+	{
+		return dense() ? const_iterator(mDense->upper_bound(val))
+		               : const_iterator(mSparse.upper_bound(val));
+	}
+
+	/// Number of stored resources preceding `val`.
+	size_type rank(Resource const& val) const
+	{
+		return dense() ? mDense->rank(val) : mSparse.rank(val);
+	}
+
+	/// Return the `k`-th stored resource, `k` must be less than `size()`.
+	Resource select(size_type k) const
+	{
+		return dense() ? mDense->select(k) : mSparse.select(k);
+	}
+
+	/// Return the last stored resource before `val`, if any.
+	boost::optional<Resource> prev(Resource const& val) const
+	{
+		return dense() ? mDense->prev(val) : mSparse.prev(val);
+	}
+
+	std::pair<const_iterator, bool> insert(Resource const& val)
+	{
+		bool const inserted = dense() ? mDense->insert(val).second : mSparse.insert(val).second;
+		if (inserted)
+			rebalance();
+		return std::make_pair(lower_bound(val), inserted);
+	}
+
+	/// Hinted insertion as for `std::set`.
+	const_iterator insert(const_iterator hint, Resource const& val)
+	{
+		if (dense() || hint.mIsDense)
+			return insert(val).first;
+		mSparse.insert(hint.mSparse, val);
+		rebalance();
+		return lower_bound(val);
+	}
+
+	size_type erase(Resource const& val)
+	{
+		size_type const erased = dense() ? mDense->erase(val) : mSparse.erase(val);
+		if (erased)
+			rebalance();
+		return erased;
+	}
+
+	void clear()
+	{
+		mSparse.clear();
+		mDense.reset();
+	}
+
+	template<typename InputIterator>
+	void assign(InputIterator first, InputIterator last)
+	{
+		clear();
+		mSparse.assign(first, last);
+		rebalance();
+	}
+
+	/// Insert a sorted range of distinct resources, return the number inserted.
+	template<typename InputIterator>
+	size_type insert_many(InputIterator first, InputIterator last)
+	{
+		size_type const inserted = dense() ? mDense->insert_many(first, last)
+		                                   : mSparse.insert_many(first, last);
+		if (inserted)
+			rebalance();
+		return inserted;
+	}
+
+	/// Erase a sorted range of distinct resources, return the number erased.
+	template<typename InputIterator>
+	size_type erase_many(InputIterator first, InputIterator last)
+	{
+		size_type const erased = dense() ? mDense->erase_many(first, last)
+		                                 : mSparse.erase_many(first, last);
+		if (erased)
+			rebalance();
+		return erased;
+	}
+
+	/* In-place set algebra.  If both selections are sparse they are merged
+	   as sorted ranges, otherwise as bitsets.  The `_complement` variants
+	   combine with all indices of the index range that are not stored in
+	   `other`. */
+
+	void merge(AdaptiveSelection const& other)
+	{
+		apply(other, &sparse_type::merge, &dense_type::merge);
+	}
+
+	void intersection(AdaptiveSelection const& other)
+	{
+		apply(other, &sparse_type::intersection, &dense_type::intersection);
+	}
+
+	void difference(AdaptiveSelection const& other)
+	{
+		apply(other, &sparse_type::difference, &dense_type::difference);
+	}
+
+	void symmetric_difference(AdaptiveSelection const& other)
+	{
+		apply(other, &sparse_type::symmetric_difference, &dense_type::symmetric_difference);
+	}
+
+	void merge_complement(AdaptiveSelection const& other)
+	{
+		apply(other, nullptr, &dense_type::merge_complement);
+	}
+
+	void symmetric_difference_complement(AdaptiveSelection const& other)
+	{
+		apply(other, nullptr, &dense_type::symmetric_difference_complement);
+	}
+
+	/// Store every index of the index range.
+	void fill()
+	{
+		make_dense();
+		mDense->fill();
+	}
+
+	bool operator==(AdaptiveSelection const& rhs) const
+	{
+		if (dense() && rhs.dense())
+			return *mDense == *rhs.mDense;
+		if (!dense() && !rhs.dense())
+			return mSparse == rhs.mSparse;
+		return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+	}
+
+	bool operator!=(AdaptiveSelection const& rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+private:
+	typedef void (sparse_type::*sparse_operation)(sparse_type const&);
+	typedef void (dense_type::*dense_operation)(dense_type const&);
+
+	void apply(AdaptiveSelection const& other, sparse_operation sparse_op, dense_operation dense_op)
+	{
+		if (sparse_op && !dense() && !other.dense()) {
+			(mSparse.*sparse_op)(other.mSparse);
+		} else {
+			make_dense();
+			if (other.dense()) {
+				((*mDense).*dense_op)(*other.mDense);
+			} else {
+				dense_type tmp;
+				tmp.assign(other.mSparse.begin(), other.mSparse.end());
+				((*mDense).*dense_op)(tmp);
+			}
+		}
+		rebalance();
+	}
+
+	void make_dense()
+	{
+		if (dense())
+			return;
+		mDense.reset(new dense_type);
+		mDense->assign(mSparse.begin(), mSparse.end());
+		mSparse.clear();
+	}
+
+	/// Switch the representation if the size crossed one of the limits.
+	void rebalance()
+	{
+		if (!dense() && mSparse.size() > dense_limit) {
+			make_dense();
+		} else if (dense() && mDense->size() < dense_limit / 2) {
+			mSparse.assign(mDense->begin(), mDense->end());
+			mDense.reset();
+		}
+	}
+
+	sparse_type mSparse;
+	std::unique_ptr<dense_type> mDense;
+};
+
+template<typename Resource, typename Predicate, typename Compare>
+typename AdaptiveSelection<Resource, Predicate, Compare>::size_type const
+	AdaptiveSelection<Resource, Predicate, Compare>::dense_limit;
+
+/** Store the selection in a sorted vector while it is small compared to
+ *  the index space and in a bitset otherwise.
+ *  Suited for components whose number of disabled resources varies
+ *  strongly between datasets.
+ */
+struct Adaptive :
+	public Storage
+{
+	template<typename Resource, typename Predicate, typename Compare>
+	struct selection
+	{
+		typedef AdaptiveSelection<Resource, Predicate, Compare> type;
+	};
+};
+
+} // storage
+} // redman
@@ -0,0 +1,475 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/optional.hpp>
+
+#include "redman/Storage.h"
+#include "redman/Predicate.h"
+#include "redman/storage/kernels.h"
+
+namespace redman {
+namespace storage {
+
+namespace detail {
+
+/// Serializes the lazy rebuilds of rank directories, which happen in const calls.
+inline std::mutex& rank_mutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+} // detail
+
+/** Selection container backed by a fixed-size bitset.
+ *  One bit is reserved for every index below `Predicate::index_type::end`,
+ *  so `count()`, `insert()` and `erase()` are single bit operations.
+ *  Implements the part of the `std::set` interface used by the policies;
+ *  iteration visits the stored resources in index order.
+ *  A rank directory holding the number of stored resources before every
+ *  block of 512 indices answers `rank()` in constant and `select()` in
+ *  logarithmic time.  Single insertions and erasures only mark it outdated,
+ *  it is rebuilt by the next `rank()` or `select()`.  Copies start with an
+ *  up to date directory, so unmodified copies never rebuild it.
+ *  \note `Compare` is only kept for interface compatibility, the order of
+ *        resources is always given by their index.
+ */
+template<typename Resource, typename Predicate, typename Compare>
+class BitsetSelection
+{
+	typedef redman::detail::ResourceIndex<Resource> index_mapping;
+
+public:
+	typedef Resource key_type;
+	typedef Resource value_type;
+	typedef Resource const& const_reference;
+	typedef Compare key_compare;
+	typedef std::size_t size_type;
+	typedef std::uint64_t word_type;
+
+	static size_type const word_bits = 64;
+	static size_type const bits = Predicate::index_type::end;
+	static size_type const words = (bits + word_bits - 1) / word_bits;
+
+	typedef std::array<word_type, words> words_type;
+
+	static size_type const block_words = 8;
+	static size_type const blocks = (words + block_words - 1) / block_words;
+
+	class const_iterator :
+		public boost::iterator_facade<
+			const_iterator,
+			Resource const,
+			boost::forward_traversal_tag,
+			// Return copy instead of reference:
+			Resource>
+	{
+	public:
+		const_iterator() : mSelection(nullptr), mIndex(bits) {}
+
+	private:
+		friend class BitsetSelection;
+		friend class boost::iterator_core_access;
+
+		const_iterator(BitsetSelection const* selection, size_type idx) :
+			mSelection(selection), mIndex(idx) {}
+
+		bool equal(const_iterator const& other) const
+		{
+			return mIndex == other.mIndex;
+		}
+
+		void increment()
+		{
+			mIndex = mSelection->find_next(mIndex + 1);
+		}
+
+		Resource dereference() const
+		{
+			return index_mapping::make(mIndex);
+		}
+
+		BitsetSelection const* mSelection;
+		size_type mIndex;
+	};
+
+	typedef const_iterator iterator;
+
+	BitsetSelection() : mWords(), mSize(0), mRanks(), mRanksValid(true)
+	{
+		mWords.fill(0);
+		mRanks.fill(0);
+	}
+
+	BitsetSelection(BitsetSelection const& other) :
+		mWords(other.mWords), mSize(other.mSize), mRanks(other.ranks()), mRanksValid(true)
+	{}
+
+	BitsetSelection& operator=(BitsetSelection const& other)
+	{
+		mWords = other.mWords;
+		mSize = other.mSize;
+		mRanks = other.ranks();
+		mRanksValid.store(true, std::memory_order_relaxed);
+		return *this;
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, find_next(0));
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, bits);
+	}
+
+	size_type size() const
+	{
+		return mSize;
+	}
+
+	bool empty() const
+	{
+		return mSize == 0;
+	}
+
+	size_type count(Resource const& val) const
+	{
+		size_type const idx = index_of(val);
+		return (mWords[idx / word_bits] >> (idx % word_bits)) & 1;
+	}
+
+	/// Return an iterator to the first stored resource not before `val`.
+	const_iterator lower_bound(Resource const& val) const
+	{
+		return const_iterator(this, find_next(index_of(val)));
+	}
+
+	/// Return an iterator to the first stored resource after `val`.
+	const_iterator upper_bound(Resource const& val) const
+	{
+		return const_iterator(this, find_next(index_of(val) + 1));
+	}
+
+	std::pair<const_iterator, bool> insert(Resource const& val)
+	{
+		size_type const idx = index_of(val);
+		word_type& word = mWords[idx / word_bits];
+		word_type const mask = word_type(1) << (idx % word_bits);
+		bool const inserted = !(word & mask);
+		if (inserted) {
+			word |= mask;
+			++mSize;
+			mRanksValid.store(false, std::memory_order_relaxed);
+		}
+		return std::make_pair(const_iterator(this, idx), inserted);
+	}
+
+	size_type erase(Resource const& val)
+	{
+		size_type const idx = index_of(val);
+		word_type& word = mWords[idx / word_bits];
+		word_type const mask = word_type(1) << (idx % word_bits);
+		if (!(word & mask))
+			return 0;
+		word &= ~mask;
+		--mSize;
+		mRanksValid.store(false, std::memory_order_relaxed);
+		return 1;
+	}
+
+	void clear()
+	{
+		mWords.fill(0);
+		mSize = 0;
+		mRanks.fill(0);
+		mRanksValid.store(true, std::memory_order_relaxed);
+	}
+
+	template<typename InputIterator>
+	void assign(InputIterator first, InputIterator last)
+	{
+		clear();
+		insert_many(first, last);
+	}
+
+	/* Batch insertion and erasure set or clear the bits of all resources
+	   and rebuild the rank directory once.  Return the number of resources
+	   inserted or erased, the range does not need to be sorted. */
+
+	template<typename InputIterator>
+	size_type insert_many(InputIterator first, InputIterator last)
+	{
+		size_type const before = mSize;
+		for (; first != last; ++first) {
+			size_type const idx = index_of(*first);
+			word_type& word = mWords[idx / word_bits];
+			word_type const mask = word_type(1) << (idx % word_bits);
+			mSize += !(word & mask);
+			word |= mask;
+		}
+		update_ranks();
+		return mSize - before;
+	}
+
+	template<typename InputIterator>
+	size_type erase_many(InputIterator first, InputIterator last)
+	{
+		size_type const before = mSize;
+		for (; first != last; ++first) {
+			size_type const idx = index_of(*first);
+			word_type& word = mWords[idx / word_bits];
+			word_type const mask = word_type(1) << (idx % word_bits);
+			mSize -= !!(word & mask);
+			word &= ~mask;
+		}
+		update_ranks();
+		return before - mSize;
+	}
+
+	/// Hinted insertion as for `std::set`, the hint is ignored.
+	const_iterator insert(const_iterator /*hint*/, Resource const& val)
+	{
+		return insert(val).first;
+	}
+
+	/* In-place set algebra on whole words, see redman/storage/kernels.h.
+	   The `_complement` variants combine with all indices of the index range
+	   that are not set in `other`. */
+
+	void merge(BitsetSelection const& other)
+	{
+		mSize = kernels::merge(mWords.data(), other.mWords.data(), words);
+		update_ranks();
+	}
+
+	void intersection(BitsetSelection const& other)
+	{
+		mSize = kernels::intersection(mWords.data(), other.mWords.data(), words);
+		update_ranks();
+	}
+
+	void difference(BitsetSelection const& other)
+	{
+		mSize = kernels::difference(mWords.data(), other.mWords.data(), words);
+		update_ranks();
+	}
+
+	void symmetric_difference(BitsetSelection const& other)
+	{
+		mSize = kernels::symmetric_difference(mWords.data(), other.mWords.data(), words);
+		update_ranks();
+	}
+
+	void merge_complement(BitsetSelection const& other)
+	{
+		mSize = kernels::merge_complement(mWords.data(), other.mWords.data(), words);
+		clip_to_range();
+		update_ranks();
+	}
+
+	void symmetric_difference_complement(BitsetSelection const& other)
+	{
+		mSize = kernels::symmetric_difference_complement(
+			mWords.data(), other.mWords.data(), words);
+		clip_to_range();
+		update_ranks();
+	}
+
+	/// Store every index of the index range.
+	void fill()
+	{
+		for (size_type w = 0; w < words; ++w)
+			mWords[w] = range_word(w);
+		recount();
+	}
+
+	/// Number of stored resources preceding `val`.
+	size_type rank(Resource const& val) const
+	{
+		size_type const idx = index_of(val);
+		size_type const w = idx / word_bits;
+		size_type const b = w / block_words;
+		size_type count = ranks()[b];
+		for (size_type ii = b * block_words; ii < w; ++ii)
+			count += static_cast<size_type>(__builtin_popcountll(mWords[ii]));
+		word_type const below = (word_type(1) << (idx % word_bits)) - 1;
+		return count + static_cast<size_type>(__builtin_popcountll(mWords[w] & below));
+	}
+
+	/// Return the `k`-th stored resource, `k` must be less than `size()`.
+	Resource select(size_type k) const
+	{
+		auto const& directory = ranks();
+		size_type const b = static_cast<size_type>(
+			std::upper_bound(directory.begin(), directory.end(), k) - directory.begin()) - 1;
+		k -= directory[b];
+		size_type w = b * block_words;
+		for (;; ++w) {
+			size_type const count = static_cast<size_type>(__builtin_popcountll(mWords[w]));
+			if (k < count)
+				break;
+			k -= count;
+		}
+		word_type word = mWords[w];
+		for (; k; --k)
+			word &= word - 1;
+		return index_mapping::make(w * word_bits + static_cast<size_type>(__builtin_ctzll(word)));
+	}
+
+	/// Return the last stored resource before `val`, if any.
+	boost::optional<Resource> prev(Resource const& val) const
+	{
+		size_type const idx = index_of(val);
+		if (idx == 0)
+			return boost::none;
+
+		// keep the bits up to idx - 1
+		size_type w = (idx - 1) / word_bits;
+		size_type const shift = word_bits - 1 - (idx - 1) % word_bits;
+		word_type word = (mWords[w] << shift) >> shift;
+		while (!word) {
+			if (w-- == 0)
+				return boost::none;
+			word = mWords[w];
+		}
+		return index_mapping::make(
+			w * word_bits + word_bits - 1 - static_cast<size_type>(__builtin_clzll(word)));
+	}
+
+	/// Raw bit storage, bit `i` corresponds to index `i`.
+	words_type const& data() const
+	{
+		return mWords;
+	}
+
+	bool operator==(BitsetSelection const& rhs) const
+	{
+		return mSize == rhs.mSize &&
+		       kernels::equal(mWords.data(), rhs.mWords.data(), words);
+	}
+
+	bool operator!=(BitsetSelection const& rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+private:
+	static size_type index_of(Resource const& val)
+	{
+		return static_cast<size_type>(index_mapping::get(val));
+	}
+
+	/// Index of the first stored resource at or after `pos`, `bits` if none.
+	size_type find_next(size_type pos) const
+	{
+		if (pos >= bits)
+			return bits;
+
+		size_type w = pos / word_bits;
+		word_type word = mWords[w] & (~word_type(0) << (pos % word_bits));
+		while (!word) {
+			if (++w == words)
+				return bits;
+			word = mWords[w];
+		}
+		return w * word_bits + static_cast<size_type>(__builtin_ctzll(word));
+	}
+
+	/// Bits of word `w` that lie within [index_type::begin, index_type::end).
+	static word_type range_word(size_type w)
+	{
+		size_type const first = Predicate::index_type::begin;
+		size_type const lo = w * word_bits;
+		size_type const hi = lo + word_bits;
+		word_type mask = ~word_type(0);
+		if (hi > bits)
+			mask >>= hi - bits;
+		if (first >= hi)
+			return 0;
+		if (first > lo)
+			mask &= ~word_type(0) << (first - lo);
+		return mask;
+	}
+
+	void recount()
+	{
+		mSize = kernels::popcount(mWords.data(), words);
+		update_ranks();
+	}
+
+	/// Rebuild the rank directory after modifying whole words.
+	void update_ranks() const
+	{
+		std::uint32_t count = 0;
+		for (size_type b = 0; b < blocks; ++b) {
+			mRanks[b] = count;
+			size_type const first = b * block_words;
+			count += static_cast<std::uint32_t>(kernels::popcount(
+				mWords.data() + first, std::min(block_words, words - first)));
+		}
+		mRanksValid.store(true, std::memory_order_release);
+	}
+
+	/// The rank directory, rebuilt if outdated.
+	std::array<std::uint32_t, blocks> const& ranks() const
+	{
+		if (!mRanksValid.load(std::memory_order_acquire)) {
+			// concurrent readers of an unmodified selection may both get here
+			std::lock_guard<std::mutex> lock(detail::rank_mutex());
+			if (!mRanksValid.load(std::memory_order_relaxed))
+				update_ranks();
+		}
+		return mRanks;
+	}
+
+	/// Clear the bits outside of the index range set by a complement operation.
+	/// Only the words up to `index_type::begin` and the last word are affected.
+	void clip_to_range()
+	{
+		size_type const partial = Predicate::index_type::begin / word_bits + 1;
+		for (size_type w = 0; w < words; ++w) {
+			if (w == partial && w + 1 < words)
+				w = words - 1;
+			word_type const clipped = mWords[w] & range_word(w);
+			mSize -= static_cast<size_type>(
+				__builtin_popcountll(mWords[w]) - __builtin_popcountll(clipped));
+			mWords[w] = clipped;
+		}
+	}
+
+	words_type mWords;
+	size_type mSize;
+	/// Number of stored resources in all blocks before, see `ranks()`.
+	mutable std::array<std::uint32_t, blocks> mRanks;
+	mutable std::atomic<bool> mRanksValid;
+};
+
+template<typename Resource, typename Predicate, typename Compare>
+struct HasStableIterators<BitsetSelection<Resource, Predicate, Compare> > : boost::true_type {};
+
+/** Store the selection in a dense bitset.
+ *  Memory is fixed by the size of the index space and independent of the
+ *  number of stored resources, lookup and modification are O(1).
+ */
+struct Bitset :
+	public Storage
+{
+	template<typename Resource, typename Predicate, typename Compare>
+	struct selection
+	{
+		typedef BitsetSelection<Resource, Predicate, Compare> type;
+	};
+};
+
+} // storage
+} // redman
@@ -0,0 +1,490 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/optional.hpp>
+
+#include "redman/Storage.h"
+#include "redman/Predicate.h"
+
+namespace redman {
+namespace storage {
+
+/** Compressed set of 16 bit values.
+ *  Depending on its content a chunk is stored as sorted array of values
+ *  (sparse), as bitmap of 65536 bits (dense) or as sorted list of runs of
+ *  consecutive values (clustered), similar to the containers of roaring
+ *  bitmaps.  Set algebra picks the smallest representation for the result,
+ *  single insertions and erasures only convert when the current
+ *  representation outgrows its limit.
+ */
+class CompressedChunk
+{
+public:
+	typedef std::uint16_t value_type;
+	typedef std::uint32_t size_type;
+	typedef std::uint64_t word_type;
+
+	enum kind_type { ARRAY, BITMAP, RUN };
+
+	/// Number of values a chunk can hold.
+	static size_type const capacity = 1 << 16;
+	/// Largest number of values stored as array.
+	static size_type const array_limit = 4096;
+	static size_type const bitmap_words = capacity / 64;
+
+	struct Run
+	{
+		value_type start;
+		value_type last;
+
+		bool operator==(Run const& rhs) const
+		{
+			return start == rhs.start && last == rhs.last;
+		}
+	};
+
+	CompressedChunk();
+
+	kind_type kind() const { return mKind; }
+	size_type size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
+
+	/// Bytes allocated for the values.
+	std::size_t memory() const;
+
+	bool contains(value_type val) const;
+	/// Return whether `val` was not contained before.
+	bool insert(value_type val);
+	/// Return whether `val` was contained before.
+	bool erase(value_type val);
+	void clear();
+	/// Store exactly the values in [first, last).
+	void fill(size_type first, size_type last);
+
+	/// First value at or after `pos`, `capacity` if there is none.
+	size_type next(size_type pos) const;
+	/// Last value before `pos`, `capacity` if there is none.
+	size_type prev(size_type pos) const;
+	/// Number of values smaller than `pos`.
+	size_type rank(size_type pos) const;
+	/// The `k`-th value, `k` must be less than `size()`.
+	value_type select(size_type k) const;
+
+	void merge(CompressedChunk const& other);
+	void intersection(CompressedChunk const& other);
+	void difference(CompressedChunk const& other);
+	void symmetric_difference(CompressedChunk const& other);
+	/// Merge with all values in [first, last) not contained in `other`.
+	void merge_complement(CompressedChunk const& other, size_type first, size_type last);
+	/// Symmetric difference with all values in [first, last) not contained in `other`.
+	void symmetric_difference_complement(
+		CompressedChunk const& other, size_type first, size_type last);
+
+	/// Convert to the representation using the least memory.
+	void optimize();
+
+	bool operator==(CompressedChunk const& rhs) const;
+	bool operator!=(CompressedChunk const& rhs) const { return !(*this == rhs); }
+
+private:
+	enum operation { OR, AND, AND_NOT, XOR };
+
+	void apply(CompressedChunk const& other, operation op);
+	void apply(word_type const* words, operation op);
+	void to_bitmap(word_type* words) const;
+	void assign_bitmap(word_type const* words, size_type count);
+	void to_array();
+	void check_runs();
+
+	kind_type mKind;
+	size_type mSize;
+	std::vector<value_type> mArray;
+	std::vector<word_type> mBitmap;
+	std::vector<Run> mRuns;
+};
+
+/** Selection container made of compressed chunks.
+ *  The index space below `Predicate::index_type::end` is split into chunks
+ *  of 65536 indices, each stored as `CompressedChunk`.  Selections with
+ *  long runs (e.g. a broken synapse row) or only few entries in a large
+ *  index space need far less memory than with `BitsetSelection`, while
+ *  lookup stays fast and set algebra works on whole chunks.
+ *  Implements the same interface as `BitsetSelection`, in addition
+ *  `count_range()` counts stored resources without iterating.
+ *  \note `Compare` is only kept for interface compatibility, the order of
+ *        resources is always given by their index.
+ */
+template<typename Resource, typename Predicate, typename Compare>
+class CompressedSelection
+{
+	typedef redman::detail::ResourceIndex<Resource> index_mapping;
+	typedef CompressedChunk chunk_type;
+
+public:
+	typedef Resource key_type;
+	typedef Resource value_type;
+	typedef Resource const& const_reference;
+	typedef Compare key_compare;
+	typedef std::size_t size_type;
+
+	static size_type const chunk_bits = chunk_type::capacity;
+	static size_type const bits = Predicate::index_type::end;
+	static size_type const chunks = (bits + chunk_bits - 1) / chunk_bits;
+
+	class const_iterator :
+		public boost::iterator_facade<
+			const_iterator,
+			Resource const,
+			boost::forward_traversal_tag,
+			// Return copy instead of reference:
+			Resource>
+	{
+	public:
+		const_iterator() : mSelection(nullptr), mIndex(bits) {}
+
+	private:
+		friend class CompressedSelection;
+		friend class boost::iterator_core_access;
+
+		const_iterator(CompressedSelection const* selection, size_type idx) :
+			mSelection(selection), mIndex(idx) {}
+
+		bool equal(const_iterator const& other) const
+		{
+			return mIndex == other.mIndex;
+		}
+
+		void increment()
+		{
+			mIndex = mSelection->find_next(mIndex + 1);
+		}
+
+		Resource dereference() const
+		{
+			return index_mapping::make(mIndex);
+		}
+
+		CompressedSelection const* mSelection;
+		size_type mIndex;
+	};
+
+	typedef const_iterator iterator;
+
+	CompressedSelection() : mChunks(chunks), mSize(0) {}
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, find_next(0));
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, bits);
+	}
+
+	size_type size() const
+	{
+		return mSize;
+	}
+
+	bool empty() const
+	{
+		return mSize == 0;
+	}
+
+	size_type count(Resource const& val) const
+	{
+		size_type const idx = index_of(val);
+		return mChunks[idx / chunk_bits].contains(low(idx));
+	}
+
+	/// Number of stored resources preceding `val`.
+	size_type rank(Resource const& val) const
+	{
+		return rank_index(index_of(val));
+	}
+
+	/// Return the `k`-th stored resource, `k` must be less than `size()`.
+	Resource select(size_type k) const
+	{
+		size_type c = 0;
+		for (; k >= mChunks[c].size(); ++c)
+			k -= mChunks[c].size();
+		return index_mapping::make(
+			c * chunk_bits + mChunks[c].select(static_cast<chunk_type::size_type>(k)));
+	}
+
+	/// Return the last stored resource before `val`, if any.
+	boost::optional<Resource> prev(Resource const& val) const
+	{
+		size_type const idx = index_of(val);
+		for (size_type c = idx / chunk_bits + 1; c-- > 0;) {
+			size_type const pos = c == idx / chunk_bits ? idx % chunk_bits : chunk_bits;
+			size_type const prev = mChunks[c].prev(static_cast<chunk_type::size_type>(pos));
+			if (prev < chunk_bits)
+				return index_mapping::make(c * chunk_bits + prev);
+		}
+		return boost::none;
+	}
+
+	/// Number of stored resources in [first, last).
+	size_type count_range(Resource const& first, Resource const& last) const
+	{
+		size_type const lo = rank_index(index_of(first));
+		size_type const hi = rank_index(index_of(last));
+		return hi > lo ? hi - lo : 0;
+	}
+
+	/// Return an iterator to the first stored resource not before `val`.
+	const_iterator lower_bound(Resource const& val) const
+	{
+		return const_iterator(this, find_next(index_of(val)));
+	}
+
+	/// Return an iterator to the first stored resource after `val`.
+	const_iterator upper_bound(Resource const& val) const
+	{
+		return const_iterator(this, find_next(index_of(val) + 1));
+	}
+
+	std::pair<const_iterator, bool> insert(Resource const& val)
+	{
+		size_type const idx = index_of(val);
+		bool const inserted = mChunks[idx / chunk_bits].insert(low(idx));
+		mSize += inserted;
+		return std::make_pair(const_iterator(this, idx), inserted);
+	}
+
+	/// Hinted insertion as for `std::set`, the hint is ignored.
+	const_iterator insert(const_iterator /*hint*/, Resource const& val)
+	{
+		return insert(val).first;
+	}
+
+	size_type erase(Resource const& val)
+	{
+		size_type const idx = index_of(val);
+		bool const erased = mChunks[idx / chunk_bits].erase(low(idx));
+		mSize -= erased;
+		return erased;
+	}
+
+	void clear()
+	{
+		for (auto& chunk : mChunks)
+			chunk.clear();
+		mSize = 0;
+	}
+
+	template<typename InputIterator>
+	void assign(InputIterator first, InputIterator last)
+	{
+		clear();
+		for (; first != last; ++first)
+			insert(*first);
+		optimize();
+	}
+
+	/* Batch insertion and erasure collect consecutive resources of the same
+	   chunk and combine them with the chunk by set algebra.  Sorted ranges
+	   therefore touch every chunk once.  Return the number of resources
+	   inserted or erased. */
+
+	template<typename InputIterator>
+	size_type insert_many(InputIterator first, InputIterator last)
+	{
+		size_type const before = mSize;
+		apply_many(first, last, &chunk_type::merge);
+		return mSize - before;
+	}
+
+	template<typename InputIterator>
+	size_type erase_many(InputIterator first, InputIterator last)
+	{
+		size_type const before = mSize;
+		apply_many(first, last, &chunk_type::difference);
+		return before - mSize;
+	}
+
+	/* In-place set algebra chunk by chunk.  The `_complement` variants
+	   combine with all indices of the index range that are not stored in
+	   `other`. */
+
+	void merge(CompressedSelection const& other)
+	{
+		for (size_type c = 0; c < chunks; ++c)
+			mChunks[c].merge(other.mChunks[c]);
+		recount();
+	}
+
+	void intersection(CompressedSelection const& other)
+	{
+		for (size_type c = 0; c < chunks; ++c)
+			mChunks[c].intersection(other.mChunks[c]);
+		recount();
+	}
+
+	void difference(CompressedSelection const& other)
+	{
+		for (size_type c = 0; c < chunks; ++c)
+			mChunks[c].difference(other.mChunks[c]);
+		recount();
+	}
+
+	void symmetric_difference(CompressedSelection const& other)
+	{
+		for (size_type c = 0; c < chunks; ++c)
+			mChunks[c].symmetric_difference(other.mChunks[c]);
+		recount();
+	}
+
+	void merge_complement(CompressedSelection const& other)
+	{
+		for (size_type c = 0; c < chunks; ++c)
+			mChunks[c].merge_complement(other.mChunks[c], range_first(c), range_last(c));
+		recount();
+	}
+
+	void symmetric_difference_complement(CompressedSelection const& other)
+	{
+		for (size_type c = 0; c < chunks; ++c)
+			mChunks[c].symmetric_difference_complement(
+				other.mChunks[c], range_first(c), range_last(c));
+		recount();
+	}
+
+	/// Store every index of the index range.
+	void fill()
+	{
+		for (size_type c = 0; c < chunks; ++c)
+			mChunks[c].fill(range_first(c), range_last(c));
+		recount();
+	}
+
+	/// Convert every chunk to its smallest representation.
+	void optimize()
+	{
+		for (auto& chunk : mChunks)
+			chunk.optimize();
+	}
+
+	/// Bytes allocated for the stored resources.
+	std::size_t memory() const
+	{
+		std::size_t bytes = 0;
+		for (auto const& chunk : mChunks)
+			bytes += chunk.memory();
+		return bytes;
+	}
+
+	bool operator==(CompressedSelection const& rhs) const
+	{
+		return mSize == rhs.mSize && mChunks == rhs.mChunks;
+	}
+
+	bool operator!=(CompressedSelection const& rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+private:
+	static size_type index_of(Resource const& val)
+	{
+		return static_cast<size_type>(index_mapping::get(val));
+	}
+
+	static chunk_type::value_type low(size_type idx)
+	{
+		return static_cast<chunk_type::value_type>(idx % chunk_bits);
+	}
+
+	/// Bounds of the index range within chunk `c`, relative to the chunk.
+	static chunk_type::size_type range_first(size_type c)
+	{
+		size_type const first = Predicate::index_type::begin;
+		size_type const lo = c * chunk_bits;
+		return static_cast<chunk_type::size_type>(first > lo ? first - lo : 0);
+	}
+
+	static chunk_type::size_type range_last(size_type c)
+	{
+		size_type const lo = c * chunk_bits;
+		return static_cast<chunk_type::size_type>(
+			bits - lo < chunk_bits ? bits - lo : chunk_bits);
+	}
+
+	/// Index of the first stored resource at or after `pos`, `bits` if none.
+	size_type find_next(size_type pos) const
+	{
+		for (size_type c = pos / chunk_bits; c < chunks; ++c) {
+			size_type const first = c == pos / chunk_bits ? pos % chunk_bits : 0;
+			size_type const next = mChunks[c].next(static_cast<chunk_type::size_type>(first));
+			if (next < chunk_bits)
+				return c * chunk_bits + next;
+		}
+		return bits;
+	}
+
+	template<typename InputIterator>
+	void apply_many(InputIterator first, InputIterator last,
+	                void (chunk_type::*op)(chunk_type const&))
+	{
+		while (first != last) {
+			size_type const c = index_of(*first) / chunk_bits;
+			chunk_type batch;
+			for (; first != last && index_of(*first) / chunk_bits == c; ++first)
+				batch.insert(low(index_of(*first)));
+			mSize -= mChunks[c].size();
+			(mChunks[c].*op)(batch);
+			mSize += mChunks[c].size();
+		}
+	}
+
+	size_type rank_index(size_type idx) const
+	{
+		if (idx >= bits)
+			return mSize;
+		size_type count = 0;
+		for (size_type c = 0; c < idx / chunk_bits; ++c)
+			count += mChunks[c].size();
+		return count + mChunks[idx / chunk_bits].rank(
+			static_cast<chunk_type::size_type>(idx % chunk_bits));
+	}
+
+	void recount()
+	{
+		mSize = 0;
+		for (auto const& chunk : mChunks)
+			mSize += chunk.size();
+	}
+
+	std::vector<chunk_type> mChunks;
+	size_type mSize;
+};
+
+template<typename Resource, typename Predicate, typename Compare>
+struct HasStableIterators<CompressedSelection<Resource, Predicate, Compare> > : boost::true_type {};
+
+/** Store the selection in compressed chunks of array, bitmap or run
+ *  containers.
+ *  Memory scales with the number of stored resources or of runs of
+ *  consecutive resources, whichever is smaller, and is bounded by that of
+ *  `Bitset`.  Suited for large index spaces such as synapses.
+ */
+struct Compressed :
+	public Storage
+{
+	template<typename Resource, typename Predicate, typename Compare>
+	struct selection
+	{
+		typedef CompressedSelection<Resource, Predicate, Compare> type;
+	};
+};
+
+} // storage
+} // redman
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace redman {
+namespace storage {
+
+/** Selection shared between copies of a resource manager.
+ *  Copying only increments a reference count, the selection itself is
+ *  copied on the first modification while it is shared.  Read access goes
+ *  through `operator*`, write access through `mutate()`.
+ *  The reference count is atomic, so copies can be modified concurrently
+ *  from different threads.  A single copy is not safe for concurrent use,
+ *  just as the selection it holds.
+ */
+template<typename Selection>
+class CopyOnWrite
+{
+public:
+	CopyOnWrite() : mSelection(boost::make_shared<Selection>()) {}
+
+	// No move operations, a moved-from manager has to stay usable.
+	CopyOnWrite(CopyOnWrite const&) = default;
+	CopyOnWrite& operator=(CopyOnWrite const&) = default;
+
+	Selection const& operator*() const
+	{
+		return *mSelection;
+	}
+
+	Selection const* operator->() const
+	{
+		return mSelection.get();
+	}
+
+	/// Return the selection for modification, copying it if it is shared.
+	Selection& mutate()
+	{
+		if (!mSelection.unique())
+			mSelection = boost::make_shared<Selection>(*mSelection);
+		return *mSelection;
+	}
+
+	/// Return an empty selection for modification, without copying a shared one.
+	Selection& reset()
+	{
+		if (mSelection.unique())
+			mSelection->clear();
+		else
+			mSelection = boost::make_shared<Selection>();
+		return *mSelection;
+	}
+
+	/// Whether `other` refers to the same selection.
+	bool shares(CopyOnWrite const& other) const
+	{
+		return mSelection == other.mSelection;
+	}
+
+private:
+	boost::shared_ptr<Selection> mSelection;
+};
+
+} // storage
+} // redman
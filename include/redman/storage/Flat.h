@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "redman/Storage.h"
+#include "redman/Predicate.h"
+
+namespace redman {
+namespace storage {
+
+/** Selection container backed by a sorted `std::vector`.
+ *  Needs one `Resource` per stored resource without any per-node overhead
+ *  and is traversed linearly in memory, lookup is a binary search.
+ *  Single insertions and erasures move the following elements, set algebra
+ *  is performed by merging both sorted ranges into a new vector.
+ *  Implements the part of the `std::set` interface used by the policies.
+ */
+template<typename Resource, typename Predicate, typename Compare>
+class FlatSelection
+{
+	typedef std::vector<Resource> container_type;
+
+public:
+	typedef Resource key_type;
+	typedef Resource value_type;
+	typedef Resource const& const_reference;
+	typedef Compare key_compare;
+	typedef std::size_t size_type;
+	typedef typename container_type::const_iterator const_iterator;
+	typedef const_iterator iterator;
+
+	FlatSelection() : mValues() {}
+
+	const_iterator begin() const
+	{
+		return mValues.begin();
+	}
+
+	const_iterator end() const
+	{
+		return mValues.end();
+	}
+
+	size_type size() const
+	{
+		return mValues.size();
+	}
+
+	bool empty() const
+	{
+		return mValues.empty();
+	}
+
+	key_compare key_comp() const
+	{
+		return key_compare();
+	}
+
+	size_type count(Resource const& val) const
+	{
+		return std::binary_search(mValues.begin(), mValues.end(), val, key_compare());
+	}
+
+	const_iterator lower_bound(Resource const& val) const
+	{
+		return std::lower_bound(mValues.begin(), mValues.end(), val, key_compare());
+	}
+
+	const_iterator upper_bound(Resource const& val) const
+	{
+		return std::upper_bound(mValues.begin(), mValues.end(), val, key_compare());
+	}
+
+	/// Number of stored resources preceding `val`.
+	size_type rank(Resource const& val) const
+	{
+		return static_cast<size_type>(lower_bound(val) - mValues.begin());
+	}
+
+	/// Return the `k`-th stored resource, `k` must be less than `size()`.
+	Resource select(size_type k) const
+	{
+		return mValues[k];
+	}
+
+	/// Return the last stored resource before `val`, if any.
+	boost::optional<Resource> prev(Resource const& val) const
+	{
+		auto const it = lower_bound(val);
+		if (it == mValues.begin())
+			return boost::none;
+		return *std::prev(it);
+	}
+
+	std::pair<const_iterator, bool> insert(Resource const& val)
+	{
+		auto it = lower_bound(val);
+		if (it != mValues.end() && !key_compare()(val, *it))
+			return std::make_pair(it, false);
+		return std::make_pair(const_iterator(mValues.insert(it, val)), true);
+	}
+
+	/// Hinted insertion as for `std::set`, appending in order is amortized O(1).
+	const_iterator insert(const_iterator hint, Resource const& val)
+	{
+		key_compare const cmp;
+		if ((hint == mValues.end() || cmp(val, *hint)) &&
+		    (hint == mValues.begin() || cmp(*std::prev(hint), val)))
+			return mValues.insert(hint, val);
+		return insert(val).first;
+	}
+
+	size_type erase(Resource const& val)
+	{
+		auto it = lower_bound(val);
+		if (it == mValues.end() || key_compare()(val, *it))
+			return 0;
+		mValues.erase(it);
+		return 1;
+	}
+
+	void clear()
+	{
+		container_type().swap(mValues);
+	}
+
+	template<typename InputIterator>
+	void assign(InputIterator first, InputIterator last)
+	{
+		key_compare const cmp;
+		mValues.assign(first, last);
+		std::sort(mValues.begin(), mValues.end(), cmp);
+		mValues.erase(
+			std::unique(mValues.begin(), mValues.end(),
+			            [&cmp](Resource const& a, Resource const& b) { return !cmp(a, b); }),
+			mValues.end());
+	}
+
+	/* Batch insertion and erasure of a sorted range of distinct resources
+	   merge it with the stored vector in a single pass.  Return the number
+	   of resources inserted or erased. */
+
+	template<typename InputIterator>
+	size_type insert_many(InputIterator first, InputIterator last)
+	{
+		size_type const before = mValues.size();
+		container_type result;
+		result.reserve(before);
+		std::set_union(mValues.begin(), mValues.end(), first, last,
+		               std::back_inserter(result), key_compare());
+		mValues.swap(result);
+		return mValues.size() - before;
+	}
+
+	template<typename InputIterator>
+	size_type erase_many(InputIterator first, InputIterator last)
+	{
+		size_type const before = mValues.size();
+		container_type result;
+		result.reserve(before);
+		std::set_difference(mValues.begin(), mValues.end(), first, last,
+		                    std::back_inserter(result), key_compare());
+		result.shrink_to_fit();
+		mValues.swap(result);
+		return before - mValues.size();
+	}
+
+	/* In-place set algebra by merging the sorted ranges.  The
+	   `_complement` variants combine with all resources of the predicate
+	   that are not contained in `other`. */
+
+	void merge(FlatSelection const& other)
+	{
+		combine(other.mValues, [](
+			const_iterator f1, const_iterator l1, const_iterator f2, const_iterator l2,
+			std::back_insert_iterator<container_type> out) {
+			std::set_union(f1, l1, f2, l2, out, key_compare());
+		});
+	}
+
+	void intersection(FlatSelection const& other)
+	{
+		combine(other.mValues, [](
+			const_iterator f1, const_iterator l1, const_iterator f2, const_iterator l2,
+			std::back_insert_iterator<container_type> out) {
+			std::set_intersection(f1, l1, f2, l2, out, key_compare());
+		});
+	}
+
+	void difference(FlatSelection const& other)
+	{
+		combine(other.mValues, [](
+			const_iterator f1, const_iterator l1, const_iterator f2, const_iterator l2,
+			std::back_insert_iterator<container_type> out) {
+			std::set_difference(f1, l1, f2, l2, out, key_compare());
+		});
+	}
+
+	void symmetric_difference(FlatSelection const& other)
+	{
+		combine(other.mValues, [](
+			const_iterator f1, const_iterator l1, const_iterator f2, const_iterator l2,
+			std::back_insert_iterator<container_type> out) {
+			std::set_symmetric_difference(f1, l1, f2, l2, out, key_compare());
+		});
+	}
+
+	template<typename Pred>
+	void merge_complement(FlatSelection const& other, Pred const& predicate)
+	{
+		FlatSelection complement;
+		complement.mValues = other.complement(predicate);
+		merge(complement);
+	}
+
+	template<typename Pred>
+	void symmetric_difference_complement(FlatSelection const& other, Pred const& predicate)
+	{
+		FlatSelection complement;
+		complement.mValues = other.complement(predicate);
+		symmetric_difference(complement);
+	}
+
+	bool operator==(FlatSelection const& rhs) const
+	{
+		return mValues == rhs.mValues;
+	}
+
+	bool operator!=(FlatSelection const& rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+private:
+	template<typename Function>
+	void combine(container_type const& other, Function f)
+	{
+		container_type result;
+		result.reserve(mValues.size() + other.size());
+		f(mValues.begin(), mValues.end(), other.begin(), other.end(),
+		  std::back_inserter(result));
+		result.shrink_to_fit();
+		mValues.swap(result);
+	}
+
+	/// All resources of the predicate not contained in this selection.
+	template<typename Pred>
+	container_type complement(Pred const& predicate) const
+	{
+		key_compare const cmp;
+		container_type result;
+		auto it = mValues.begin();
+		for (auto pit = redman::begin(predicate); pit != redman::end(predicate); ++pit) {
+			auto const val = *pit;
+			while (it != mValues.end() && cmp(*it, val))
+				++it;
+			if (it == mValues.end() || cmp(val, *it))
+				result.push_back(val);
+		}
+		return result;
+	}
+
+	container_type mValues;
+};
+
+/** Store the selection in a sorted `std::vector`.
+ *  Compact and cache friendly for small or rarely modified selections,
+ *  e.g. the few defects of a component loaded once from a dataset.
+ */
+struct FlatSet :
+	public Storage
+{
+	template<typename Resource, typename Predicate, typename Compare>
+	struct selection
+	{
+		typedef FlatSelection<Resource, Predicate, Compare> type;
+	};
+};
+
+} // storage
+} // redman
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <set>
+
+#include "redman/Storage.h"
+
+namespace redman {
+namespace storage {
+
+/** Store the selection in a `std::set`.
+ *  Memory and lookup cost scale with the number of stored resources,
+ *  which makes this the right choice for sparse selections.
+ */
+struct Set :
+	public Storage
+{
+	template<typename Resource, typename Predicate, typename Compare>
+	struct selection
+	{
+		typedef std::set<Resource, Compare> type;
+	};
+};
+
+} // storage
+} // redman
@@ -0,0 +1,430 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <set>
+
+#include <boost/optional.hpp>
+
+#include "redman/Predicate.h"
+#include "redman/storage/Bitset.h"
+#include "redman/storage/Compressed.h"
+#include "redman/storage/Flat.h"
+#include "redman/storage/Adaptive.h"
+
+/* In-place set algebra on selections.
+ * The generic versions work on ordered associative containers such as
+ * `std::set` by walking both operands in lockstep, so that only resources
+ * which actually change are inserted or erased.  Storages with a more
+ * efficient representation provide overloads.
+ * The `_complement` variants combine `set` with all resources of the
+ * predicate that are *not* contained in `other`.
+ */
+
+namespace redman {
+namespace storage {
+
+/// Store all resources accepted by the predicate.
+template<typename Set, typename Predicate>
+void fill(Set& set, Predicate const& predicate)
+{
+	set.clear();
+	for (auto it = redman::begin(predicate); it != redman::end(predicate); ++it)
+		set.insert(set.end(), *it);
+}
+
+/** Store all resources accepted by the predicate that are not in `other`.
+ *  `other` may be any range sorted with respect to the ordering of `set`.
+ */
+template<typename Set, typename Range, typename Predicate>
+void assign_complement(Set& set, Range const& other, Predicate const& predicate)
+{
+	typename Set::key_compare const cmp;
+	set.clear();
+	auto oit = other.begin();
+	for (auto it = redman::begin(predicate); it != redman::end(predicate); ++it) {
+		auto const val = *it;
+		while (oit != other.end() && cmp(*oit, val))
+			++oit;
+		if (oit == other.end() || cmp(val, *oit))
+			set.insert(set.end(), val);
+	}
+}
+
+/// set |= other
+template<typename Set>
+void merge(Set& set, Set const& other)
+{
+	auto const cmp = set.key_comp();
+	auto it = set.begin();
+	for (auto const& val : other) {
+		while (it != set.end() && cmp(*it, val))
+			++it;
+		if (it == set.end() || cmp(val, *it))
+			set.insert(it, val);
+		else
+			++it;
+	}
+}
+
+/// set &= other
+template<typename Set>
+void intersection(Set& set, Set const& other)
+{
+	auto const cmp = set.key_comp();
+	auto oit = other.begin();
+	auto it = set.begin();
+	while (it != set.end()) {
+		while (oit != other.end() && cmp(*oit, *it))
+			++oit;
+		if (oit == other.end() || cmp(*it, *oit))
+			it = set.erase(it);
+		else
+			++it;
+	}
+}
+
+/// set -= other
+template<typename Set>
+void difference(Set& set, Set const& other)
+{
+	auto const cmp = set.key_comp();
+	auto it = set.begin();
+	for (auto const& val : other) {
+		while (it != set.end() && cmp(*it, val))
+			++it;
+		if (it == set.end())
+			break;
+		if (!cmp(val, *it))
+			it = set.erase(it);
+	}
+}
+
+/// set ^= other
+template<typename Set>
+void symmetric_difference(Set& set, Set const& other)
+{
+	auto const cmp = set.key_comp();
+	auto it = set.begin();
+	for (auto const& val : other) {
+		while (it != set.end() && cmp(*it, val))
+			++it;
+		if (it == set.end() || cmp(val, *it))
+			set.insert(it, val);
+		else
+			it = set.erase(it);
+	}
+}
+
+namespace detail {
+
+/// Call `f(set, hint, val, contained)` for every resource of the predicate
+/// that is not in `other`.
+template<typename Set, typename Predicate, typename Function>
+void for_each_complement(
+	Set& set, Set const& other, Predicate const& predicate, Function f)
+{
+	auto const cmp = set.key_comp();
+	auto it = set.begin();
+	auto oit = other.begin();
+	for (auto pit = redman::begin(predicate); pit != redman::end(predicate); ++pit) {
+		auto const val = *pit;
+		while (oit != other.end() && cmp(*oit, val))
+			++oit;
+		if (oit != other.end() && !cmp(val, *oit))
+			continue;
+		while (it != set.end() && cmp(*it, val))
+			++it;
+		it = f(set, it, val, it != set.end() && !cmp(val, *it));
+	}
+}
+
+} // detail
+
+/// set |= predicate \ other
+template<typename Set, typename Predicate>
+void merge_complement(Set& set, Set const& other, Predicate const& predicate)
+{
+	typedef typename Set::iterator iterator;
+	typedef typename Set::value_type value_type;
+	detail::for_each_complement(set, other, predicate,
+		[](Set& s, iterator it, value_type const& val, bool contained) -> iterator {
+			if (!contained)
+				s.insert(it, val);
+			return it;
+		});
+}
+
+/// set ^= predicate \ other
+template<typename Set, typename Predicate>
+void symmetric_difference_complement(
+	Set& set, Set const& other, Predicate const& predicate)
+{
+	typedef typename Set::iterator iterator;
+	typedef typename Set::value_type value_type;
+	detail::for_each_complement(set, other, predicate,
+		[](Set& s, iterator it, value_type const& val, bool contained) -> iterator {
+			if (contained)
+				return s.erase(it);
+			s.insert(it, val);
+			return it;
+		});
+}
+
+
+namespace detail {
+
+template<typename Selection, typename Predicate>
+void fill_indexed(Selection& set, Predicate const& predicate)
+{
+	if (redman::detail::IsDefaultPredicate<Predicate>::value) {
+		set.fill();
+		return;
+	}
+	set.clear();
+	for (auto it = redman::begin(predicate); it != redman::end(predicate); ++it)
+		set.insert(*it);
+}
+
+template<typename Selection, typename Predicate>
+void merge_complement_indexed(Selection& set, Selection const& other, Predicate const& predicate)
+{
+	if (redman::detail::IsDefaultPredicate<Predicate>::value) {
+		set.merge_complement(other);
+		return;
+	}
+	for (auto it = redman::begin(predicate); it != redman::end(predicate); ++it) {
+		auto const val = *it;
+		if (!other.count(val))
+			set.insert(val);
+	}
+}
+
+template<typename Selection, typename Predicate>
+void symmetric_difference_complement_indexed(
+	Selection& set, Selection const& other, Predicate const& predicate)
+{
+	if (redman::detail::IsDefaultPredicate<Predicate>::value) {
+		set.symmetric_difference_complement(other);
+		return;
+	}
+	for (auto it = redman::begin(predicate); it != redman::end(predicate); ++it) {
+		auto const val = *it;
+		if (!other.count(val) && !set.erase(val))
+			set.insert(val);
+	}
+}
+
+} // detail
+
+/* Indexed selections (bitset and compressed storage) implement the set
+   algebra as member functions working on whole words or chunks.  Their
+   complement is formed within the full index range, which is only correct
+   for `DefaultPredicate`; other predicates fall back to testing every
+   accepted resource. */
+
+template<typename Res, typename Pred, typename Cmp, typename Predicate>
+void fill(BitsetSelection<Res, Pred, Cmp>& set, Predicate const& predicate)
+{
+	detail::fill_indexed(set, predicate);
+}
+
+template<typename Res, typename Pred, typename Cmp, typename Predicate>
+void fill(CompressedSelection<Res, Pred, Cmp>& set, Predicate const& predicate)
+{
+	detail::fill_indexed(set, predicate);
+}
+
+template<typename Res, typename Pred, typename Cmp, typename Predicate>
+void fill(AdaptiveSelection<Res, Pred, Cmp>& set, Predicate const& predicate)
+{
+	detail::fill_indexed(set, predicate);
+}
+
+#define REDMAN_INDEXED_SELECTION_ALGEBRA(SELECTION)                            \
+	template<typename Res, typename Pred, typename Cmp>                        \
+	void merge(SELECTION<Res, Pred, Cmp>& set, SELECTION<Res, Pred, Cmp> const& other) \
+	{                                                                          \
+		set.merge(other);                                                      \
+	}                                                                          \
+	template<typename Res, typename Pred, typename Cmp>                        \
+	void intersection(SELECTION<Res, Pred, Cmp>& set, SELECTION<Res, Pred, Cmp> const& other) \
+	{                                                                          \
+		set.intersection(other);                                               \
+	}                                                                          \
+	template<typename Res, typename Pred, typename Cmp>                        \
+	void difference(SELECTION<Res, Pred, Cmp>& set, SELECTION<Res, Pred, Cmp> const& other) \
+	{                                                                          \
+		set.difference(other);                                                 \
+	}                                                                          \
+	template<typename Res, typename Pred, typename Cmp>                        \
+	void symmetric_difference(SELECTION<Res, Pred, Cmp>& set, SELECTION<Res, Pred, Cmp> const& other) \
+	{                                                                          \
+		set.symmetric_difference(other);                                       \
+	}                                                                          \
+	template<typename Res, typename Pred, typename Cmp, typename Predicate>    \
+	void merge_complement(                                                     \
+		SELECTION<Res, Pred, Cmp>& set,                                        \
+		SELECTION<Res, Pred, Cmp> const& other,                                \
+		Predicate const& predicate)                                            \
+	{                                                                          \
+		detail::merge_complement_indexed(set, other, predicate);               \
+	}                                                                          \
+	template<typename Res, typename Pred, typename Cmp, typename Predicate>    \
+	void symmetric_difference_complement(                                      \
+		SELECTION<Res, Pred, Cmp>& set,                                        \
+		SELECTION<Res, Pred, Cmp> const& other,                                \
+		Predicate const& predicate)                                            \
+	{                                                                          \
+		detail::symmetric_difference_complement_indexed(set, other, predicate); \
+	}
+
+REDMAN_INDEXED_SELECTION_ALGEBRA(BitsetSelection)
+REDMAN_INDEXED_SELECTION_ALGEBRA(CompressedSelection)
+REDMAN_INDEXED_SELECTION_ALGEBRA(AdaptiveSelection)
+
+#undef REDMAN_INDEXED_SELECTION_ALGEBRA
+
+
+/* FlatSelection: sorted ranges are merged into a new vector, as inserting
+   into or erasing from the vector one by one would be quadratic. */
+
+template<typename Res, typename Pred, typename Cmp>
+void merge(FlatSelection<Res, Pred, Cmp>& set, FlatSelection<Res, Pred, Cmp> const& other)
+{
+	set.merge(other);
+}
+
+template<typename Res, typename Pred, typename Cmp>
+void intersection(FlatSelection<Res, Pred, Cmp>& set, FlatSelection<Res, Pred, Cmp> const& other)
+{
+	set.intersection(other);
+}
+
+template<typename Res, typename Pred, typename Cmp>
+void difference(FlatSelection<Res, Pred, Cmp>& set, FlatSelection<Res, Pred, Cmp> const& other)
+{
+	set.difference(other);
+}
+
+template<typename Res, typename Pred, typename Cmp>
+void symmetric_difference(FlatSelection<Res, Pred, Cmp>& set, FlatSelection<Res, Pred, Cmp> const& other)
+{
+	set.symmetric_difference(other);
+}
+
+template<typename Res, typename Pred, typename Cmp, typename Predicate>
+void merge_complement(
+	FlatSelection<Res, Pred, Cmp>& set,
+	FlatSelection<Res, Pred, Cmp> const& other,
+	Predicate const& predicate)
+{
+	set.merge_complement(other, predicate);
+}
+
+template<typename Res, typename Pred, typename Cmp, typename Predicate>
+void symmetric_difference_complement(
+	FlatSelection<Res, Pred, Cmp>& set,
+	FlatSelection<Res, Pred, Cmp> const& other,
+	Predicate const& predicate)
+{
+	set.symmetric_difference_complement(other, predicate);
+}
+
+
+/* Batch modification with a sorted range of distinct resources.  All
+   selections except `std::set` provide them as members, which apply the
+   whole range at once. */
+
+/// Insert all resources in [first, last), return the number inserted.
+template<typename Set, typename InputIterator>
+size_t insert_many(Set& set, InputIterator first, InputIterator last)
+{
+	return set.insert_many(first, last);
+}
+
+template<typename T, typename C, typename A, typename InputIterator>
+size_t insert_many(std::set<T, C, A>& set, InputIterator first, InputIterator last)
+{
+	size_t const before = set.size();
+	// Successive resources are inserted after their predecessor.
+	auto hint = set.begin();
+	for (; first != last; ++first)
+		hint = std::next(set.insert(hint, *first));
+	return set.size() - before;
+}
+
+/// Erase all resources in [first, last), return the number erased.
+template<typename Set, typename InputIterator>
+size_t erase_many(Set& set, InputIterator first, InputIterator last)
+{
+	return set.erase_many(first, last);
+}
+
+template<typename T, typename C, typename A, typename InputIterator>
+size_t erase_many(std::set<T, C, A>& set, InputIterator first, InputIterator last)
+{
+	size_t erased = 0;
+	for (; first != last; ++first)
+		erased += set.erase(*first);
+	return erased;
+}
+
+
+/* Order statistics.  All selections except `std::set` provide them as
+   members, the tree can only be walked. */
+
+/// Number of stored resources preceding `val`.
+template<typename Set>
+size_t rank(Set const& set, typename Set::value_type const& val)
+{
+	return set.rank(val);
+}
+
+template<typename T, typename C, typename A>
+size_t rank(std::set<T, C, A> const& set, T const& val)
+{
+	return static_cast<size_t>(std::distance(set.begin(), set.lower_bound(val)));
+}
+
+/// The `k`-th stored resource, `k` must be less than `set.size()`.
+template<typename Set>
+typename Set::value_type select(Set const& set, size_t k)
+{
+	return set.select(k);
+}
+
+template<typename T, typename C, typename A>
+T select(std::set<T, C, A> const& set, size_t k)
+{
+	return *std::next(set.begin(), static_cast<std::ptrdiff_t>(k));
+}
+
+/// The last stored resource before `val`, if any.
+template<typename Set>
+boost::optional<typename Set::value_type> prev(Set const& set, typename Set::value_type const& val)
+{
+	return set.prev(val);
+}
+
+template<typename T, typename C, typename A>
+boost::optional<T> prev(std::set<T, C, A> const& set, T const& val)
+{
+	auto const it = set.lower_bound(val);
+	if (it == set.begin())
+		return boost::none;
+	return *std::prev(it);
+}
+
+/// The first stored resource after `val`, if any.
+template<typename Set>
+boost::optional<typename Set::value_type> next(Set const& set, typename Set::value_type const& val)
+{
+	auto const it = set.upper_bound(val);
+	if (it == set.end())
+		return boost::none;
+	return *it;
+}
+
+} // storage
+} // redman
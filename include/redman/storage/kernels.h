@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Word-parallel kernels for bitmap storages.
+ * Every operation works on arrays of `n` 64 bit words and the binary
+ * operations return the number of bits set in the result, so that callers
+ * can update their cached size without a second pass.
+ * The implementation is chosen once at runtime depending on the instruction
+ * set extensions supported by the CPU (AVX2, SSE4.2/POPCNT), a portable
+ * scalar implementation serves as fallback.
+ */
+
+namespace redman {
+namespace storage {
+namespace kernels {
+
+typedef std::uint64_t word_type;
+
+/// Table of kernel implementations for one instruction set.
+struct Implementation
+{
+	char const* name;
+
+	/// Number of bits set in `a`.
+	std::size_t (*popcount)(word_type const* a, std::size_t n);
+	/// dst |= src
+	std::size_t (*merge)(word_type* dst, word_type const* src, std::size_t n);
+	/// dst &= src
+	std::size_t (*intersection)(word_type* dst, word_type const* src, std::size_t n);
+	/// dst &= ~src
+	std::size_t (*difference)(word_type* dst, word_type const* src, std::size_t n);
+	/// dst ^= src
+	std::size_t (*symmetric_difference)(word_type* dst, word_type const* src, std::size_t n);
+	/// dst |= ~src
+	std::size_t (*merge_complement)(word_type* dst, word_type const* src, std::size_t n);
+	/// dst ^= ~src
+	std::size_t (*symmetric_difference_complement)(
+		word_type* dst, word_type const* src, std::size_t n);
+	/// a == b
+	bool (*equal)(word_type const* a, word_type const* b, std::size_t n);
+};
+
+/// Portable implementation, available on every platform.
+Implementation const& scalar();
+
+/// All implementations supported by the running CPU, fastest last.
+/// The returned array is terminated by an entry whose name is null.
+Implementation const* supported();
+
+/// Implementation used by the storages, selected on first use.
+Implementation const& active();
+
+inline std::size_t popcount(word_type const* a, std::size_t n)
+{
+	return active().popcount(a, n);
+}
+
+inline std::size_t merge(word_type* dst, word_type const* src, std::size_t n)
+{
+	return active().merge(dst, src, n);
+}
+
+inline std::size_t intersection(word_type* dst, word_type const* src, std::size_t n)
+{
+	return active().intersection(dst, src, n);
+}
+
+inline std::size_t difference(word_type* dst, word_type const* src, std::size_t n)
+{
+	return active().difference(dst, src, n);
+}
+
+inline std::size_t symmetric_difference(word_type* dst, word_type const* src, std::size_t n)
+{
+	return active().symmetric_difference(dst, src, n);
+}
+
+inline std::size_t merge_complement(word_type* dst, word_type const* src, std::size_t n)
+{
+	return active().merge_complement(dst, src, n);
+}
+
+inline std::size_t symmetric_difference_complement(
+	word_type* dst, word_type const* src, std::size_t n)
+{
+	return active().symmetric_difference_complement(dst, src, n);
+}
+
+inline bool equal(word_type const* a, word_type const* b, std::size_t n)
+{
+	return active().equal(a, b, n);
+}
+
+} // kernels
+} // storage
+} // redman
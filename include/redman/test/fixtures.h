@@ -4,6 +4,8 @@
 #include <stdexcept>
 #include <gtest/gtest.h>
 #include <boost/operators.hpp>
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/nvp.hpp>
 
 #include "redman/ResourceManager.h"
 
@@ -20,9 +22,19 @@ struct TestResource : public boost::operators<TestResource> {
 	bool operator==(TestResource const& other) const;
 	TestResource& operator++();
 	TestResource& operator+=(TestResource const& other);
+	value_type value() const;
 
 	value_type index;
 
+private:
+	friend class boost::serialization::access;
+	TestResource() : index(begin) {}
+
+	template <typename Archiver>
+	void serialize(Archiver& ar, unsigned int const) {
+		ar & boost::serialization::make_nvp("index", index);
+	}
+
 	friend std::ostream& operator<<(std::ostream& os, TestResource const& tr) {
 		return os << tr.index;
 	}
@@ -38,20 +50,42 @@ struct LessThanPredicate : public redman::DefaultPredicate<TestResource> {
 	size_t lt;
 };
 
-struct EvenPredicate : public redman::DefaultPredicate<TestResource> {
+struct EvenPredicate : public redman::DefaultPredicate<TestResource>,
+                       public redman::StaticValidityMask<EvenPredicate> {
 	bool operator()(resource_type const& res) const {
 		return !(res.index % 2);
 	}
 };
 
-typedef ::testing::Types<redman::Whitelist, redman::Blacklist> PolicyTypes;
+template <typename Policy, typename Storage>
+struct ManagerConfig {
+	typedef Policy policy;
+	typedef Storage storage;
+};
+
+typedef ::testing::Types<
+	ManagerConfig<redman::Whitelist, redman::storage::Set>,
+	ManagerConfig<redman::Blacklist, redman::storage::Set>,
+	ManagerConfig<redman::Whitelist, redman::storage::FlatSet>,
+	ManagerConfig<redman::Blacklist, redman::storage::FlatSet>,
+	ManagerConfig<redman::Whitelist, redman::storage::Bitset>,
+	ManagerConfig<redman::Blacklist, redman::storage::Bitset>,
+	ManagerConfig<redman::Whitelist, redman::storage::Compressed>,
+	ManagerConfig<redman::Blacklist, redman::storage::Compressed>,
+	ManagerConfig<redman::Whitelist, redman::storage::Adaptive>,
+	ManagerConfig<redman::Blacklist, redman::storage::Adaptive> > ManagerTypes;
+
+template <typename Config, typename Predicate = redman::DefaultPredicate<TestResource> >
+using TestManager = redman::ResourceManager<
+	TestResource, typename Config::policy, Predicate,
+	std::less<TestResource>, typename Config::storage>;
 
 template <typename T>
 struct AManager : public ::testing::Test {
-	redman::ResourceManager<TestResource, T> manager;
+	TestManager<T> manager;
 };
 
 template <typename T>
 struct AManagerWithEvenPredicate : public ::testing::Test {
-	redman::ResourceManager<TestResource, T, EvenPredicate> manager;
+	TestManager<T, EvenPredicate> manager;
 };
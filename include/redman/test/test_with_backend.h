@@ -14,14 +14,32 @@ boost::shared_ptr<redman::backend::Backend> init_backend(
 
 template <typename T>
 class TestWithBackend : public ::testing::Test {};
-struct XMLBackend {};
+
+// tags of the backends to test, plugins provide the name of their library
+struct XMLBackend {
+	static char const* library() { return "libredman_xml.so"; }
+};
+struct BinaryBackend {
+	static char const* library() { return "libredman_binary.so"; }
+};
+struct FlatBackend {
+	static char const* library() { return "libredman_flat.so"; }
+};
+struct BundleBackend {
+	static char const* library() { return "libredman_bundle.so"; }
+};
+#ifdef REDMAN_WITH_SQLITE
+struct SQLiteBackend {
+	static char const* library() { return "libredman_sqlite.so"; }
+};
+#endif
 struct MockBackend {};
 
-template <>
-class TestWithBackend<XMLBackend> : public ::testing::Test {
+template <typename Plugin>
+class TestWithPluginBackend : public ::testing::Test {
 public:
 	static void SetUpTestCase() {
-		backend = init_backend("libredman_xml.so");
+		backend = init_backend(Plugin::library());
 		ASSERT_TRUE(static_cast<bool>(backend));
 
 		backendPath = boost::filesystem::unique_path();
@@ -40,6 +58,28 @@ public:
 	static boost::filesystem::path backendPath;
 };
 
+template <typename Plugin>
+boost::shared_ptr<redman::backend::Backend> TestWithPluginBackend<Plugin>::backend;
+template <typename Plugin>
+boost::filesystem::path TestWithPluginBackend<Plugin>::backendPath;
+
+template <>
+class TestWithBackend<XMLBackend> : public TestWithPluginBackend<XMLBackend> {};
+
+template <>
+class TestWithBackend<BinaryBackend> : public TestWithPluginBackend<BinaryBackend> {};
+
+template <>
+class TestWithBackend<FlatBackend> : public TestWithPluginBackend<FlatBackend> {};
+
+template <>
+class TestWithBackend<BundleBackend> : public TestWithPluginBackend<BundleBackend> {};
+
+#ifdef REDMAN_WITH_SQLITE
+template <>
+class TestWithBackend<SQLiteBackend> : public TestWithPluginBackend<SQLiteBackend> {};
+#endif
+
 class TestWithMockBackend : public ::testing::Test {
 public:
 	TestWithMockBackend()
@@ -49,4 +89,13 @@ public:
 
 template <>
 class TestWithBackend<MockBackend> : public TestWithMockBackend {};
-typedef ::testing::Types<XMLBackend, MockBackend> BackendTypes;
+// the sqlite backend is only built if sqlite3 is available
+#ifdef REDMAN_WITH_SQLITE
+typedef ::testing::Types<
+	XMLBackend, BinaryBackend, FlatBackend, BundleBackend, SQLiteBackend, MockBackend>
+	BackendTypes;
+#else
+typedef ::testing::Types<
+	XMLBackend, BinaryBackend, FlatBackend, BundleBackend, MockBackend>
+	BackendTypes;
+#endif
@@ -2,6 +2,8 @@
 
 #include "redman/backend/Library.h"
 #include "redman/backend/Backend.h"
+#include "redman/backend/CachingBackend.h"
+#include "redman/backend/OverlayBackend.h"
 
 #include "redman/resources/Fpga.h"
 #include "redman/resources/Hicann.h"
@@ -0,0 +1,162 @@
+#include "redman/backends/binary/BinaryBackend.h"
+
+// polymorphic classes need to be registered in each backend
+#include "redman/backends/export.ipp"
+
+#include "redman/backend/interface.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "redman/AtomicFile.h"
+#include "redman/backend/Compression.h"
+#include "redman/backend/Serialization.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "boost/serialization/path.h"
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/export.hpp>
+
+using namespace redman::resources;
+
+namespace redman {
+namespace backend {
+
+namespace {
+
+char const magic[8] = {'r', 'e', 'd', 'm', 'a', 'n', 'b', 'n'};
+char const little_endian = 'L';
+char const big_endian = 'B';
+
+char native_byte_order()
+{
+	std::uint16_t const probe = 1;
+	char first;
+	std::memcpy(&first, &probe, 1);
+	return first ? little_endian : big_endian;
+}
+
+/* Header layout: magic, format version as 32 bit little endian integer,
+   byte order of the following archive ('L' or 'B'), seven bytes padding. */
+
+void write_header(std::ostream& stream)
+{
+	char header[20] = {};
+	std::memcpy(header, magic, sizeof(magic));
+	for (size_t ii = 0; ii < 4; ++ii)
+		header[8 + ii] = static_cast<char>((BinaryBackend::format_version >> (8 * ii)) & 0xff);
+	header[12] = native_byte_order();
+	stream.write(header, sizeof(header));
+}
+
+void read_header(std::istream& stream, std::string const& file)
+{
+	char header[20];
+	if (!stream.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0)
+		throw std::runtime_error("not a redman binary file: " + file);
+
+	unsigned int version = 0;
+	for (size_t ii = 0; ii < 4; ++ii)
+		version |= static_cast<unsigned int>(static_cast<unsigned char>(header[8 + ii])) << (8 * ii);
+	if (version > BinaryBackend::format_version)
+		throw std::runtime_error(
+			"unsupported redman binary format version " + std::to_string(version) + ": " + file);
+
+	if (header[12] != native_byte_order())
+		throw std::runtime_error("redman binary file has foreign byte order: " + file);
+}
+
+} // anonymous
+
+unsigned int const BinaryBackend::format_version = 1;
+
+BinaryBackend::BinaryBackend() :
+	mPath(".") {}
+
+BinaryBackend::~BinaryBackend() {}
+
+void BinaryBackend::init()
+{
+	namespace fs = boost::filesystem;
+	if (exists("path")) {
+		mPath = get<std::string>("path");
+		if (!fs::is_directory(mPath)) {
+			std::string err = "Path not available: " + mPath.string();
+			throw std::runtime_error(err);
+		}
+	}
+	check_compression();
+}
+
+void BinaryBackend::load(std::string const& id, Base& res)
+{
+	namespace fs = boost::filesystem;
+	auto file = getFilename(id);
+	if (!fs::exists(file)) {
+		throw not_found_error("data set not found: " + file.native());
+	}
+
+	std::ifstream file_stream(file.string(), std::ios::in | std::ios::binary);
+	std::string const content(
+		(std::istreambuf_iterator<char>(file_stream)), std::istreambuf_iterator<char>());
+	std::istringstream stream(Compression::decompress(content));
+	read_header(stream, file.native());
+	load_resource(stream, res);
+}
+
+void BinaryBackend::store(std::string const& id, Base const& res)
+{
+	std::ostringstream stream;
+	write_header(stream);
+	save_resource(stream, res);
+	// the whole file is compressed, the header is checked after decompression
+	redman::detail::replace_file(getFilename(id).string(), compression().compress(stream.str()));
+}
+
+std::string BinaryBackend::revision(std::string const& id) const
+{
+	return file_revision(getFilename(id).string());
+}
+
+BinaryBackend::path
+BinaryBackend::getFilename(
+	std::string const& id) const
+{
+	return mPath / (id + ".bin");
+}
+
+template<typename Archiver>
+void BinaryBackend::serialize(Archiver & ar, unsigned int const /*version*/)
+{
+	using boost::serialization::make_nvp;
+	ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Backend);
+	ar & make_nvp("path", mPath);
+}
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_IMPLEMENT(redman::backend::BinaryBackend)
+
+#include "boost/serialization/serialization_helper.tcc"
+EXPLICIT_INSTANTIATE_BOOST_SERIALIZE(redman::backend::BinaryBackend)
+
+extern "C" {
+
+backend_t* createBackend()
+{
+	return new redman::backend::BinaryBackend();
+}
+
+void destroyBackend(backend_t* backend)
+{
+	delete backend;
+}
+
+} // extern "C"
@@ -0,0 +1,482 @@
+#include "redman/backends/bundle/BundleBackend.h"
+
+// polymorphic classes need to be registered in each backend
+#include "redman/backends/export.ipp"
+
+#include "redman/backend/interface.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "redman/AtomicFile.h"
+#include "redman/backend/Compression.h"
+#include "redman/backend/Serialization.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/crc.hpp>
+
+#include "boost/serialization/path.h"
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/export.hpp>
+
+using namespace redman::resources;
+
+namespace redman {
+namespace backend {
+
+namespace {
+
+/* Header layout, integers little endian:
+   magic | version u32 | byte order of the archives u8, 3 bytes padding |
+   index offset u64 | index length u64.
+   Index layout: per entry id length u32 | id | offset u64 | length u64 | crc u32. */
+
+char const magic[8] = {'r', 'e', 'd', 'm', 'a', 'n', 'b', 'd'};
+std::uint32_t const format_version = 1;
+std::size_t const header_size = 32;
+
+/// Bundles are compacted if outdated content exceeds live content and this size.
+std::uint64_t const compaction_threshold = 1 << 20;
+
+char native_byte_order()
+{
+	std::uint16_t const probe = 1;
+	char first;
+	std::memcpy(&first, &probe, 1);
+	return first ? 'L' : 'B';
+}
+
+void put(std::string& buffer, std::uint64_t val, std::size_t bytes)
+{
+	for (std::size_t ii = 0; ii < bytes; ++ii)
+		buffer.push_back(static_cast<char>((val >> (8 * ii)) & 0xff));
+}
+
+std::uint64_t get(char const* data, std::size_t bytes)
+{
+	std::uint64_t val = 0;
+	for (std::size_t ii = 0; ii < bytes; ++ii)
+		val |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[ii])) << (8 * ii);
+	return val;
+}
+
+std::uint32_t checksum(char const* data, std::size_t size)
+{
+	boost::crc_32_type crc;
+	crc.process_bytes(data, size);
+	return crc.checksum();
+}
+
+std::runtime_error corrupt(std::string const& file)
+{
+	return std::runtime_error("corrupt redman bundle: " + file);
+}
+
+/// File descriptor closed on destruction.
+class File
+{
+public:
+	File(std::string const& file, int flags) : mFd(::open(file.c_str(), flags | O_CLOEXEC, 0644))
+	{
+		if (mFd < 0)
+			throw std::runtime_error("unable to open redman bundle: " + file);
+	}
+
+	~File()
+	{
+		::close(mFd);
+	}
+
+	File(File const&) = delete;
+	File& operator=(File const&) = delete;
+
+	int fd() const
+	{
+		return mFd;
+	}
+
+	void lock(int operation) const
+	{
+		while (flock(mFd, operation) != 0) {
+			if (errno != EINTR)
+				throw std::runtime_error("unable to lock redman bundle");
+		}
+	}
+
+	struct stat status() const
+	{
+		struct stat info;
+		if (fstat(mFd, &info) != 0)
+			throw std::runtime_error("unable to stat redman bundle");
+		return info;
+	}
+
+private:
+	int mFd;
+};
+
+std::string read_at(int fd, std::uint64_t offset, std::uint64_t length, std::string const& file)
+{
+	std::string buffer(length, '\0');
+	std::size_t done = 0;
+	while (done < length) {
+		ssize_t const n = pread(fd, &buffer[done], length - done, offset + done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			throw corrupt(file);
+		done += static_cast<std::size_t>(n);
+	}
+	return buffer;
+}
+
+void write_at(int fd, std::uint64_t offset, std::string const& buffer, std::string const& file)
+{
+	std::size_t done = 0;
+	while (done < buffer.size()) {
+		ssize_t const n = pwrite(fd, buffer.data() + done, buffer.size() - done, offset + done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			throw std::runtime_error("unable to write redman bundle: " + file);
+		done += static_cast<std::size_t>(n);
+	}
+}
+
+std::string make_header(std::uint64_t index_offset, std::uint64_t index_length)
+{
+	std::string header(magic, sizeof(magic));
+	put(header, format_version, 4);
+	header.push_back(native_byte_order());
+	header.append(3, '\0');
+	put(header, index_offset, 8);
+	put(header, index_length, 8);
+	return header;
+}
+
+/// Location of the index as stored in the header.
+std::pair<std::uint64_t, std::uint64_t> parse_header(std::string const& header, std::string const& file)
+{
+	if (header.size() < header_size || std::memcmp(header.data(), magic, sizeof(magic)) != 0)
+		throw std::runtime_error("not a redman bundle: " + file);
+	std::uint64_t const version = get(header.data() + 8, 4);
+	if (version > format_version)
+		throw std::runtime_error(
+			"unsupported redman bundle version " + std::to_string(version) + ": " + file);
+	if (header[12] != native_byte_order())
+		throw std::runtime_error("redman bundle has foreign byte order: " + file);
+	return std::make_pair(get(header.data() + 16, 8), get(header.data() + 24, 8));
+}
+
+template<typename Index>
+void parse_index(std::string const& buffer, std::uint64_t file_size, Index& index, std::string const& file)
+{
+	std::size_t pos = 0;
+	while (pos < buffer.size()) {
+		if (buffer.size() - pos < 4)
+			throw corrupt(file);
+		std::size_t const id_length = get(buffer.data() + pos, 4);
+		pos += 4;
+		if (buffer.size() - pos < id_length + 20)
+			throw corrupt(file);
+		std::string const id = buffer.substr(pos, id_length);
+		pos += id_length;
+		auto& entry = index[id];
+		entry.offset = get(buffer.data() + pos, 8);
+		entry.length = get(buffer.data() + pos + 8, 8);
+		entry.checksum = static_cast<std::uint32_t>(get(buffer.data() + pos + 16, 4));
+		pos += 20;
+		if (entry.offset < header_size || entry.offset + entry.length > file_size)
+			throw corrupt(file);
+	}
+}
+
+template<typename Index>
+std::string make_index(Index const& index)
+{
+	std::string buffer;
+	for (auto const& item : index) {
+		put(buffer, item.first.size(), 4);
+		buffer.append(item.first);
+		put(buffer, item.second.offset, 8);
+		put(buffer, item.second.length, 8);
+		put(buffer, item.second.checksum, 4);
+	}
+	return buffer;
+}
+
+template<typename Index>
+void read_index(int fd, std::uint64_t file_size, Index& index, std::string const& file)
+{
+	auto const location = parse_header(read_at(fd, 0, header_size, file), file);
+	if (location.first < header_size || location.first + location.second > file_size)
+		throw corrupt(file);
+	parse_index(read_at(fd, location.first, location.second, file), file_size, index, file);
+}
+
+void deserialize_resource(
+	char const* data, std::size_t length, std::uint32_t crc, Base& res, std::string const& file)
+{
+	if (checksum(data, length) != crc)
+		throw std::runtime_error("checksum mismatch in redman bundle: " + file);
+	backend::deserialize_resource(std::string(data, length), res);
+}
+
+std::int64_t mtime_ns(struct stat const& info)
+{
+	return static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+}
+
+} // anonymous
+
+BundleBackend::BundleBackend() :
+	mPath("."), mCacheMutex(), mIndexCache() {}
+
+BundleBackend::~BundleBackend() {}
+
+void BundleBackend::init()
+{
+	namespace fs = boost::filesystem;
+	if (exists("path")) {
+		mPath = get<std::string>("path");
+		if (!fs::is_directory(mPath)) {
+			std::string err = "Path not available: " + mPath.string();
+			throw std::runtime_error(err);
+		}
+	}
+	check_compression();
+}
+
+std::string BundleBackend::bundle(std::string const& id) const
+{
+	auto const first = std::find_if(id.begin(), id.end(), [](char c) { return std::isdigit(c); });
+	if (first == id.end())
+		return (mPath / (id + ".bundle")).string();
+	auto const last = std::find_if(first, id.end(), [](char c) { return !std::isdigit(c); });
+	return (mPath / ("wafer-" + std::string(first, last) + ".bundle")).string();
+}
+
+bool BundleBackend::lookup(int fd, std::string const& file, std::string const& id, Entry& entry) const
+{
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+		throw std::runtime_error("unable to stat redman bundle: " + file);
+
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+	auto& cached = mIndexCache[file];
+	if (cached.inode != info.st_ino || cached.size != std::uint64_t(info.st_size) ||
+	    cached.mtime != mtime_ns(info)) {
+		cached.index.clear();
+		// invalidate first, the index stays empty if reading fails
+		cached.inode = 0;
+		read_index(fd, info.st_size, cached.index, file);
+		cached.inode = info.st_ino;
+		cached.size = info.st_size;
+		cached.mtime = mtime_ns(info);
+	}
+
+	auto const it = cached.index.find(id);
+	if (it == cached.index.end())
+		return false;
+	entry = it->second;
+	return true;
+}
+
+void BundleBackend::load(std::string const& id, Base& res)
+{
+	namespace fs = boost::filesystem;
+	auto const file = bundle(id);
+	if (!fs::exists(file)) {
+		throw not_found_error("data set not found: " + file);
+	}
+
+	File bundle_file(file, O_RDONLY);
+	bundle_file.lock(LOCK_SH);
+	Entry entry;
+	if (!lookup(bundle_file.fd(), file, id, entry))
+		throw not_found_error("data set not found: " + id + " in " + file);
+
+	auto const data = read_at(bundle_file.fd(), entry.offset, entry.length, file);
+	deserialize_resource(data.data(), data.size(), entry.checksum, res, file);
+}
+
+std::vector<bool> BundleBackend::load_many(
+	std::vector<std::string> const& ids,
+	std::vector<Base*> const& resources)
+{
+	namespace fs = boost::filesystem;
+	if (ids.size() != resources.size())
+		throw std::invalid_argument("load_many: number of ids and resources differ");
+
+	std::map<std::string, std::vector<size_t> > bundles;
+	for (size_t ii = 0; ii < ids.size(); ++ii)
+		bundles[bundle(ids[ii])].push_back(ii);
+
+	std::vector<bool> found(ids.size(), false);
+	for (auto const& item : bundles) {
+		std::string const& file = item.first;
+		if (!fs::exists(file))
+			continue;
+
+		// one sequential read of the whole bundle
+		File bundle_file(file, O_RDONLY);
+		bundle_file.lock(LOCK_SH);
+		std::uint64_t const size = bundle_file.status().st_size;
+		std::string const content = read_at(bundle_file.fd(), 0, size, file);
+
+		auto const location = parse_header(content, file);
+		if (location.first < header_size || location.first + location.second > size)
+			throw corrupt(file);
+		index_type index;
+		parse_index(content.substr(location.first, location.second), size, index, file);
+
+		for (auto const ii : item.second) {
+			auto const it = index.find(ids[ii]);
+			if (it == index.end())
+				continue;
+			deserialize_resource(
+				content.data() + it->second.offset, it->second.length, it->second.checksum,
+				*resources[ii], file);
+			found[ii] = true;
+		}
+	}
+	return found;
+}
+
+void BundleBackend::store(std::string const& id, Base const& res)
+{
+	store_many({id}, {&res});
+}
+
+std::string BundleBackend::revision(std::string const& id) const
+{
+	// conservative, changes if any resource of the bundle is stored
+	return file_revision(bundle(id));
+}
+
+void BundleBackend::store_many(
+	std::vector<std::string> const& ids,
+	std::vector<Base const*> const& resources)
+{
+	if (ids.size() != resources.size())
+		throw std::invalid_argument("store_many: number of ids and resources differ");
+
+	auto const method = compression();
+	std::map<std::string, std::pair<std::vector<std::string>, std::vector<std::string> > > bundles;
+	for (size_t ii = 0; ii < ids.size(); ++ii) {
+		auto& item = bundles[bundle(ids[ii])];
+		item.first.push_back(ids[ii]);
+		item.second.push_back(method.compress(serialize_resource(*resources[ii])));
+	}
+
+	for (auto const& item : bundles)
+		store_bundle(item.first, item.second.first, item.second.second);
+}
+
+void BundleBackend::store_bundle(
+	std::string const& file,
+	std::vector<std::string> const& ids,
+	std::vector<std::string> const& payloads)
+{
+	for (;;) {
+		File bundle_file(file, O_RDWR | O_CREAT);
+		bundle_file.lock(LOCK_EX);
+
+		// a concurrent compaction may have replaced the file while we waited
+		struct stat on_disk;
+		auto const info = bundle_file.status();
+		if (stat(file.c_str(), &on_disk) != 0 || on_disk.st_ino != info.st_ino)
+			continue;
+
+		index_type index;
+		std::uint64_t size = info.st_size;
+		if (size == 0) {
+			write_at(bundle_file.fd(), 0, make_header(header_size, 0), file);
+			size = header_size;
+		} else {
+			read_index(bundle_file.fd(), size, index, file);
+		}
+
+		// append the payloads, then the new index, then switch the header
+		std::string data;
+		for (size_t ii = 0; ii < ids.size(); ++ii) {
+			auto& entry = index[ids[ii]];
+			entry.offset = size + data.size();
+			entry.length = payloads[ii].size();
+			entry.checksum = checksum(payloads[ii].data(), payloads[ii].size());
+			data.append(payloads[ii]);
+		}
+		std::string const index_data = make_index(index);
+		std::uint64_t const index_offset = size + data.size();
+		data.append(index_data);
+		write_at(bundle_file.fd(), size, data, file);
+		// the new index has to be on disk before the header points to it
+		if (fdatasync(bundle_file.fd()) != 0)
+			throw std::runtime_error("unable to sync redman bundle: " + file);
+		write_at(bundle_file.fd(), 0, make_header(index_offset, index_data.size()), file);
+
+		std::uint64_t live = header_size + index_data.size();
+		for (auto const& item : index)
+			live += item.second.length;
+		std::uint64_t const total = index_offset + index_data.size();
+		if (total - live <= std::max(live, compaction_threshold))
+			return;
+
+		// rewrite the live content into a fresh bundle, still holding the lock
+		std::string compacted = make_header(0, 0);
+		index_type compacted_index;
+		for (auto const& item : index) {
+			auto& entry = compacted_index[item.first];
+			entry = item.second;
+			entry.offset = compacted.size();
+			compacted.append(read_at(bundle_file.fd(), item.second.offset, item.second.length, file));
+		}
+		std::string const compacted_index_data = make_index(compacted_index);
+		std::string const header = make_header(compacted.size(), compacted_index_data.size());
+		compacted.replace(0, header_size, header);
+		compacted.append(compacted_index_data);
+
+		redman::detail::replace_file(file, compacted);
+		return;
+	}
+}
+
+template<typename Archiver>
+void BundleBackend::serialize(Archiver & ar, unsigned int const /*version*/)
+{
+	using boost::serialization::make_nvp;
+	ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Backend);
+	ar & make_nvp("path", mPath);
+}
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_IMPLEMENT(redman::backend::BundleBackend)
+
+#include "boost/serialization/serialization_helper.tcc"
+EXPLICIT_INSTANTIATE_BOOST_SERIALIZE(redman::backend::BundleBackend)
+
+extern "C" {
+
+backend_t* createBackend()
+{
+	return new redman::backend::BundleBackend();
+}
+
+void destroyBackend(backend_t* backend)
+{
+	delete backend;
+}
+
+} // extern "C"
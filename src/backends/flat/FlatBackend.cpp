@@ -0,0 +1,156 @@
+#include "redman/backends/flat/FlatBackend.h"
+
+// polymorphic classes need to be registered in each backend
+#include "redman/backends/export.ipp"
+
+#include "redman/backend/interface.h"
+#include "redman/flat/Resources.h"
+
+#include <stdexcept>
+
+#include "boost/serialization/path.h"
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/export.hpp>
+
+using namespace redman::resources;
+
+namespace redman {
+namespace backend {
+
+namespace {
+
+struct AddToWriter
+{
+	flat::Writer& writer;
+
+	template<typename Component>
+	void operator()(char const* name, boost::shared_ptr<Component> const& component) const
+	{
+		if (component)
+			writer.add(name, *component);
+	}
+};
+
+struct CopyFromMapping
+{
+	flat::MappedResource const& mapping;
+
+	template<typename Component>
+	void operator()(char const* name, boost::shared_ptr<Component> const& component) const
+	{
+		// components missing in the file keep their defaults
+		if (component && mapping.has_component(name))
+			mapping.component<Component>(name).copy_to(*component);
+	}
+};
+
+/// Load into a fresh `Resource`, `res` is replaced as with other backends.
+template<typename Resource>
+void load_into(flat::MappedResource const& mapping, Base& res)
+{
+	Resource tmp;
+	CopyFromMapping copy{mapping};
+	flat::for_each_component(tmp, copy);
+	res.copy(tmp);
+}
+
+} // anonymous
+
+FlatBackend::FlatBackend() :
+	mPath(".") {}
+
+FlatBackend::~FlatBackend() {}
+
+void FlatBackend::init()
+{
+	namespace fs = boost::filesystem;
+	if (exists("path")) {
+		mPath = get<std::string>("path");
+		if (!fs::is_directory(mPath)) {
+			std::string err = "Path not available: " + mPath.string();
+			throw std::runtime_error(err);
+		}
+	}
+	if (compression().method() != Compression::NONE)
+		throw std::invalid_argument(
+			"FlatBackend: flat files are mapped directly and cannot be compressed");
+}
+
+boost::shared_ptr<flat::MappedResource const> FlatBackend::view(std::string const& id) const
+{
+	namespace fs = boost::filesystem;
+	auto file = getFilename(id);
+	if (!fs::exists(file)) {
+		throw not_found_error("data set not found: " + file.native());
+	}
+	return flat::MappedResource::open(file.string());
+}
+
+void FlatBackend::load(std::string const& id, Base& res)
+{
+	auto const mapping = view(id);
+	if (dynamic_cast<Wafer*>(&res))
+		load_into<Wafer>(*mapping, res);
+	else if (dynamic_cast<Hicann*>(&res))
+		load_into<Hicann>(*mapping, res);
+	else if (dynamic_cast<Fpga*>(&res))
+		load_into<Fpga>(*mapping, res);
+	else
+		throw std::runtime_error("flat backend cannot load resource " + id);
+}
+
+void FlatBackend::store(std::string const& id, Base const& res)
+{
+	flat::Writer writer;
+	AddToWriter add{writer};
+	if (auto const wafer = dynamic_cast<Wafer const*>(&res))
+		flat::for_each_component(*wafer, add);
+	else if (auto const hicann = dynamic_cast<Hicann const*>(&res))
+		flat::for_each_component(*hicann, add);
+	else if (auto const fpga = dynamic_cast<Fpga const*>(&res))
+		flat::for_each_component(*fpga, add);
+	else
+		throw std::runtime_error("flat backend cannot store resource " + id);
+	writer.write(getFilename(id).string());
+}
+
+std::string FlatBackend::revision(std::string const& id) const
+{
+	return file_revision(getFilename(id).string());
+}
+
+FlatBackend::path
+FlatBackend::getFilename(
+	std::string const& id) const
+{
+	return mPath / (id + ".flat");
+}
+
+template<typename Archiver>
+void FlatBackend::serialize(Archiver & ar, unsigned int const /*version*/)
+{
+	using boost::serialization::make_nvp;
+	ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Backend);
+	ar & make_nvp("path", mPath);
+}
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_IMPLEMENT(redman::backend::FlatBackend)
+
+#include "boost/serialization/serialization_helper.tcc"
+EXPLICIT_INSTANTIATE_BOOST_SERIALIZE(redman::backend::FlatBackend)
+
+extern "C" {
+
+backend_t* createBackend()
+{
+	return new redman::backend::FlatBackend();
+}
+
+void destroyBackend(backend_t* backend)
+{
+	delete backend;
+}
+
+} // extern "C"
@@ -0,0 +1,412 @@
+#include "redman/backends/sqlite/SQLiteBackend.h"
+
+// polymorphic classes need to be registered in each backend
+#include "redman/backends/export.ipp"
+
+#include "redman/backend/interface.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <sqlite3.h>
+
+#include "redman/backend/Compression.h"
+#include "redman/backend/Serialization.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "boost/serialization/path.h"
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/export.hpp>
+
+using namespace redman::resources;
+
+namespace redman {
+namespace backend {
+
+namespace {
+
+/// Upper bound for bound parameters per query, below SQLite's default limit.
+size_t const ids_per_query = 500;
+
+/// Milliseconds to wait for locks held by other connections.
+int const busy_timeout = 10000;
+
+/// Prepared statement, reset for reuse on destruction of its `Use`.
+class Statement
+{
+public:
+	Statement(sqlite3* db, std::string const& sql) : mStmt(nullptr)
+	{
+		if (sqlite3_prepare_v2(db, sql.c_str(), -1, &mStmt, nullptr) != SQLITE_OK)
+			throw std::runtime_error(std::string("sqlite: ") + sqlite3_errmsg(db));
+	}
+
+	~Statement()
+	{
+		sqlite3_finalize(mStmt);
+	}
+
+	Statement(Statement const&) = delete;
+	Statement& operator=(Statement const&) = delete;
+
+	class Use
+	{
+	public:
+		explicit Use(Statement& statement) : mStmt(statement.mStmt) {}
+
+		~Use()
+		{
+			sqlite3_reset(mStmt);
+			sqlite3_clear_bindings(mStmt);
+		}
+
+		void bind(int column, std::string const& text)
+		{
+			check(sqlite3_bind_text(mStmt, column, text.data(), text.size(), SQLITE_TRANSIENT));
+		}
+
+		void bind_null(int column)
+		{
+			check(sqlite3_bind_null(mStmt, column));
+		}
+
+		void bind_blob(int column, std::string const& data)
+		{
+			check(sqlite3_bind_blob(mStmt, column, data.data(), data.size(), SQLITE_TRANSIENT));
+		}
+
+		/// Advance to the next row, false once done.
+		bool step()
+		{
+			int const rc = sqlite3_step(mStmt);
+			if (rc == SQLITE_ROW)
+				return true;
+			check(rc == SQLITE_DONE ? SQLITE_OK : rc);
+			return false;
+		}
+
+		std::string text(int column) const
+		{
+			auto const data = reinterpret_cast<char const*>(sqlite3_column_text(mStmt, column));
+			return std::string(data, sqlite3_column_bytes(mStmt, column));
+		}
+
+		void load(int column, Base& res) const
+		{
+			auto const data = static_cast<char const*>(sqlite3_column_blob(mStmt, column));
+			deserialize_resource(std::string(data, sqlite3_column_bytes(mStmt, column)), res);
+		}
+
+	private:
+		void check(int rc) const
+		{
+			if (rc != SQLITE_OK)
+				throw std::runtime_error(
+					std::string("sqlite: ") + sqlite3_errmsg(sqlite3_db_handle(mStmt)));
+		}
+
+		sqlite3_stmt* mStmt;
+	};
+
+private:
+	sqlite3_stmt* mStmt;
+};
+
+} // anonymous
+
+class SQLiteBackend::Connection
+{
+public:
+	explicit Connection(std::string const& file) : mDb(nullptr)
+	{
+		int const flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+		if (sqlite3_open_v2(file.c_str(), &mDb, flags, nullptr) != SQLITE_OK) {
+			std::string err = "unable to open database " + file + ": " + sqlite3_errmsg(mDb);
+			sqlite3_close(mDb);
+			throw std::runtime_error(err);
+		}
+		sqlite3_busy_timeout(mDb, busy_timeout);
+
+		try {
+			execute("PRAGMA journal_mode=WAL");
+			execute("PRAGMA synchronous=NORMAL");
+			execute("CREATE TABLE IF NOT EXISTS resources ("
+			        "id TEXT PRIMARY KEY NOT NULL, data BLOB NOT NULL) WITHOUT ROWID");
+
+			int version = 0;
+			{
+				Statement query(mDb, "PRAGMA user_version");
+				Statement::Use use(query);
+				if (use.step())
+					version = std::stoi(use.text(0));
+			}
+			if (version > schema_version)
+				throw std::runtime_error(
+					"unsupported redman database version " + std::to_string(version) + ": " + file);
+			if (version < schema_version)
+				execute("PRAGMA user_version=" + std::to_string(schema_version));
+
+			mSelect.reset(new Statement(mDb, "SELECT data FROM resources WHERE id = ?"));
+			mInsert.reset(new Statement(mDb, "INSERT OR REPLACE INTO resources (id, data) VALUES (?, ?)"));
+			mBegin.reset(new Statement(mDb, "BEGIN IMMEDIATE"));
+			mCommit.reset(new Statement(mDb, "COMMIT"));
+			mRollback.reset(new Statement(mDb, "ROLLBACK"));
+
+			std::string select_many = "SELECT id, data FROM resources WHERE id IN (?";
+			for (size_t ii = 1; ii < ids_per_query; ++ii)
+				select_many += ", ?";
+			mSelectMany.reset(new Statement(mDb, select_many + ")"));
+		} catch (...) {
+			close();
+			throw;
+		}
+	}
+
+	~Connection()
+	{
+		close();
+	}
+
+	Connection(Connection const&) = delete;
+	Connection& operator=(Connection const&) = delete;
+
+	bool load(std::string const& id, Base& res)
+	{
+		Statement::Use use(*mSelect);
+		use.bind(1, id);
+		if (!use.step())
+			return false;
+		use.load(0, res);
+		return true;
+	}
+
+	/// Load a batch of at most `ids_per_query` unique ids with one query.
+	void load_batch(
+		std::vector<std::string> const& ids,
+		std::map<std::string, std::vector<size_t> > const& positions,
+		std::vector<Base*> const& resources,
+		std::vector<bool>& found)
+	{
+		// unused parameters are NULL, which matches no id
+		Statement::Use use(*mSelectMany);
+		for (size_t ii = 0; ii < ids_per_query; ++ii) {
+			if (ii < ids.size())
+				use.bind(ii + 1, ids[ii]);
+			else
+				use.bind_null(ii + 1);
+		}
+		while (use.step()) {
+			for (auto const pos : positions.at(use.text(0))) {
+				use.load(1, *resources[pos]);
+				found[pos] = true;
+			}
+		}
+	}
+
+	void store(
+		std::vector<std::string> const& ids,
+		std::vector<std::string> const& payloads)
+	{
+		{
+			Statement::Use begin(*mBegin);
+			begin.step();
+		}
+		try {
+			for (size_t ii = 0; ii < ids.size(); ++ii) {
+				Statement::Use use(*mInsert);
+				use.bind(1, ids[ii]);
+				use.bind_blob(2, payloads[ii]);
+				use.step();
+			}
+			Statement::Use commit(*mCommit);
+			commit.step();
+		} catch (...) {
+			if (!sqlite3_get_autocommit(mDb)) {
+				Statement::Use rollback(*mRollback);
+				rollback.step();
+			}
+			throw;
+		}
+	}
+
+private:
+	void execute(std::string const& sql)
+	{
+		char* err = nullptr;
+		if (sqlite3_exec(mDb, sql.c_str(), nullptr, nullptr, &err) != SQLITE_OK) {
+			std::string msg = std::string("sqlite: ") + (err ? err : "unknown error");
+			sqlite3_free(err);
+			throw std::runtime_error(msg);
+		}
+	}
+
+	void close()
+	{
+		// statements have to be finalized before the database is closed
+		mSelect.reset();
+		mInsert.reset();
+		mBegin.reset();
+		mCommit.reset();
+		mRollback.reset();
+		mSelectMany.reset();
+		sqlite3_close(mDb);
+	}
+
+	sqlite3* mDb;
+	std::unique_ptr<Statement> mSelect;
+	std::unique_ptr<Statement> mInsert;
+	std::unique_ptr<Statement> mBegin;
+	std::unique_ptr<Statement> mCommit;
+	std::unique_ptr<Statement> mRollback;
+	/// Statement for `load_batch()`, with `ids_per_query` parameters.
+	std::unique_ptr<Statement> mSelectMany;
+};
+
+int const SQLiteBackend::schema_version = 1;
+
+SQLiteBackend::SQLiteBackend() :
+	mPath("."), mFile("redman.sqlite"), mPoolMutex(), mIdle() {}
+
+SQLiteBackend::~SQLiteBackend() {}
+
+void SQLiteBackend::init()
+{
+	namespace fs = boost::filesystem;
+	if (exists("path")) {
+		mPath = get<std::string>("path");
+		if (!fs::is_directory(mPath)) {
+			std::string err = "Path not available: " + mPath.string();
+			throw std::runtime_error(err);
+		}
+	}
+	if (exists("file"))
+		mFile = get<std::string>("file");
+	check_compression();
+
+	{
+		std::lock_guard<std::mutex> lock(mPoolMutex);
+		mIdle.clear();
+	}
+	// create the database and its schema up front
+	connection();
+}
+
+void SQLiteBackend::Release::operator()(Connection* connection) const
+{
+	std::lock_guard<std::mutex> lock(backend->mPoolMutex);
+	backend->mIdle.emplace_back(connection);
+}
+
+SQLiteBackend::lease_type SQLiteBackend::connection() const
+{
+	{
+		std::lock_guard<std::mutex> lock(mPoolMutex);
+		if (!mIdle.empty()) {
+			lease_type lease(mIdle.back().release(), Release{this});
+			mIdle.pop_back();
+			return lease;
+		}
+	}
+	return lease_type(new Connection(database().string()), Release{this});
+}
+
+SQLiteBackend::path SQLiteBackend::database() const
+{
+	return mPath / mFile;
+}
+
+void SQLiteBackend::load(std::string const& id, Base& res)
+{
+	if (!connection()->load(id, res))
+		throw not_found_error("data set not found: " + id + " in " + database().native());
+}
+
+std::vector<bool> SQLiteBackend::load_many(
+	std::vector<std::string> const& ids,
+	std::vector<Base*> const& resources)
+{
+	if (ids.size() != resources.size())
+		throw std::invalid_argument("load_many: number of ids and resources differ");
+
+	std::map<std::string, std::vector<size_t> > positions;
+	for (size_t ii = 0; ii < ids.size(); ++ii)
+		positions[ids[ii]].push_back(ii);
+
+	std::vector<bool> found(ids.size(), false);
+	auto const db = connection();
+	std::vector<std::string> batch;
+	for (auto const& item : positions) {
+		batch.push_back(item.first);
+		if (batch.size() == ids_per_query) {
+			db->load_batch(batch, positions, resources, found);
+			batch.clear();
+		}
+	}
+	if (!batch.empty())
+		db->load_batch(batch, positions, resources, found);
+	return found;
+}
+
+void SQLiteBackend::store(std::string const& id, Base const& res)
+{
+	store_many({id}, {&res});
+}
+
+std::string SQLiteBackend::revision(std::string const&) const
+{
+	// commits go to the write-ahead log until it is checkpointed
+	auto const file = database().string();
+	return file_revision(file) + " " + file_revision(file + "-wal");
+}
+
+void SQLiteBackend::store_many(
+	std::vector<std::string> const& ids,
+	std::vector<Base const*> const& resources)
+{
+	if (ids.size() != resources.size())
+		throw std::invalid_argument("store_many: number of ids and resources differ");
+
+	// serialize outside of the transaction to keep the write lock short
+	auto const method = compression();
+	std::vector<std::string> payloads;
+	payloads.reserve(resources.size());
+	for (auto const res : resources)
+		payloads.push_back(method.compress(serialize_resource(*res)));
+
+	connection()->store(ids, payloads);
+}
+
+template<typename Archiver>
+void SQLiteBackend::serialize(Archiver & ar, unsigned int const /*version*/)
+{
+	using boost::serialization::make_nvp;
+	ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Backend);
+	ar & make_nvp("path", mPath);
+	ar & make_nvp("file", mFile);
+}
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_IMPLEMENT(redman::backend::SQLiteBackend)
+
+#include "boost/serialization/serialization_helper.tcc"
+EXPLICIT_INSTANTIATE_BOOST_SERIALIZE(redman::backend::SQLiteBackend)
+
+extern "C" {
+
+backend_t* createBackend()
+{
+	return new redman::backend::SQLiteBackend();
+}
+
+void destroyBackend(backend_t* backend)
+{
+	delete backend;
+}
+
+} // extern "C"
@@ -5,8 +5,14 @@
 
 #include "redman/backend/interface.h"
 
+#include <fstream>
 #include <stdexcept>
 #include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include "redman/AtomicFile.h"
+#include "redman/backend/Compression.h"
 
 #include "boost/serialization/path.h"
 #include <boost/serialization/nvp.hpp>
@@ -43,6 +49,7 @@ void XMLBackend::init()
 			throw std::runtime_error(err);
 		}
 	}
+	check_compression();
 }
 
 void XMLBackend::load(std::string const& id, Base& res)
@@ -53,7 +60,12 @@ void XMLBackend::load(std::string const& id, Base& res)
 		throw not_found_error("data set not found: " + file.native());
 	}
 
-	std::fstream stream(file.string(), std::ios::in | std::ios::binary);
+	std::ifstream file_stream(file.string(), std::ios::in | std::ios::binary);
+	if (!file_stream)
+		throw std::runtime_error("unable to read: " + file.native());
+	std::string const content(
+		(std::istreambuf_iterator<char>(file_stream)), std::istreambuf_iterator<char>());
+	std::istringstream stream(Compression::decompress(content));
 
 	boost::archive::xml_iarchive ia(stream);
 
@@ -64,12 +76,19 @@ void XMLBackend::load(std::string const& id, Base& res)
 
 void XMLBackend::store(std::string const& id, Base const& res)
 {
-	auto file = getFilename(id);
-	std::fstream stream(file.string(), std::ios::out | std::ios::binary);
+	std::ostringstream stream;
+	{
+		boost::archive::xml_oarchive oa(stream);
+		boost::shared_ptr<Base const> ptr(&res, boost::serialization::null_deleter());
+		oa << boost::serialization::make_nvp("data", ptr);
+	}
+	// readers never see partial files
+	redman::detail::replace_file(getFilename(id).string(), compression().compress(stream.str()));
+}
 
-	boost::archive::xml_oarchive oa(stream);
-	boost::shared_ptr<Base const> ptr(&res, boost::serialization::null_deleter());
-	oa << boost::serialization::make_nvp("data", ptr);
+std::string XMLBackend::revision(std::string const& id) const
+{
+	return file_revision(getFilename(id).string());
 }
 
 XMLBackend::path
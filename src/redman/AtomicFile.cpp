@@ -0,0 +1,70 @@
+#include "redman/AtomicFile.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace redman {
+namespace detail {
+
+namespace {
+
+/// Exclusively create a temporary file next to `file`, returns its fd.
+int create_temporary(std::string const& file, std::string& tmp)
+{
+	static std::atomic<unsigned long> counter(0);
+	for (;;) {
+		tmp = file + ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter++);
+		// new files get 0666 restricted by the umask, like any other file
+		int const fd = open(tmp.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0666);
+		if (fd >= 0 || errno != EEXIST)
+			return fd;
+		// left over by a crashed process that had the same pid
+	}
+}
+
+} // anonymous
+
+void replace_file(std::string const& file, std::string const& content)
+{
+	std::string tmp;
+	int const fd = create_temporary(file, tmp);
+	if (fd < 0)
+		throw std::runtime_error("unable to write: " + file + ": " + std::strerror(errno));
+
+	// keep the mode of the replaced file
+	struct stat info;
+	bool ok = stat(file.c_str(), &info) != 0 || fchmod(fd, info.st_mode & 07777) == 0;
+
+	char const* data = content.data();
+	size_t left = content.size();
+	while (ok && left > 0) {
+		ssize_t const written = ::write(fd, data, left);
+		if (written < 0 && errno == EINTR)
+			continue;
+		ok = written > 0;
+		if (ok) {
+			data += written;
+			left -= written;
+		}
+	}
+	// the content has to be on disk before the rename makes it visible
+	ok = ok && fsync(fd) == 0;
+	int const error = ok ? 0 : errno;
+	if (close(fd) != 0)
+		ok = false;
+	if (!ok || std::rename(tmp.c_str(), file.c_str()) != 0) {
+		std::string const reason = std::strerror(error ? error : errno);
+		unlink(tmp.c_str());
+		throw std::runtime_error("unable to write: " + file + ": " + reason);
+	}
+}
+
+} // detail
+} // redman
@@ -0,0 +1,66 @@
+#include "redman/ThreadPool.h"
+
+#include <algorithm>
+
+namespace redman {
+namespace detail {
+
+ThreadPool::ThreadPool(size_t threads)
+	: mWorkers(), mQueue(), mMutex(), mPending(), mStopping(false)
+{
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	mWorkers.reserve(threads);
+	for (size_t ii = 0; ii < threads; ++ii)
+		mWorkers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mPending.notify_all();
+	for (auto& worker : mWorkers)
+		worker.join();
+}
+
+size_t ThreadPool::size() const
+{
+	return mWorkers.size();
+}
+
+void ThreadPool::push(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQueue.push_back(std::move(job));
+	}
+	mPending.notify_one();
+}
+
+void ThreadPool::work()
+{
+	for (;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mPending.wait(lock, [this]() { return mStopping || !mQueue.empty(); });
+			if (mQueue.empty())
+				return;
+			job = std::move(mQueue.front());
+			mQueue.pop_front();
+		}
+		job();
+	}
+}
+
+ThreadPool& io_pool()
+{
+	static ThreadPool pool(std::max(4u, std::thread::hardware_concurrency()));
+	return pool;
+}
+
+} // detail
+} // redman
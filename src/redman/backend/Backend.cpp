@@ -1,8 +1,12 @@
+#include <limits>
 #include <stdexcept>
 #include <sstream>
 #include <dlfcn.h>
+#include <sys/stat.h>
 
+#include "redman/ThreadPool.h"
 #include "redman/backend/Backend.h"
+#include "redman/backend/Compression.h"
 #include "redman/backend/Library.h"
 #include "redman/backend/BackendDeleter.h"
 
@@ -47,12 +51,122 @@ void Backend::config_(
 	}
 }
 
+std::string Backend::revision(std::string const&) const
+{
+	return std::string();
+}
+
+std::future<void> Backend::load_async(std::string const& id, resources::Base& res)
+{
+	return redman::detail::io_pool().submit([this, id, &res]() { load(id, res); });
+}
+
+std::future<void> Backend::store_async(std::string const& id, resources::Base const& res)
+{
+	return redman::detail::io_pool().submit([this, id, &res]() { store(id, res); });
+}
+
+std::vector<bool> Backend::load_many(
+	std::vector<std::string> const& ids,
+	std::vector<resources::Base*> const& resources)
+{
+	if (ids.size() != resources.size())
+		throw std::invalid_argument("load_many: number of ids and resources differ");
+
+	std::vector<bool> found(ids.size(), true);
+	for (size_t ii = 0; ii < ids.size(); ++ii) {
+		try {
+			load(ids[ii], *resources[ii]);
+		} catch (not_found_error const&) {
+			found[ii] = false;
+		}
+	}
+	return found;
+}
+
+void Backend::store_many(
+	std::vector<std::string> const& ids,
+	std::vector<resources::Base const*> const& resources)
+{
+	if (ids.size() != resources.size())
+		throw std::invalid_argument("store_many: number of ids and resources differ");
+
+	for (size_t ii = 0; ii < ids.size(); ++ii)
+		store(ids[ii], *resources[ii]);
+}
+
 bool Backend::exists(std::string const& key) const
 {
 	auto it = mConfig.find(key);
 	return (it != mConfig.end());
 }
 
+Compression Backend::compression() const
+{
+	if (!exists("compression"))
+		return Compression();
+	int level = Compression::default_level;
+	if (exists("compression_level")) {
+		auto const& value = mConfig.at("compression_level");
+		if (auto const number = boost::get<int>(&value)) {
+			level = *number;
+		} else {
+			// also accept levels configured as string, e.g. from config files
+			auto const& text = boost::get<std::string>(value);
+			size_t parsed = 0;
+			try {
+				level = std::stoi(text, &parsed);
+			} catch (std::exception const&) {
+				parsed = 0;
+			}
+			if (parsed == 0 || parsed != text.size())
+				throw std::invalid_argument("compression_level is not an integer: " + text);
+		}
+	}
+	return Compression(get<std::string>("compression"), level);
+}
+
+void Backend::check_compression() const
+{
+	compression();
+}
+
+size_t Backend::get_size(std::string const& key) const
+{
+	auto const& value = mConfig.at(key);
+	if (auto const number = boost::get<int>(&value)) {
+		if (*number < 0)
+			throw std::invalid_argument(key + " is negative: " + std::to_string(*number));
+		return *number;
+	}
+	// strings allow sizes beyond the range of int, e.g. from config files
+	auto const& text = boost::get<std::string>(value);
+	size_t parsed = 0;
+	unsigned long long size = 0;
+	try {
+		// std::stoull() accepts and negates a leading minus
+		if (text.find('-') == std::string::npos)
+			size = std::stoull(text, &parsed);
+	} catch (std::exception const&) {
+		parsed = 0;
+	}
+	if (parsed == 0 || parsed != text.size()
+		|| size > std::numeric_limits<size_t>::max())
+		throw std::invalid_argument(key + " is not a size: " + text);
+	return size;
+}
+
+std::string Backend::file_revision(std::string const& file)
+{
+	struct stat info;
+	if (stat(file.c_str(), &info) != 0)
+		return "-";
+	std::ostringstream revision;
+	revision << info.st_dev << ':' << info.st_ino << ':' << info.st_size << ':'
+	         << info.st_mtim.tv_sec << '.' << info.st_mtim.tv_nsec;
+	return revision.str();
+}
+
 
 boost::shared_ptr<Backend>
 loadBackend(boost::shared_ptr<Library> lib)
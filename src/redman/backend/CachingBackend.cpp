@@ -0,0 +1,246 @@
+#include "redman/backend/CachingBackend.h"
+
+#include <stdexcept>
+
+#include "redman/backend/Serialization.h"
+#include "redman/resources/Base.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+
+using namespace redman::resources;
+
+namespace redman {
+namespace backend {
+
+CacheStatistics::CacheStatistics() :
+	hits(0), misses(0), invalidations(0), evictions(0), entries(0), bytes(0) {}
+
+size_t const CachingBackend::default_capacity = 64 << 20;
+
+CachingBackend::CachingBackend(boost::shared_ptr<Backend> backend) :
+	mBackend(backend), mCapacity(default_capacity), mGeneration(0)
+{
+	if (!mBackend)
+		throw std::invalid_argument("CachingBackend requires a backend");
+}
+
+CachingBackend::CachingBackend() :
+	mBackend(), mCapacity(default_capacity), mGeneration(0) {}
+
+CachingBackend::~CachingBackend() {}
+
+void CachingBackend::init()
+{
+	if (exists("cache_size"))
+		mCapacity = get_size("cache_size");
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	shrink();
+}
+
+void CachingBackend::load(std::string const& id, Base& res)
+{
+	// taken before loading, a concurrent change makes the entry stale
+	auto const current = mBackend->revision(id);
+	size_t generation;
+	if (lookup(id, current, res, generation))
+		return;
+
+	mBackend->load(id, res);
+	insert(id, current, res, generation);
+}
+
+void CachingBackend::store(std::string const& id, Base const& res)
+{
+	store_many({id}, {&res});
+}
+
+std::string CachingBackend::revision(std::string const& id) const
+{
+	return mBackend->revision(id);
+}
+
+std::vector<bool> CachingBackend::load_many(
+	std::vector<std::string> const& ids,
+	std::vector<Base*> const& resources)
+{
+	if (ids.size() != resources.size())
+		throw std::invalid_argument("load_many: number of ids and resources differ");
+
+	std::vector<bool> found(ids.size(), true);
+	std::vector<size_t> missing;
+	std::vector<std::string> revisions;
+	std::vector<size_t> generations;
+	for (size_t ii = 0; ii < ids.size(); ++ii) {
+		auto current = mBackend->revision(ids[ii]);
+		size_t generation;
+		if (lookup(ids[ii], current, *resources[ii], generation))
+			continue;
+		missing.push_back(ii);
+		revisions.push_back(std::move(current));
+		generations.push_back(generation);
+	}
+	if (missing.empty())
+		return found;
+
+	std::vector<std::string> missing_ids;
+	std::vector<Base*> missing_resources;
+	for (auto const ii : missing) {
+		missing_ids.push_back(ids[ii]);
+		missing_resources.push_back(resources[ii]);
+	}
+
+	auto const loaded = mBackend->load_many(missing_ids, missing_resources);
+	for (size_t jj = 0; jj < missing.size(); ++jj) {
+		found[missing[jj]] = loaded[jj];
+		if (loaded[jj])
+			insert(missing_ids[jj], revisions[jj], *missing_resources[jj], generations[jj]);
+	}
+	return found;
+}
+
+void CachingBackend::store_many(
+	std::vector<std::string> const& ids,
+	std::vector<Base const*> const& resources)
+{
+	try {
+		mBackend->store_many(ids, resources);
+	} catch (...) {
+		invalidate(ids);
+		throw;
+	}
+	invalidate(ids);
+}
+
+boost::shared_ptr<Backend> CachingBackend::backend() const
+{
+	return mBackend;
+}
+
+void CachingBackend::invalidate(std::string const& id)
+{
+	invalidate(std::vector<std::string>{id});
+}
+
+void CachingBackend::clear()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	++mGeneration;
+	mEntries.clear();
+	mIndex.clear();
+	mStatistics.entries = 0;
+	mStatistics.bytes = 0;
+}
+
+CacheStatistics CachingBackend::statistics() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStatistics;
+}
+
+void CachingBackend::reset_statistics()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStatistics.hits = 0;
+	mStatistics.misses = 0;
+	mStatistics.invalidations = 0;
+	mStatistics.evictions = 0;
+}
+
+bool CachingBackend::lookup(
+	std::string const& id, std::string const& revision, Base& res, size_t& generation)
+{
+	std::string payload;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		generation = mGeneration;
+		auto const it = mIndex.find(id);
+		if (it == mIndex.end()) {
+			++mStatistics.misses;
+			return false;
+		}
+		if (it->second->revision != revision) {
+			erase(it);
+			++mStatistics.invalidations;
+			++mStatistics.misses;
+			return false;
+		}
+		mEntries.splice(mEntries.begin(), mEntries, it->second);
+		payload = it->second->payload;
+		++mStatistics.hits;
+	}
+
+	deserialize_resource(payload, res);
+	return true;
+}
+
+void CachingBackend::insert(
+	std::string const& id, std::string const& revision, Base const& res, size_t generation)
+{
+	Entry entry{id, revision, serialize_resource(res)};
+	if (entry.payload.size() > mCapacity)
+		return;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	// stored or invalidated while loading, the payload may be outdated
+	if (generation != mGeneration)
+		return;
+	auto const it = mIndex.find(id);
+	if (it != mIndex.end())
+		erase(it);
+	mStatistics.bytes += entry.payload.size();
+	++mStatistics.entries;
+	mEntries.push_front(std::move(entry));
+	mIndex[id] = mEntries.begin();
+	shrink();
+}
+
+void CachingBackend::invalidate(std::vector<std::string> const& ids)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	++mGeneration;
+	for (auto const& id : ids) {
+		auto const it = mIndex.find(id);
+		if (it == mIndex.end())
+			continue;
+		erase(it);
+		++mStatistics.invalidations;
+	}
+}
+
+void CachingBackend::shrink()
+{
+	while (mStatistics.bytes > mCapacity) {
+		erase(mIndex.find(mEntries.back().id));
+		++mStatistics.evictions;
+	}
+}
+
+void CachingBackend::erase(index_type::iterator it)
+{
+	mStatistics.bytes -= it->second->payload.size();
+	--mStatistics.entries;
+	mEntries.erase(it->second);
+	mIndex.erase(it);
+}
+
+template<typename Archiver>
+void CachingBackend::serialize(Archiver& ar, unsigned int const)
+{
+	using boost::serialization::make_nvp;
+	ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Backend);
+	ar & make_nvp("backend", mBackend);
+	ar & make_nvp("capacity", mCapacity);
+}
+
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_IMPLEMENT(redman::backend::CachingBackend)
+
+#include "boost/serialization/serialization_helper.tcc"
+EXPLICIT_INSTANTIATE_BOOST_SERIALIZE(redman::backend::CachingBackend)
@@ -0,0 +1,112 @@
+#include "redman/backend/Compression.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace redman {
+namespace backend {
+
+namespace {
+
+// window bits for zlib, +16 selects the gzip format, +32 detects it on inflate
+int const gzip_window = 15 + 16;
+int const detect_window = 15 + 32;
+
+size_t const chunk_size = 1 << 16;
+
+} // anonymous
+
+int const Compression::default_level = 6;
+
+Compression::Compression() : mMethod(NONE), mLevel(default_level) {}
+
+Compression::Compression(Method method, int level) : mMethod(method), mLevel(level)
+{
+	if (level < 0 || level > 9)
+		throw std::invalid_argument("compression level out of range [0, 9]: " + std::to_string(level));
+}
+
+Compression::Compression(std::string const& method, int level) : Compression(NONE, level)
+{
+	if (method == "zlib" || method == "gzip")
+		mMethod = ZLIB;
+	else if (method != "none" && !method.empty())
+		throw std::invalid_argument("unsupported compression: " + method);
+}
+
+Compression::Method Compression::method() const
+{
+	return mMethod;
+}
+
+int Compression::level() const
+{
+	return mLevel;
+}
+
+std::string Compression::compress(std::string const& data) const
+{
+	if (mMethod == NONE)
+		return data;
+
+	z_stream stream = {};
+	if (deflateInit2(&stream, mLevel, Z_DEFLATED, gzip_window, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		throw std::runtime_error("unable to initialize compression");
+
+	std::string result(deflateBound(&stream, data.size()), '\0');
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	stream.avail_in = data.size();
+	stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+	stream.avail_out = result.size();
+	int const rc = deflate(&stream, Z_FINISH);
+	result.resize(stream.total_out);
+	deflateEnd(&stream);
+	if (rc != Z_STREAM_END)
+		throw std::runtime_error("compression failed");
+	return result;
+}
+
+bool Compression::is_compressed(std::string const& data)
+{
+	return data.size() >= 2 &&
+		static_cast<unsigned char>(data[0]) == 0x1f &&
+		static_cast<unsigned char>(data[1]) == 0x8b;
+}
+
+std::string Compression::decompress(std::string const& data)
+{
+	if (!is_compressed(data))
+		return data;
+
+	z_stream stream = {};
+	if (inflateInit2(&stream, detect_window) != Z_OK)
+		throw std::runtime_error("unable to initialize decompression");
+
+	std::string result;
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	stream.avail_in = data.size();
+	int rc = Z_OK;
+	while (rc != Z_STREAM_END) {
+		size_t const offset = result.size();
+		result.resize(offset + std::max(chunk_size, data.size() * 4));
+		stream.next_out = reinterpret_cast<Bytef*>(&result[offset]);
+		stream.avail_out = result.size() - offset;
+		rc = inflate(&stream, Z_NO_FLUSH);
+		if (rc != Z_OK && rc != Z_STREAM_END) {
+			inflateEnd(&stream);
+			throw std::runtime_error("corrupt compressed data");
+		}
+		if (rc == Z_OK && stream.avail_in == 0 && stream.avail_out != 0) {
+			inflateEnd(&stream);
+			throw std::runtime_error("truncated compressed data");
+		}
+	}
+	result.resize(stream.total_out);
+	inflateEnd(&stream);
+	return result;
+}
+
+} // backend
+} // redman
@@ -0,0 +1,203 @@
+#include "redman/backend/OverlayBackend.h"
+
+#include <memory>
+#include <stdexcept>
+
+#include "redman/resources/Fpga.h"
+#include "redman/resources/Hicann.h"
+#include "redman/resources/Wafer.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+
+using namespace redman::resources;
+
+namespace redman {
+namespace backend {
+
+namespace {
+
+template <typename Resource>
+bool combine_as(OverlayBackend::Mode mode, Base& res, Base const& layer)
+{
+	auto const target = dynamic_cast<Resource*>(&res);
+	if (!target)
+		return false;
+	auto const& other = dynamic_cast<Resource const&>(layer);
+	if (mode == OverlayBackend::INTERSECTION)
+		target->intersection(other);
+	else
+		target->merge(other);
+	return true;
+}
+
+/// Combine the data set of a lower layer into `res`.
+void combine(OverlayBackend::Mode mode, Base& res, Base const& layer)
+{
+	if (!combine_as<Hicann>(mode, res, layer) && !combine_as<Fpga>(mode, res, layer) &&
+	    !combine_as<Wafer>(mode, res, layer))
+		throw std::invalid_argument("OverlayBackend can not combine this resource type");
+}
+
+/// Empty resource of the type of `res` to load a lower layer into.
+std::unique_ptr<Base> make_like(Base const& res)
+{
+	if (dynamic_cast<Hicann const*>(&res))
+		return std::unique_ptr<Base>(new Hicann);
+	if (dynamic_cast<Fpga const*>(&res))
+		return std::unique_ptr<Base>(new Fpga);
+	if (dynamic_cast<Wafer const*>(&res))
+		return std::unique_ptr<Base>(new Wafer);
+	throw std::invalid_argument("OverlayBackend can not combine this resource type");
+}
+
+} // anonymous
+
+OverlayBackend::OverlayBackend() :
+	mLayers(), mMode(FIRST) {}
+
+OverlayBackend::OverlayBackend(std::vector<boost::shared_ptr<Backend> > const& layers) :
+	mLayers(), mMode(FIRST)
+{
+	for (auto const& layer : layers)
+		add_layer(layer);
+}
+
+OverlayBackend::~OverlayBackend() {}
+
+void OverlayBackend::init()
+{
+	if (mLayers.empty())
+		throw std::runtime_error("OverlayBackend needs at least one layer");
+
+	mMode = FIRST;
+	if (exists("mode")) {
+		auto const& mode = get<std::string>("mode");
+		if (mode == "intersection")
+			mMode = INTERSECTION;
+		else if (mode == "merge")
+			mMode = MERGE;
+		else if (mode != "first")
+			throw std::invalid_argument("unknown overlay mode: " + mode);
+	}
+}
+
+void OverlayBackend::load(std::string const& id, Base& res)
+{
+	if (load_many({id}, {&res}).front())
+		return;
+	throw not_found_error("data set not found in any layer: " + id);
+}
+
+void OverlayBackend::store(std::string const& id, Base const& res)
+{
+	top().store(id, res);
+}
+
+std::string OverlayBackend::revision(std::string const& id) const
+{
+	std::string res;
+	for (auto const& layer : mLayers) {
+		auto const current = layer->revision(id);
+		if (current.empty())
+			return std::string();
+		res += current + "|";
+	}
+	return res;
+}
+
+std::vector<bool> OverlayBackend::load_many(
+	std::vector<std::string> const& ids,
+	std::vector<Base*> const& resources)
+{
+	if (ids.size() != resources.size())
+		throw std::invalid_argument("load_many: number of ids and resources differ");
+	top();
+
+	std::vector<bool> found(ids.size(), false);
+	for (auto const& layer : mLayers) {
+		// data sets not found yet are loaded directly into the resources,
+		// found ones into temporaries to be combined afterwards
+		std::vector<size_t> indices;
+		std::vector<std::string> layer_ids;
+		std::vector<Base*> targets;
+		std::vector<std::unique_ptr<Base> > temporaries;
+		for (size_t ii = 0; ii < ids.size(); ++ii) {
+			if (found[ii] && mMode == FIRST)
+				continue;
+			indices.push_back(ii);
+			layer_ids.push_back(ids[ii]);
+			if (found[ii]) {
+				temporaries.push_back(make_like(*resources[ii]));
+				targets.push_back(temporaries.back().get());
+			} else {
+				targets.push_back(resources[ii]);
+			}
+		}
+		if (indices.empty())
+			break;
+
+		auto const loaded = layer->load_many(layer_ids, targets);
+		for (size_t jj = 0; jj < indices.size(); ++jj) {
+			size_t const ii = indices[jj];
+			if (!loaded[jj])
+				continue;
+			if (found[ii])
+				combine(mMode, *resources[ii], *targets[jj]);
+			found[ii] = true;
+		}
+	}
+	return found;
+}
+
+void OverlayBackend::store_many(
+	std::vector<std::string> const& ids,
+	std::vector<Base const*> const& resources)
+{
+	top().store_many(ids, resources);
+}
+
+void OverlayBackend::add_layer(boost::shared_ptr<Backend> layer)
+{
+	if (!layer)
+		throw std::invalid_argument("OverlayBackend layer must not be null");
+	mLayers.push_back(layer);
+}
+
+std::vector<boost::shared_ptr<Backend> > const& OverlayBackend::layers() const
+{
+	return mLayers;
+}
+
+OverlayBackend::Mode OverlayBackend::mode() const
+{
+	return mMode;
+}
+
+Backend& OverlayBackend::top() const
+{
+	if (mLayers.empty())
+		throw std::runtime_error("OverlayBackend needs at least one layer");
+	return *mLayers.front();
+}
+
+template<typename Archiver>
+void OverlayBackend::serialize(Archiver& ar, unsigned int const)
+{
+	using boost::serialization::make_nvp;
+	ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Backend);
+	ar & make_nvp("layers", mLayers);
+	ar & make_nvp("mode", mMode);
+}
+
+} // backend
+} // redman
+
+BOOST_CLASS_EXPORT_IMPLEMENT(redman::backend::OverlayBackend)
+
+#include "boost/serialization/serialization_helper.tcc"
+EXPLICIT_INSTANTIATE_BOOST_SERIALIZE(redman::backend::OverlayBackend)
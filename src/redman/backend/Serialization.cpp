@@ -0,0 +1,46 @@
+#include "redman/backend/Serialization.h"
+
+#include <sstream>
+
+#include "redman/backend/Compression.h"
+#include "redman/resources/Base.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+
+using namespace redman::resources;
+
+namespace redman {
+namespace backend {
+
+void save_resource(std::ostream& stream, Base const& res)
+{
+	boost::archive::binary_oarchive oa(stream);
+	boost::shared_ptr<Base const> ptr(&res, boost::serialization::null_deleter());
+	oa << ptr;
+}
+
+void load_resource(std::istream& stream, Base& res)
+{
+	boost::archive::binary_iarchive ia(stream);
+	boost::shared_ptr<Base const> ptr;
+	ia >> ptr;
+	res.copy(*ptr);
+}
+
+std::string serialize_resource(Base const& res)
+{
+	std::ostringstream os;
+	save_resource(os, res);
+	return os.str();
+}
+
+void deserialize_resource(std::string const& payload, Base& res)
+{
+	std::istringstream is(Compression::decompress(payload));
+	load_resource(is, res);
+}
+
+} // backend
+} // redman
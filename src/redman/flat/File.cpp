@@ -0,0 +1,240 @@
+#include "redman/flat/File.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "redman/AtomicFile.h"
+#include "redman/storage/kernels.h"
+
+namespace redman {
+namespace flat {
+
+char const magic[8] = {'r', 'e', 'd', 'm', 'a', 'n', 'f', 'l'};
+
+namespace {
+
+struct Unmap
+{
+	std::size_t size;
+
+	void operator()(void const* data) const
+	{
+		munmap(const_cast<void*>(data), size);
+	}
+};
+
+std::size_t aligned(std::size_t offset)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+std::size_t bitmap_words(std::uint32_t index_size)
+{
+	return (index_size + 63) / 64;
+}
+
+} // anonymous
+
+MappedResource::MappedResource(std::string const& filename)
+	: mMapping(), mData(nullptr), mSize(0), mHeader(nullptr), mSections(nullptr)
+{
+	int const fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		throw std::runtime_error("unable to open flat file: " + filename);
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		::close(fd);
+		throw std::runtime_error("unable to stat flat file: " + filename);
+	}
+	mSize = static_cast<std::size_t>(info.st_size);
+	if (mSize < sizeof(FileHeader)) {
+		::close(fd);
+		throw std::runtime_error("not a redman flat file: " + filename);
+	}
+
+	void* const data = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+		throw std::runtime_error("unable to map flat file: " + filename);
+	mMapping.reset(data, Unmap{mSize});
+	mData = static_cast<char const*>(data);
+
+	mHeader = reinterpret_cast<FileHeader const*>(mData);
+	if (std::memcmp(mHeader->magic, magic, sizeof(magic)) != 0)
+		throw std::runtime_error("not a redman flat file: " + filename);
+	if (mHeader->byte_order != byte_order_mark)
+		throw std::runtime_error("redman flat file has foreign byte order: " + filename);
+	if (mHeader->version > format_version)
+		throw std::runtime_error(
+			"unsupported redman flat format version " + std::to_string(mHeader->version) +
+			": " + filename);
+
+	std::size_t const table_end =
+		sizeof(FileHeader) + std::size_t(mHeader->sections) * sizeof(SectionEntry);
+	if (table_end > mSize)
+		throw std::runtime_error("truncated redman flat file: " + filename);
+	mSections = reinterpret_cast<SectionEntry const*>(mData + sizeof(FileHeader));
+
+	for (std::uint32_t ii = 0; ii < mHeader->sections; ++ii) {
+		SectionEntry const& entry = mSections[ii];
+		std::size_t bytes = 0;
+		if (entry.encoding == Encoding::BITMAP) {
+			if (entry.length != bitmap_words(entry.index_size))
+				throw std::runtime_error("corrupt bitmap in redman flat file: " + filename);
+			bytes = entry.length * sizeof(std::uint64_t);
+		} else if (entry.encoding == Encoding::RUNS) {
+			// lengths and offsets are read from the file, avoid overflows
+			if (entry.length > mSize / (2 * sizeof(std::uint32_t)))
+				throw std::runtime_error("corrupt runs in redman flat file: " + filename);
+			bytes = entry.length * 2 * sizeof(std::uint32_t);
+		} else {
+			throw std::runtime_error("unknown encoding in redman flat file: " + filename);
+		}
+		if (std::find(entry.name, entry.name + sizeof(entry.name), '\0') ==
+		        entry.name + sizeof(entry.name) ||
+		    entry.offset % alignment != 0 || entry.offset < table_end ||
+		    entry.offset > mSize || bytes > mSize - entry.offset)
+			throw std::runtime_error("corrupt section in redman flat file: " + filename);
+
+		// views report the stored count, it has to match the payload
+		std::uint64_t count = 0;
+		if (entry.encoding == Encoding::RUNS) {
+			// views rely on sorted, disjoint runs within the index range
+			auto const runs = reinterpret_cast<std::uint32_t const*>(mData + entry.offset);
+			std::uint32_t last = 0;
+			for (std::size_t run = 0; run < entry.length; ++run) {
+				if (runs[2 * run] < last || runs[2 * run] >= runs[2 * run + 1] ||
+				    runs[2 * run + 1] > entry.index_size)
+					throw std::runtime_error("corrupt runs in redman flat file: " + filename);
+				last = runs[2 * run + 1];
+				count += runs[2 * run + 1] - runs[2 * run];
+			}
+		} else {
+			// bits beyond the index range must not be set
+			auto const words = reinterpret_cast<std::uint64_t const*>(mData + entry.offset);
+			count = storage::kernels::popcount(words, entry.length);
+			std::uint32_t const tail = entry.index_size % 64;
+			if (tail && (words[entry.length - 1] >> tail))
+				throw std::runtime_error("corrupt bitmap in redman flat file: " + filename);
+		}
+		if (count != entry.count)
+			throw std::runtime_error("corrupt count in redman flat file: " + filename);
+	}
+}
+
+MappedResource::~MappedResource()
+{
+}
+
+boost::shared_ptr<MappedResource const> MappedResource::open(std::string const& filename)
+{
+	return boost::shared_ptr<MappedResource const>(new MappedResource(filename));
+}
+
+std::vector<std::string> MappedResource::components() const
+{
+	std::vector<std::string> res;
+	for (std::uint32_t ii = 0; ii < mHeader->sections; ++ii)
+		res.push_back(mSections[ii].name);
+	return res;
+}
+
+bool MappedResource::has_component(std::string const& name) const
+{
+	return find(name) != nullptr;
+}
+
+SectionEntry const* MappedResource::find(std::string const& name) const
+{
+	for (std::uint32_t ii = 0; ii < mHeader->sections; ++ii) {
+		if (name == mSections[ii].name)
+			return &mSections[ii];
+	}
+	return nullptr;
+}
+
+SectionEntry const& MappedResource::section(std::string const& name) const
+{
+	if (auto const entry = find(name))
+		return *entry;
+	throw std::out_of_range("no component " + name + " in redman flat file");
+}
+
+void Writer::write(std::string const& filename) const
+{
+	std::vector<SectionEntry> entries(mSections.size());
+	std::vector<std::vector<char> > payloads(mSections.size());
+
+	std::size_t offset = aligned(sizeof(FileHeader) + entries.size() * sizeof(SectionEntry));
+	for (std::size_t ii = 0; ii < mSections.size(); ++ii) {
+		Section const& section = mSections[ii];
+		SectionEntry& entry = entries[ii];
+		if (section.name.size() >= sizeof(entry.name))
+			throw std::invalid_argument("component name too long for flat file: " + section.name);
+		std::memset(&entry, 0, sizeof(entry));
+		std::strcpy(entry.name, section.name.c_str());
+		entry.index_size = section.index_size;
+		entry.flags = section.has_value ? std::uint32_t(SectionEntry::HAS_VALUE) : std::uint32_t(0);
+		entry.count = section.indices.size();
+
+		std::vector<std::uint32_t> indices = section.indices;
+		std::sort(indices.begin(), indices.end());
+
+		std::vector<std::uint32_t> runs;
+		for (auto const idx : indices) {
+			if (!runs.empty() && runs.back() == idx)
+				++runs.back();
+			else {
+				runs.push_back(idx);
+				runs.push_back(idx + 1);
+			}
+		}
+
+		// store whichever encoding is smaller
+		std::size_t const words = bitmap_words(section.index_size);
+		std::vector<char>& payload = payloads[ii];
+		if (runs.size() * sizeof(std::uint32_t) < words * sizeof(std::uint64_t)) {
+			entry.encoding = Encoding::RUNS;
+			entry.length = runs.size() / 2;
+			payload.resize(runs.size() * sizeof(std::uint32_t));
+			std::memcpy(payload.data(), runs.data(), payload.size());
+		} else {
+			entry.encoding = Encoding::BITMAP;
+			entry.length = words;
+			std::vector<std::uint64_t> bitmap(words, 0);
+			for (auto const idx : indices)
+				bitmap[idx / 64] |= std::uint64_t(1) << (idx % 64);
+			payload.resize(words * sizeof(std::uint64_t));
+			std::memcpy(payload.data(), bitmap.data(), payload.size());
+		}
+		entry.offset = offset;
+		offset = aligned(offset + payload.size());
+	}
+
+	FileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = format_version;
+	header.byte_order = byte_order_mark;
+	header.sections = static_cast<std::uint32_t>(entries.size());
+
+	std::string content(reinterpret_cast<char const*>(&header), sizeof(header));
+	content.append(reinterpret_cast<char const*>(entries.data()),
+	               entries.size() * sizeof(SectionEntry));
+	for (std::size_t ii = 0; ii < payloads.size(); ++ii) {
+		content.resize(entries[ii].offset, '\0');
+		content.append(payloads[ii].data(), payloads[ii].size());
+	}
+	// mapped readers never see partial files
+	redman::detail::replace_file(filename, content);
+}
+
+} // flat
+} // redman
@@ -7,6 +7,7 @@
 
 #include "halco/hicann/v2/external.h"
 
+#include "redman/ThreadPool.h"
 #include "redman/resources/Fpga.h"
 #include "redman/resources/components.h"
 
@@ -21,6 +22,10 @@ void Fpga::intersection(Fpga const& other) {
 	hslinks()->intersection(*other.hslinks());
 }
 
+void Fpga::merge(Fpga const& other) {
+	hslinks()->merge(*other.hslinks());
+}
+
 boost::shared_ptr<components::HighspeedLinksOnDNC> Fpga::hslinks()
 {
 	return mHSLinks;
@@ -31,6 +36,20 @@ boost::shared_ptr<components::HighspeedLinksOnDNC const> Fpga::hslinks() const
 	return mHSLinks;
 }
 
+boost::shared_ptr<Fpga> Fpga::clone() const
+{
+	auto res = boost::make_shared<Fpga>(*this);
+	res->mHSLinks = components::detail::clone(mHSLinks);
+	return res;
+}
+
+boost::shared_ptr<Fpga const> Fpga::freeze() const
+{
+	auto res = boost::make_shared<Fpga>(*this);
+	res->mHSLinks = components::detail::freeze(mHSLinks);
+	return res;
+}
+
 void Fpga::copy(Base const& rhs)
 {
 	*this = dynamic_cast<Fpga const&>(rhs);
@@ -80,10 +99,31 @@ void FpgaWithBackend::save() const
 	mBackend->store(id_for_backend(), *this);
 }
 
+std::future<void> FpgaWithBackend::save_async() const
+{
+	if (!mBackend)
+		throw std::runtime_error("Fpga needs backend to save data.");
+
+	return mBackend->store_async(id_for_backend(), *this);
+}
+
+std::future<boost::shared_ptr<FpgaWithBackend> > FpgaWithBackend::create_async(
+    boost::shared_ptr<backend::Backend> backend, FpgaWithBackend::id_type id, bool ignore_missing)
+{
+	return redman::detail::io_pool().submit([backend, id, ignore_missing]() {
+		return boost::make_shared<FpgaWithBackend>(backend, id, Fpga(), ignore_missing);
+	});
+}
+
 std::string FpgaWithBackend::id_for_backend() const
 {
-	return "fpga-" + std::to_string(mId.toWafer()) + "-" +
-	       std::to_string(mId.toFPGAOnWafer().toEnum().value());
+	return backend_id(mId);
+}
+
+std::string FpgaWithBackend::backend_id(id_type const& id)
+{
+	return "fpga-" + std::to_string(id.toWafer()) + "-" +
+	       std::to_string(id.toFPGAOnWafer().toEnum().value());
 }
 
 boost::shared_ptr<FpgaWithBackend> FpgaWithBackend::create(
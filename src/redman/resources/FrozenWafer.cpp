@@ -0,0 +1,55 @@
+#include "redman/resources/FrozenWafer.h"
+
+namespace redman {
+namespace resources {
+
+FrozenWafer::FrozenWafer(
+    id_type const& id,
+    boost::shared_ptr<components::Hicanns const> hicanns,
+    boost::shared_ptr<components::Fpgas const> fpgas,
+    hicann_resources&& hicann_resources,
+    fpga_resources&& fpga_resources)
+	: mId(id),
+	  mHicanns(hicanns),
+	  mFpgas(fpgas),
+	  mHicannResources(std::move(hicann_resources)),
+	  mFpgaResources(std::move(fpga_resources))
+{}
+
+FrozenWafer::id_type FrozenWafer::id() const
+{
+	return mId;
+}
+
+bool FrozenWafer::has(halco::hicann::v2::HICANNOnWafer const& h) const
+{
+	return mHicanns->has(h);
+}
+
+bool FrozenWafer::has(halco::hicann::v2::FPGAOnWafer const& f) const
+{
+	return mFpgas->has(f);
+}
+
+boost::shared_ptr<components::Hicanns const> FrozenWafer::hicanns() const
+{
+	return mHicanns;
+}
+
+boost::shared_ptr<components::Fpgas const> FrozenWafer::fpgas() const
+{
+	return mFpgas;
+}
+
+boost::shared_ptr<Hicann const> FrozenWafer::get(halco::hicann::v2::HICANNOnWafer const& h) const
+{
+	return mHicannResources[h.toEnum().value()];
+}
+
+boost::shared_ptr<Fpga const> FrozenWafer::get(halco::hicann::v2::FPGAOnWafer const& f) const
+{
+	return mFpgaResources[f.toEnum().value()];
+}
+
+} // resources
+} // redman
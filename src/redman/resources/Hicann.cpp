@@ -1,5 +1,6 @@
 #include <boost/make_shared.hpp>
 
+#include "redman/ThreadPool.h"
 #include "redman/resources/Hicann.h"
 
 namespace redman {
@@ -58,6 +59,89 @@ void Hicann::intersection(Hicann const& other) {
 	dncmergers()->intersection(*other.dncmergers());
 }
 
+void Hicann::merge(Hicann const& other) {
+	neurons()->merge(*other.neurons());
+	synapses()->merge(*other.synapses());
+	drivers()->merge(*other.drivers());
+	synaptic_inputs()->merge(*other.synaptic_inputs());
+	synapserows()->merge(*other.synapserows());
+	analogs()->merge(*other.analogs());
+	backgroundgenerators()->merge(*other.backgroundgenerators());
+	fgblocks()->merge(*other.fgblocks());
+	vrepeaters()->merge(*other.vrepeaters());
+	hrepeaters()->merge(*other.hrepeaters());
+	synapseswitches()->merge(*other.synapseswitches());
+	crossbarswitches()->merge(*other.crossbarswitches());
+	synapseswitchrows()->merge(*other.synapseswitchrows());
+	synapsearrays()->merge(*other.synapsearrays());
+
+	hbuses()->merge(*other.hbuses());
+	vbuses()->merge(*other.vbuses());
+
+	mergers0()->merge(*other.mergers0());
+	mergers1()->merge(*other.mergers1());
+	mergers2()->merge(*other.mergers2());
+	mergers3()->merge(*other.mergers3());
+	dncmergers()->merge(*other.dncmergers());
+}
+
+namespace {
+
+struct CloneComponent
+{
+	template<typename Component>
+	boost::shared_ptr<Component> operator()(boost::shared_ptr<Component> const& component) const {
+		return components::detail::clone(component);
+	}
+};
+
+struct FreezeComponent
+{
+	template<typename Component>
+	boost::shared_ptr<Component> operator()(boost::shared_ptr<Component> const& component) const {
+		return components::detail::freeze(component);
+	}
+};
+
+} // namespace
+
+template<typename Function>
+boost::shared_ptr<Hicann> Hicann::transform_components(Function const& f) const {
+	auto res = boost::make_shared<Hicann>(*this);
+	res->mNeurons = f(mNeurons);
+	res->mSynapses = f(mSynapses);
+	res->mDrivers = f(mDrivers);
+	res->mSynapticInputs = f(mSynapticInputs);
+	res->mSynapseRows = f(mSynapseRows);
+	res->mAnalogs = f(mAnalogs);
+	res->mBackgroundGenerators = f(mBackgroundGenerators);
+	res->mFGBlocks = f(mFGBlocks);
+	res->mVRepeaters = f(mVRepeaters);
+	res->mHRepeaters = f(mHRepeaters);
+	res->mSynapseSwitches = f(mSynapseSwitches);
+	res->mCrossbarSwitches = f(mCrossbarSwitches);
+	res->mSynapseSwitchRows = f(mSynapseSwitchRows);
+	res->mSynapseArrays = f(mSynapseArrays);
+
+	res->mHBuses = f(mHBuses);
+	res->mVBuses = f(mVBuses);
+
+	res->mMergers0 = f(mMergers0);
+	res->mMergers1 = f(mMergers1);
+	res->mMergers2 = f(mMergers2);
+	res->mMergers3 = f(mMergers3);
+	res->mDNCMergers = f(mDNCMergers);
+	return res;
+}
+
+boost::shared_ptr<Hicann> Hicann::clone() const {
+	return transform_components(CloneComponent());
+}
+
+boost::shared_ptr<Hicann const> Hicann::freeze() const {
+	return transform_components(FreezeComponent());
+}
+
 void Hicann::copy(Base const& rhs) {
 	*this = dynamic_cast<Hicann const&>(rhs);
 }
@@ -98,10 +182,31 @@ void HicannWithBackend::save() {
 	mBackend->store(id_for_backend(), *this);
 }
 
+std::future<void> HicannWithBackend::save_async() {
+	if (!mBackend)
+		throw std::runtime_error("Hicann needs backend to save data.");
+
+	return mBackend->store_async(id_for_backend(), *this);
+}
+
+std::future<boost::shared_ptr<HicannWithBackend> > HicannWithBackend::create_async(
+		boost::shared_ptr<backend::Backend> backend,
+		halco::hicann::v2::HICANNGlobal id,
+		bool ignore_missing) {
+	return redman::detail::io_pool().submit([backend, id, ignore_missing]() {
+		return boost::make_shared<HicannWithBackend>(backend, id, Hicann(), ignore_missing);
+	});
+}
+
 std::string HicannWithBackend::id_for_backend() const
+{
+	return backend_id(mId);
+}
+
+std::string HicannWithBackend::backend_id(halco::hicann::v2::HICANNGlobal const& hicann)
 {
 	std::stringstream id;
-	id << "hicann-" << mId.toWafer() << "-" << mId.toHICANNOnWafer().toEnum();
+	id << "hicann-" << hicann.toWafer() << "-" << hicann.toHICANNOnWafer().toEnum();
 	return id.str();
 }
 
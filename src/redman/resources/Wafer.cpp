@@ -1,8 +1,11 @@
+#include <future>
 #include <sstream>
 
 #include <boost/make_shared.hpp>
 
+#include "redman/ThreadPool.h"
 #include "redman/resources/Wafer.h"
+#include "redman/resources/FrozenWafer.h"
 
 namespace redman {
 namespace resources {
@@ -31,6 +34,11 @@ void Wafer::intersection(Wafer const& other) {
 	fpgas()->intersection(*other.fpgas());
 }
 
+void Wafer::merge(Wafer const& other) {
+	hicanns()->merge(*other.hicanns());
+	fpgas()->merge(*other.fpgas());
+}
+
 void Wafer::copy(Base const& rhs) {
 	// copy used when loading via backend, need to manually
 	// restore backend we don't want to serialize it
@@ -42,6 +50,45 @@ void Wafer::copy(Base const& rhs) {
 	this->set_id(id);
 }
 
+boost::shared_ptr<Wafer> Wafer::clone() const {
+	auto res = boost::make_shared<Wafer>(*this);
+	res->mHicanns = components::detail::clone(mHicanns);
+	res->mFpgas = components::detail::clone(mFpgas);
+	mHicannResourceCache.for_each(
+	    [&res](halco::hicann::v2::HICANNOnWafer const& h, boost::shared_ptr<Hicann> const& hicann) {
+		    res->mHicannResourceCache.insert(h, hicann->clone());
+	    });
+	mFpgaResourceCache.for_each(
+	    [&res](halco::hicann::v2::FPGAOnWafer const& f, boost::shared_ptr<Fpga> const& fpga) {
+		    res->mFpgaResourceCache.insert(f, fpga->clone());
+	    });
+	return res;
+}
+
+boost::shared_ptr<FrozenWafer const> Wafer::freeze() const {
+	typedef redman::detail::ResourceIndex<halco::hicann::v2::HICANNOnWafer> hicann_index;
+	typedef redman::detail::ResourceIndex<halco::hicann::v2::FPGAOnWafer> fpga_index;
+
+	// only cached resources are frozen, skipping those get() would not return
+	FrozenWafer::hicann_resources hicanns(hicann_index::index_type::end);
+	mHicannResourceCache.for_each(
+	    [this, &hicanns](halco::hicann::v2::HICANNOnWafer const& h, boost::shared_ptr<Hicann> const& hicann) {
+		    if (mGetBehavior.ignore_hicann_missing || has(h))
+			    hicanns[hicann_index::get(h)] = hicann->freeze();
+	    });
+
+	FrozenWafer::fpga_resources fpgas(fpga_index::index_type::end);
+	mFpgaResourceCache.for_each(
+	    [this, &fpgas](halco::hicann::v2::FPGAOnWafer const& f, boost::shared_ptr<Fpga> const& fpga) {
+		    if (mGetBehavior.ignore_fpga_missing || has(f))
+			    fpgas[fpga_index::get(f)] = fpga->freeze();
+	    });
+
+	return boost::shared_ptr<FrozenWafer const>(new FrozenWafer(
+		mId, components::detail::freeze(mHicanns), components::detail::freeze(mFpgas),
+		std::move(hicanns), std::move(fpgas)));
+}
+
 boost::shared_ptr<Wafer> Wafer::create(id_type const& id) {
 	return boost::make_shared<Wafer>(id);
 }
@@ -106,21 +153,14 @@ boost::shared_ptr<Hicann> Wafer::get(halco::hicann::v2::HICANNOnWafer const& h)
 		return boost::shared_ptr<Hicann>();
 	}
 
-	auto it = mHicannResourceCache.find(h);
-	if (it != mHicannResourceCache.end()) {
-		return it->second;
-	}
-
-	if(mBackend) {
-		halco::hicann::v2::HICANNGlobal gh(h, mId);
-		auto tmp = HicannWithBackend(mBackend, gh, Hicann(), mBackendBehavior.ignore_hicann_missing);
-		auto res = boost::make_shared<Hicann>(tmp);
-		mHicannResourceCache.insert({h, res});
-		return res;
-	}
-	auto res = boost::make_shared<Hicann>();
-	mHicannResourceCache.insert({h, res});
-	return res;
+	return mHicannResourceCache.get(h, [this, &h]() {
+		if(mBackend) {
+			halco::hicann::v2::HICANNGlobal gh(h, mId);
+			auto tmp = HicannWithBackend(mBackend, gh, Hicann(), mBackendBehavior.ignore_hicann_missing);
+			return boost::make_shared<Hicann>(tmp);
+		}
+		return boost::make_shared<Hicann>();
+	});
 }
 
 boost::shared_ptr<Fpga> Wafer::get(halco::hicann::v2::FPGAOnWafer const& f) const
@@ -129,31 +169,189 @@ boost::shared_ptr<Fpga> Wafer::get(halco::hicann::v2::FPGAOnWafer const& f) cons
 		return boost::shared_ptr<Fpga>();
 	}
 
-	auto it = mFpgaResourceCache.find(f);
-	if (it != mFpgaResourceCache.end()) {
-		return it->second;
+	return mFpgaResourceCache.get(f, [this, &f]() {
+		if (mBackend) {
+			halco::hicann::v2::FPGAGlobal gh(f, mId);
+			auto tmp = FpgaWithBackend(mBackend, gh, Fpga(), mBackendBehavior.ignore_fpga_missing);
+			return boost::make_shared<Fpga>(tmp);
+		}
+		return boost::make_shared<Fpga>();
+	});
+}
+
+namespace {
+
+template<typename T>
+std::future<T> make_ready_future(T const& val)
+{
+	std::promise<T> promise;
+	promise.set_value(val);
+	return promise.get_future();
+}
+
+} // anonymous
+
+std::future<boost::shared_ptr<Hicann> > Wafer::get_async(
+    halco::hicann::v2::HICANNOnWafer const& h) const
+{
+	if (mHicannResourceCache.find(h))
+		return make_ready_future(get(h));
+	return redman::detail::io_pool().submit([this, h]() { return get(h); });
+}
+
+std::future<boost::shared_ptr<Fpga> > Wafer::get_async(
+    halco::hicann::v2::FPGAOnWafer const& f) const
+{
+	if (mFpgaResourceCache.find(f))
+		return make_ready_future(get(f));
+	return redman::detail::io_pool().submit([this, f]() { return get(f); });
+}
+
+void Wafer::prefetch(
+    std::vector<halco::hicann::v2::HICANNOnWafer> const& hicanns,
+    std::vector<halco::hicann::v2::FPGAOnWafer> const& fpgas,
+    size_t threads) const
+{
+	if (!mBackend) {
+		// nothing to load, missing resources are created on the fly
+		for (auto const& h : hicanns)
+			get(h);
+		for (auto const& f : fpgas)
+			get(f);
+		return;
 	}
 
-	if (mBackend) {
-		halco::hicann::v2::FPGAGlobal gh(f, mId);
-		auto tmp = FpgaWithBackend(mBackend, gh, Fpga(), mBackendBehavior.ignore_fpga_missing);
-		auto res = boost::make_shared<Fpga>(tmp);
-		mFpgaResourceCache.insert({f, res});
-		return res;
+	size_t const total = hicanns.size() + fpgas.size();
+	if (total == 0)
+		return;
+
+	// Each worker loads a contiguous share of the resources in one batch.
+	std::vector<std::future<void> > results;
+	{
+		redman::detail::ThreadPool pool(std::min(threads, total));
+		size_t const batches = std::min(pool.size(), total);
+		results.reserve(batches);
+		for (size_t ii = 0; ii < batches; ++ii) {
+			auto const share = [ii, batches](size_t size) {
+				return std::make_pair(size * ii / batches, size * (ii + 1) / batches);
+			};
+			auto const hs = share(hicanns.size());
+			auto const fs = share(fpgas.size());
+			std::vector<halco::hicann::v2::HICANNOnWafer> batch_hicanns(
+			    hicanns.begin() + hs.first, hicanns.begin() + hs.second);
+			std::vector<halco::hicann::v2::FPGAOnWafer> batch_fpgas(
+			    fpgas.begin() + fs.first, fpgas.begin() + fs.second);
+			results.push_back(pool.submit([this, batch_hicanns, batch_fpgas]() {
+				load_batch(batch_hicanns, batch_fpgas);
+			}));
+		}
 	}
-	auto res = boost::make_shared<Fpga>();
-	mFpgaResourceCache.insert({f, res});
-	return res;
+	for (auto& result : results)
+		result.get();
+}
+
+void Wafer::load_batch(
+    std::vector<halco::hicann::v2::HICANNOnWafer> const& hicanns,
+    std::vector<halco::hicann::v2::FPGAOnWafer> const& fpgas) const
+{
+	std::vector<std::string> ids;
+	std::vector<Base*> resources;
+
+	// Claim the slots through the cache, so that concurrent get() calls wait
+	// for this batch instead of loading the same resources again.  Skip
+	// resources that are cached, being loaded or that get() would not return.
+	std::vector<std::pair<halco::hicann::v2::HICANNOnWafer, boost::shared_ptr<Hicann> > > hicann_batch;
+	std::vector<halco::hicann::v2::HICANNOnWafer> hicanns_in_flight;
+	for (auto const& h : hicanns) {
+		if (!mGetBehavior.ignore_hicann_missing && !has(h))
+			continue;
+		if (!mHicannResourceCache.claim(h)) {
+			if (!mHicannResourceCache.find(h))
+				hicanns_in_flight.push_back(h);
+			continue;
+		}
+		hicann_batch.emplace_back(h, boost::make_shared<Hicann>());
+		ids.push_back(HicannWithBackend::backend_id(halco::hicann::v2::HICANNGlobal(h, mId)));
+		resources.push_back(hicann_batch.back().second.get());
+	}
+
+	std::vector<std::pair<halco::hicann::v2::FPGAOnWafer, boost::shared_ptr<Fpga> > > fpga_batch;
+	std::vector<halco::hicann::v2::FPGAOnWafer> fpgas_in_flight;
+	for (auto const& f : fpgas) {
+		if (!mGetBehavior.ignore_fpga_missing && !has(f))
+			continue;
+		if (!mFpgaResourceCache.claim(f)) {
+			if (!mFpgaResourceCache.find(f))
+				fpgas_in_flight.push_back(f);
+			continue;
+		}
+		fpga_batch.emplace_back(f, boost::make_shared<Fpga>());
+		ids.push_back(FpgaWithBackend::backend_id(halco::hicann::v2::FPGAGlobal(f, mId)));
+		resources.push_back(fpga_batch.back().second.get());
+	}
+
+	std::vector<bool> found;
+	try {
+		if (!ids.empty())
+			found = mBackend->load_many(ids, resources);
+	} catch (...) {
+		// release the claimed slots, waiting callers load on their own
+		for (auto const& entry : hicann_batch)
+			mHicannResourceCache.publish(entry.first, boost::shared_ptr<Hicann>());
+		for (auto const& entry : fpga_batch)
+			mFpgaResourceCache.publish(entry.first, boost::shared_ptr<Fpga>());
+		throw;
+	}
+
+	size_t idx = 0;
+	std::string missing;
+	for (auto const& entry : hicann_batch) {
+		if (found[idx] || mBackendBehavior.ignore_hicann_missing) {
+			mHicannResourceCache.publish(entry.first, entry.second);
+		} else {
+			mHicannResourceCache.publish(entry.first, boost::shared_ptr<Hicann>());
+			if (missing.empty())
+				missing = ids[idx];
+		}
+		++idx;
+	}
+	for (auto const& entry : fpga_batch) {
+		if (found[idx] || mBackendBehavior.ignore_fpga_missing) {
+			mFpgaResourceCache.publish(entry.first, entry.second);
+		} else {
+			mFpgaResourceCache.publish(entry.first, boost::shared_ptr<Fpga>());
+			if (missing.empty())
+				missing = ids[idx];
+		}
+		++idx;
+	}
+
+	if (!missing.empty())
+		throw backend::not_found_error("data set not found: " + missing);
+
+	// wait for resources loaded by other threads meanwhile
+	for (auto const& h : hicanns_in_flight)
+		get(h);
+	for (auto const& f : fpgas_in_flight)
+		get(f);
+}
+
+void Wafer::prefetch(size_t threads) const
+{
+	std::vector<halco::hicann::v2::HICANNOnWafer> const hicanns(
+	    mHicanns->begin(), mHicanns->end());
+	std::vector<halco::hicann::v2::FPGAOnWafer> const fpgas(mFpgas->begin(), mFpgas->end());
+	prefetch(hicanns, fpgas, threads);
 }
 
 void Wafer::inject(halco::hicann::v2::HICANNOnWafer const& h, boost::shared_ptr<Hicann> res)
 {
-	mHicannResourceCache[h] = res;
+	mHicannResourceCache.insert(h, res);
 }
 
 void Wafer::inject(halco::hicann::v2::FPGAOnWafer const& h, boost::shared_ptr<Fpga> res)
 {
-	mFpgaResourceCache[h] = res;
+	mFpgaResourceCache.insert(h, res);
 }
 
 void Wafer::load()
@@ -174,6 +372,33 @@ void Wafer::load()
 	}
 }
 
+std::future<void> Wafer::load_async()
+{
+	return redman::detail::io_pool().submit([this]() { load(); });
+}
+
+void Wafer::save_resources() const
+{
+	if (!mBackend)
+		throw std::runtime_error("Wafer needs backend to commit data.");
+
+	std::vector<std::string> ids;
+	std::vector<Base const*> resources;
+	mHicannResourceCache.for_each(
+	    [this, &ids, &resources](
+	        halco::hicann::v2::HICANNOnWafer const& h, boost::shared_ptr<Hicann> const& hicann) {
+		    ids.push_back(HicannWithBackend::backend_id(halco::hicann::v2::HICANNGlobal(h, mId)));
+		    resources.push_back(hicann.get());
+	    });
+	mFpgaResourceCache.for_each(
+	    [this, &ids, &resources](
+	        halco::hicann::v2::FPGAOnWafer const& f, boost::shared_ptr<Fpga> const& fpga) {
+		    ids.push_back(FpgaWithBackend::backend_id(halco::hicann::v2::FPGAGlobal(f, mId)));
+		    resources.push_back(fpga.get());
+	    });
+	mBackend->store_many(ids, resources);
+}
+
 void Wafer::save()
 {
 	if (!mBackend)
@@ -184,6 +409,16 @@ void Wafer::save()
 	mBackend->store(id.str(), *this);
 }
 
+std::future<void> Wafer::save_async()
+{
+	if (!mBackend)
+		throw std::runtime_error("Wafer needs backend to commit data.");
+
+	std::stringstream id;
+	id << "wafer-" << mId;
+	return mBackend->store_async(id.str(), *this);
+}
+
 WaferWithBackend::WaferWithBackend(
     boost::shared_ptr<backend::Backend> backend,
     id_type const& id,
@@ -0,0 +1,530 @@
+#include "redman/storage/Compressed.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "redman/storage/kernels.h"
+
+namespace redman {
+namespace storage {
+
+namespace {
+
+typedef CompressedChunk::word_type word_type;
+typedef CompressedChunk::size_type size_type;
+
+size_type const word_bits = 64;
+
+struct RunLast
+{
+	bool operator()(CompressedChunk::Run const& run, size_type val) const
+	{
+		return run.last < val;
+	}
+};
+
+struct RunStart
+{
+	bool operator()(size_type val, CompressedChunk::Run const& run) const
+	{
+		return val < run.start;
+	}
+};
+
+void set_bits(word_type* words, size_type first, size_type last)
+{
+	for (size_type ii = first; ii <= last;) {
+		size_type const offset = ii % word_bits;
+		size_type const n = std::min<size_type>(word_bits - offset, last - ii + 1);
+		word_type const mask = n == word_bits ? ~word_type(0) : ((word_type(1) << n) - 1) << offset;
+		words[ii / word_bits] |= mask;
+		ii += n;
+	}
+}
+
+/// Position of the first bit at or after `pos` that equals `value`.
+size_type find_bit(word_type const* words, size_type pos, bool value)
+{
+	size_type const capacity = CompressedChunk::capacity;
+	if (pos >= capacity)
+		return capacity;
+	word_type const flip = value ? 0 : ~word_type(0);
+	size_type w = pos / word_bits;
+	word_type word = (words[w] ^ flip) & (~word_type(0) << (pos % word_bits));
+	while (!word) {
+		if (++w == CompressedChunk::bitmap_words)
+			return capacity;
+		word = words[w] ^ flip;
+	}
+	return w * word_bits + static_cast<size_type>(__builtin_ctzll(word));
+}
+
+} // anonymous
+
+CompressedChunk::size_type const CompressedChunk::capacity;
+CompressedChunk::size_type const CompressedChunk::array_limit;
+CompressedChunk::size_type const CompressedChunk::bitmap_words;
+
+CompressedChunk::CompressedChunk() :
+	mKind(ARRAY), mSize(0), mArray(), mBitmap(), mRuns()
+{}
+
+std::size_t CompressedChunk::memory() const
+{
+	return mArray.capacity() * sizeof(value_type) +
+	       mBitmap.capacity() * sizeof(word_type) +
+	       mRuns.capacity() * sizeof(Run);
+}
+
+bool CompressedChunk::contains(value_type val) const
+{
+	switch (mKind) {
+		case ARRAY:
+			return std::binary_search(mArray.begin(), mArray.end(), val);
+		case BITMAP:
+			return (mBitmap[val / word_bits] >> (val % word_bits)) & 1;
+		case RUN: {
+			auto it = std::upper_bound(mRuns.begin(), mRuns.end(), val, RunStart());
+			return it != mRuns.begin() && (it - 1)->last >= val;
+		}
+	}
+	return false;
+}
+
+bool CompressedChunk::insert(value_type val)
+{
+	switch (mKind) {
+		case ARRAY: {
+			auto it = std::lower_bound(mArray.begin(), mArray.end(), val);
+			if (it != mArray.end() && *it == val)
+				return false;
+			mArray.insert(it, val);
+			if (++mSize > array_limit)
+				optimize();
+			return true;
+		}
+		case BITMAP: {
+			word_type& word = mBitmap[val / word_bits];
+			word_type const mask = word_type(1) << (val % word_bits);
+			if (word & mask)
+				return false;
+			word |= mask;
+			++mSize;
+			return true;
+		}
+		case RUN: {
+			auto next = std::upper_bound(mRuns.begin(), mRuns.end(), val, RunStart());
+			bool const extends_prev = next != mRuns.begin() && (next - 1)->last + 1u >= val;
+			if (extends_prev && (next - 1)->last >= val)
+				return false;
+			bool const extends_next = next != mRuns.end() && next->start == val + 1u;
+			if (extends_prev && extends_next) {
+				(next - 1)->last = next->last;
+				mRuns.erase(next);
+			} else if (extends_prev) {
+				(next - 1)->last = val;
+			} else if (extends_next) {
+				next->start = val;
+			} else {
+				Run const run = {val, val};
+				mRuns.insert(next, run);
+			}
+			++mSize;
+			check_runs();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CompressedChunk::erase(value_type val)
+{
+	switch (mKind) {
+		case ARRAY: {
+			auto it = std::lower_bound(mArray.begin(), mArray.end(), val);
+			if (it == mArray.end() || *it != val)
+				return false;
+			mArray.erase(it);
+			--mSize;
+			return true;
+		}
+		case BITMAP: {
+			word_type& word = mBitmap[val / word_bits];
+			word_type const mask = word_type(1) << (val % word_bits);
+			if (!(word & mask))
+				return false;
+			word &= ~mask;
+			if (--mSize <= array_limit)
+				to_array();
+			return true;
+		}
+		case RUN: {
+			auto it = std::upper_bound(mRuns.begin(), mRuns.end(), val, RunStart());
+			if (it == mRuns.begin() || (it - 1)->last < val)
+				return false;
+			--it;
+			if (it->start == it->last) {
+				mRuns.erase(it);
+			} else if (it->start == val) {
+				++it->start;
+			} else if (it->last == val) {
+				--it->last;
+			} else {
+				Run const tail = {static_cast<value_type>(val + 1), it->last};
+				it->last = val - 1;
+				mRuns.insert(it + 1, tail);
+			}
+			--mSize;
+			check_runs();
+			return true;
+		}
+	}
+	return false;
+}
+
+void CompressedChunk::clear()
+{
+	mKind = ARRAY;
+	mSize = 0;
+	std::vector<value_type>().swap(mArray);
+	std::vector<word_type>().swap(mBitmap);
+	std::vector<Run>().swap(mRuns);
+}
+
+void CompressedChunk::fill(size_type first, size_type last)
+{
+	clear();
+	if (first >= last)
+		return;
+	mKind = RUN;
+	Run const run = {static_cast<value_type>(first), static_cast<value_type>(last - 1)};
+	mRuns.assign(1, run);
+	mSize = last - first;
+}
+
+size_type CompressedChunk::next(size_type pos) const
+{
+	if (pos >= capacity)
+		return capacity;
+
+	switch (mKind) {
+		case ARRAY: {
+			auto it = std::lower_bound(mArray.begin(), mArray.end(), pos);
+			return it == mArray.end() ? capacity : *it;
+		}
+		case BITMAP: {
+			size_type w = pos / word_bits;
+			word_type word = mBitmap[w] & (~word_type(0) << (pos % word_bits));
+			while (!word) {
+				if (++w == bitmap_words)
+					return capacity;
+				word = mBitmap[w];
+			}
+			return w * word_bits + static_cast<size_type>(__builtin_ctzll(word));
+		}
+		case RUN: {
+			auto it = std::lower_bound(mRuns.begin(), mRuns.end(), pos, RunLast());
+			return it == mRuns.end() ? capacity : std::max<size_type>(it->start, pos);
+		}
+	}
+	return capacity;
+}
+
+size_type CompressedChunk::prev(size_type pos) const
+{
+	if (pos == 0 || mSize == 0)
+		return capacity;
+	if (pos > capacity)
+		pos = capacity;
+
+	switch (mKind) {
+		case ARRAY: {
+			auto it = std::lower_bound(mArray.begin(), mArray.end(), pos);
+			return it == mArray.begin() ? capacity : *(it - 1);
+		}
+		case BITMAP: {
+			size_type w = (pos - 1) / word_bits;
+			size_type const shift = word_bits - 1 - (pos - 1) % word_bits;
+			word_type word = (mBitmap[w] << shift) >> shift;
+			while (!word) {
+				if (w-- == 0)
+					return capacity;
+				word = mBitmap[w];
+			}
+			return w * word_bits + word_bits - 1 - static_cast<size_type>(__builtin_clzll(word));
+		}
+		case RUN: {
+			// first run starting at or after pos
+			auto it = std::lower_bound(mRuns.begin(), mRuns.end(), pos,
+				[](Run const& run, size_type val) { return run.start < val; });
+			if (it == mRuns.begin())
+				return capacity;
+			--it;
+			return std::min<size_type>(it->last, pos - 1);
+		}
+	}
+	return capacity;
+}
+
+size_type CompressedChunk::rank(size_type pos) const
+{
+	if (pos >= capacity)
+		return mSize;
+
+	switch (mKind) {
+		case ARRAY:
+			return static_cast<size_type>(
+				std::lower_bound(mArray.begin(), mArray.end(), pos) - mArray.begin());
+		case BITMAP: {
+			size_type const w = pos / word_bits;
+			size_type count = static_cast<size_type>(kernels::popcount(mBitmap.data(), w));
+			if (pos % word_bits)
+				count += static_cast<size_type>(__builtin_popcountll(
+					mBitmap[w] & ~(~word_type(0) << (pos % word_bits))));
+			return count;
+		}
+		case RUN: {
+			size_type count = 0;
+			for (auto const& run : mRuns) {
+				if (run.start >= pos)
+					break;
+				count += std::min<size_type>(run.last + 1u, pos) - run.start;
+			}
+			return count;
+		}
+	}
+	return 0;
+}
+
+CompressedChunk::value_type CompressedChunk::select(size_type k) const
+{
+	switch (mKind) {
+		case ARRAY:
+			return mArray[k];
+		case BITMAP: {
+			size_type w = 0;
+			for (;; ++w) {
+				size_type const count = static_cast<size_type>(__builtin_popcountll(mBitmap[w]));
+				if (k < count)
+					break;
+				k -= count;
+			}
+			word_type word = mBitmap[w];
+			for (; k; --k)
+				word &= word - 1;
+			return static_cast<value_type>(
+				w * word_bits + static_cast<size_type>(__builtin_ctzll(word)));
+		}
+		case RUN:
+			for (auto const& run : mRuns) {
+				size_type const length = run.last - run.start + 1u;
+				if (k < length)
+					return static_cast<value_type>(run.start + k);
+				k -= length;
+			}
+			break;
+	}
+	return 0;
+}
+
+void CompressedChunk::merge(CompressedChunk const& other)
+{
+	if (!other.empty())
+		apply(other, OR);
+}
+
+void CompressedChunk::intersection(CompressedChunk const& other)
+{
+	if (other.empty())
+		clear();
+	else if (!empty())
+		apply(other, AND);
+}
+
+void CompressedChunk::difference(CompressedChunk const& other)
+{
+	if (!empty() && !other.empty())
+		apply(other, AND_NOT);
+}
+
+void CompressedChunk::symmetric_difference(CompressedChunk const& other)
+{
+	if (!other.empty())
+		apply(other, XOR);
+}
+
+void CompressedChunk::merge_complement(
+	CompressedChunk const& other, size_type first, size_type last)
+{
+	CompressedChunk range;
+	range.fill(first, last);
+	range.difference(other);
+	merge(range);
+}
+
+void CompressedChunk::symmetric_difference_complement(
+	CompressedChunk const& other, size_type first, size_type last)
+{
+	CompressedChunk range;
+	range.fill(first, last);
+	range.difference(other);
+	symmetric_difference(range);
+}
+
+void CompressedChunk::optimize()
+{
+	word_type words[bitmap_words];
+	to_bitmap(words);
+	assign_bitmap(words, mSize);
+}
+
+bool CompressedChunk::operator==(CompressedChunk const& rhs) const
+{
+	if (mSize != rhs.mSize)
+		return false;
+	// Runs are always maximal, so both array and run representations are unique.
+	if (mKind == rhs.mKind && mKind == ARRAY)
+		return mArray == rhs.mArray;
+	if (mKind == rhs.mKind && mKind == RUN)
+		return mRuns == rhs.mRuns;
+
+	word_type lhs_words[bitmap_words], rhs_words[bitmap_words];
+	to_bitmap(lhs_words);
+	rhs.to_bitmap(rhs_words);
+	return kernels::equal(lhs_words, rhs_words, bitmap_words);
+}
+
+void CompressedChunk::apply(CompressedChunk const& other, operation op)
+{
+	if (mKind == ARRAY && other.mKind == ARRAY) {
+		std::vector<value_type> result;
+		result.reserve(op == AND || op == AND_NOT ? mArray.size() : mArray.size() + other.mArray.size());
+		auto out = std::back_inserter(result);
+		auto const& a = mArray;
+		auto const& b = other.mArray;
+		switch (op) {
+			case OR:
+				std::set_union(a.begin(), a.end(), b.begin(), b.end(), out);
+				break;
+			case AND:
+				std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out);
+				break;
+			case AND_NOT:
+				std::set_difference(a.begin(), a.end(), b.begin(), b.end(), out);
+				break;
+			case XOR:
+				std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), out);
+				break;
+		}
+		mArray.swap(result);
+		mSize = static_cast<size_type>(mArray.size());
+		if (mSize > array_limit)
+			optimize();
+		return;
+	}
+
+	word_type words[bitmap_words];
+	other.to_bitmap(words);
+	apply(words, op);
+}
+
+void CompressedChunk::apply(word_type const* words, operation op)
+{
+	word_type result[bitmap_words];
+	to_bitmap(result);
+
+	std::size_t count = 0;
+	switch (op) {
+		case OR:
+			count = kernels::merge(result, words, bitmap_words);
+			break;
+		case AND:
+			count = kernels::intersection(result, words, bitmap_words);
+			break;
+		case AND_NOT:
+			count = kernels::difference(result, words, bitmap_words);
+			break;
+		case XOR:
+			count = kernels::symmetric_difference(result, words, bitmap_words);
+			break;
+	}
+	assign_bitmap(result, static_cast<size_type>(count));
+}
+
+void CompressedChunk::to_bitmap(word_type* words) const
+{
+	if (mKind == BITMAP) {
+		std::copy(mBitmap.begin(), mBitmap.end(), words);
+		return;
+	}
+
+	std::fill(words, words + bitmap_words, word_type(0));
+	if (mKind == ARRAY) {
+		for (value_type val : mArray)
+			words[val / word_bits] |= word_type(1) << (val % word_bits);
+	} else {
+		for (auto const& run : mRuns)
+			set_bits(words, run.start, run.last);
+	}
+}
+
+void CompressedChunk::assign_bitmap(word_type const* words, size_type count)
+{
+	// Number of runs equals the number of set bits without a set predecessor.
+	size_type runs = 0;
+	word_type carry = 0;
+	for (size_type w = 0; w < bitmap_words; ++w) {
+		runs += static_cast<size_type>(__builtin_popcountll(words[w] & ~((words[w] << 1) | carry)));
+		carry = words[w] >> (word_bits - 1);
+	}
+
+	std::size_t const array_bytes = count * sizeof(value_type);
+	std::size_t const bitmap_bytes = bitmap_words * sizeof(word_type);
+	std::size_t const run_bytes = runs * sizeof(Run);
+
+	clear();
+	mSize = count;
+	if (run_bytes < array_bytes && run_bytes < bitmap_bytes) {
+		mKind = RUN;
+		mRuns.reserve(runs);
+		for (size_type pos = find_bit(words, 0, true); pos < capacity;) {
+			size_type const end = find_bit(words, pos, false);
+			Run const run = {static_cast<value_type>(pos), static_cast<value_type>(end - 1)};
+			mRuns.push_back(run);
+			pos = find_bit(words, end, true);
+		}
+	} else if (count <= array_limit) {
+		mKind = ARRAY;
+		mArray.reserve(count);
+		for (size_type w = 0; w < bitmap_words; ++w)
+			for (word_type word = words[w]; word; word &= word - 1)
+				mArray.push_back(static_cast<value_type>(
+					w * word_bits + static_cast<size_type>(__builtin_ctzll(word))));
+	} else {
+		mKind = BITMAP;
+		mBitmap.assign(words, words + bitmap_words);
+	}
+}
+
+void CompressedChunk::to_array()
+{
+	std::vector<value_type> values;
+	values.reserve(mSize);
+	for (size_type pos = next(0); pos < capacity; pos = next(pos + 1))
+		values.push_back(static_cast<value_type>(pos));
+	size_type const count = mSize;
+	clear();
+	mArray.swap(values);
+	mSize = count;
+}
+
+void CompressedChunk::check_runs()
+{
+	std::size_t const run_bytes = mRuns.size() * sizeof(Run);
+	if (run_bytes > mSize * sizeof(value_type) ||
+	    run_bytes > bitmap_words * sizeof(word_type))
+		optimize();
+}
+
+} // storage
+} // redman
@@ -0,0 +1,315 @@
+#include "redman/storage/kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define REDMAN_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace redman {
+namespace storage {
+namespace kernels {
+
+namespace {
+
+/* Every binary operation is described by a functor providing the scalar
+   word operation and, on x86, the same operation on 256 bit vectors. */
+
+#ifdef REDMAN_X86_KERNELS
+#define REDMAN_AVX2 __attribute__((target("avx2")))
+#endif
+
+struct Or
+{
+	static word_type apply(word_type a, word_type b) { return a | b; }
+#ifdef REDMAN_X86_KERNELS
+	REDMAN_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#endif
+};
+
+struct And
+{
+	static word_type apply(word_type a, word_type b) { return a & b; }
+#ifdef REDMAN_X86_KERNELS
+	REDMAN_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#endif
+};
+
+struct AndNot
+{
+	static word_type apply(word_type a, word_type b) { return a & ~b; }
+#ifdef REDMAN_X86_KERNELS
+	REDMAN_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+#endif
+};
+
+struct Xor
+{
+	static word_type apply(word_type a, word_type b) { return a ^ b; }
+#ifdef REDMAN_X86_KERNELS
+	REDMAN_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#endif
+};
+
+struct OrNot
+{
+	static word_type apply(word_type a, word_type b) { return a | ~b; }
+#ifdef REDMAN_X86_KERNELS
+	REDMAN_AVX2 static __m256i apply(__m256i a, __m256i b)
+	{
+		return _mm256_or_si256(a, _mm256_xor_si256(b, _mm256_set1_epi64x(-1)));
+	}
+#endif
+};
+
+struct XorNot
+{
+	static word_type apply(word_type a, word_type b) { return a ^ ~b; }
+#ifdef REDMAN_X86_KERNELS
+	REDMAN_AVX2 static __m256i apply(__m256i a, __m256i b)
+	{
+		return _mm256_xor_si256(a, _mm256_xor_si256(b, _mm256_set1_epi64x(-1)));
+	}
+#endif
+};
+
+
+// Portable implementation
+
+std::size_t popcount_scalar(word_type const* a, std::size_t n)
+{
+	std::size_t count = 0;
+	for (std::size_t ii = 0; ii < n; ++ii)
+		count += static_cast<std::size_t>(__builtin_popcountll(a[ii]));
+	return count;
+}
+
+template<typename Op>
+std::size_t apply_scalar(word_type* dst, word_type const* src, std::size_t n)
+{
+	std::size_t count = 0;
+	for (std::size_t ii = 0; ii < n; ++ii) {
+		dst[ii] = Op::apply(dst[ii], src[ii]);
+		count += static_cast<std::size_t>(__builtin_popcountll(dst[ii]));
+	}
+	return count;
+}
+
+bool equal_scalar(word_type const* a, word_type const* b, std::size_t n)
+{
+	word_type diff = 0;
+	for (std::size_t ii = 0; ii < n; ++ii)
+		diff |= a[ii] ^ b[ii];
+	return diff == 0;
+}
+
+Implementation const scalar_impl = {
+	"scalar",
+	&popcount_scalar,
+	&apply_scalar<Or>,
+	&apply_scalar<And>,
+	&apply_scalar<AndNot>,
+	&apply_scalar<Xor>,
+	&apply_scalar<OrNot>,
+	&apply_scalar<XorNot>,
+	&equal_scalar,
+};
+
+
+#ifdef REDMAN_X86_KERNELS
+
+// Same as the scalar loops, but compiled to the hardware popcnt instruction.
+
+#define REDMAN_POPCNT __attribute__((target("sse4.2,popcnt")))
+
+REDMAN_POPCNT
+std::size_t popcount_popcnt(word_type const* a, std::size_t n)
+{
+	std::size_t count = 0;
+	for (std::size_t ii = 0; ii < n; ++ii)
+		count += static_cast<std::size_t>(__builtin_popcountll(a[ii]));
+	return count;
+}
+
+template<typename Op>
+REDMAN_POPCNT
+std::size_t apply_popcnt(word_type* dst, word_type const* src, std::size_t n)
+{
+	std::size_t count = 0;
+	for (std::size_t ii = 0; ii < n; ++ii) {
+		dst[ii] = Op::apply(dst[ii], src[ii]);
+		count += static_cast<std::size_t>(__builtin_popcountll(dst[ii]));
+	}
+	return count;
+}
+
+REDMAN_POPCNT
+bool equal_sse(word_type const* a, word_type const* b, std::size_t n)
+{
+	std::size_t ii = 0;
+	for (; ii + 2 <= n; ii += 2) {
+		__m128i const va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + ii));
+		__m128i const vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + ii));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xffff)
+			return false;
+	}
+	return ii == n || a[ii] == b[ii];
+}
+
+Implementation const popcnt_impl = {
+	"sse4.2",
+	&popcount_popcnt,
+	&apply_popcnt<Or>,
+	&apply_popcnt<And>,
+	&apply_popcnt<AndNot>,
+	&apply_popcnt<Xor>,
+	&apply_popcnt<OrNot>,
+	&apply_popcnt<XorNot>,
+	&equal_sse,
+};
+
+
+/* AVX2: four words per operation.  Bits are counted with the nibble lookup
+   method (vpshufb), the per-byte counts are summed by vpsadbw into one
+   64 bit accumulator per lane. */
+
+#define REDMAN_AVX2_POPCNT __attribute__((target("avx2,popcnt")))
+
+REDMAN_AVX2
+inline __m256i popcount_bytes(__m256i v)
+{
+	__m256i const lookup = _mm256_setr_epi8(
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	__m256i const low_mask = _mm256_set1_epi8(0x0f);
+	__m256i const lo = _mm256_and_si256(v, low_mask);
+	__m256i const hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+	return _mm256_add_epi8(
+		_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+}
+
+REDMAN_AVX2
+inline std::size_t horizontal_sum(__m256i acc)
+{
+	return static_cast<std::size_t>(
+		_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+		_mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+}
+
+REDMAN_AVX2_POPCNT
+std::size_t popcount_avx2(word_type const* a, std::size_t n)
+{
+	__m256i acc = _mm256_setzero_si256();
+	std::size_t ii = 0;
+	for (; ii + 4 <= n; ii += 4) {
+		__m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + ii));
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(popcount_bytes(v), _mm256_setzero_si256()));
+	}
+	std::size_t count = horizontal_sum(acc);
+	for (; ii < n; ++ii)
+		count += static_cast<std::size_t>(__builtin_popcountll(a[ii]));
+	return count;
+}
+
+template<typename Op>
+REDMAN_AVX2_POPCNT
+std::size_t apply_avx2(word_type* dst, word_type const* src, std::size_t n)
+{
+	__m256i acc = _mm256_setzero_si256();
+	std::size_t ii = 0;
+	for (; ii + 4 <= n; ii += 4) {
+		__m256i* const pd = reinterpret_cast<__m256i*>(dst + ii);
+		__m256i const v = Op::apply(
+			_mm256_loadu_si256(pd),
+			_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + ii)));
+		_mm256_storeu_si256(pd, v);
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(popcount_bytes(v), _mm256_setzero_si256()));
+	}
+	std::size_t count = horizontal_sum(acc);
+	for (; ii < n; ++ii) {
+		dst[ii] = Op::apply(dst[ii], src[ii]);
+		count += static_cast<std::size_t>(__builtin_popcountll(dst[ii]));
+	}
+	return count;
+}
+
+REDMAN_AVX2
+bool equal_avx2(word_type const* a, word_type const* b, std::size_t n)
+{
+	std::size_t ii = 0;
+	for (; ii + 4 <= n; ii += 4) {
+		__m256i const va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + ii));
+		__m256i const vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + ii));
+		__m256i const diff = _mm256_xor_si256(va, vb);
+		if (!_mm256_testz_si256(diff, diff))
+			return false;
+	}
+	for (; ii < n; ++ii)
+		if (a[ii] != b[ii])
+			return false;
+	return true;
+}
+
+Implementation const avx2_impl = {
+	"avx2",
+	&popcount_avx2,
+	&apply_avx2<Or>,
+	&apply_avx2<And>,
+	&apply_avx2<AndNot>,
+	&apply_avx2<Xor>,
+	&apply_avx2<OrNot>,
+	&apply_avx2<XorNot>,
+	&equal_avx2,
+};
+
+#endif // REDMAN_X86_KERNELS
+
+Implementation const null_impl = {
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+struct Registry
+{
+	Registry() : count(0)
+	{
+		impls[count++] = scalar_impl;
+#ifdef REDMAN_X86_KERNELS
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("popcnt") && __builtin_cpu_supports("sse4.2"))
+			impls[count++] = popcnt_impl;
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+			impls[count++] = avx2_impl;
+#endif
+		impls[count] = null_impl;
+	}
+
+	Implementation impls[4];
+	std::size_t count;
+};
+
+Registry const& registry()
+{
+	static Registry const instance;
+	return instance;
+}
+
+} // anonymous
+
+Implementation const& scalar()
+{
+	return scalar_impl;
+}
+
+Implementation const* supported()
+{
+	return registry().impls;
+}
+
+Implementation const& active()
+{
+	static Implementation const& impl = registry().impls[registry().count - 1];
+	return impl;
+}
+
+} // kernels
+} // storage
+} // redman
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+#include "redman/test/fixtures.h"
+#include "redman/Expression.h"
+
+using namespace redman;
+
+template<typename T>
+class ThreeManagers : public ::testing::Test {
+public:
+	typedef std::set<TestResource> set_type;
+
+	ThreeManagers() {
+		a.enable_all();
+		c.disable_all();
+		for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ++ii) {
+			if (ii % 3 == 0)
+				a.disable(ii);
+			if (ii % 5 == 0)
+				b.enable(ii);
+			if (ii % 7 == 0 && ii < 500)
+				c.enable(ii);
+		}
+	}
+
+	template<typename Manager>
+	static set_type enabled(Manager const& manager) {
+		return set_type(manager.begin(), manager.end());
+	}
+
+	template<typename Operation>
+	static size_t expected_count(set_type const& lhs, set_type const& rhs, Operation op) {
+		set_type result;
+		op(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(result, result.end()));
+		return result.size();
+	}
+
+	TestManager<T> a;
+	// Operands may differ in policy and storage.
+	TestManager<ManagerConfig<Whitelist, storage::Set> > b;
+	TestManager<ManagerConfig<Blacklist, storage::Bitset>, LessThanPredicate> c{LessThanPredicate(500)};
+};
+
+TYPED_TEST_SUITE(ThreeManagers, ManagerTypes);
+
+typedef std::set<TestResource>::const_iterator set_iterator;
+typedef std::insert_iterator<std::set<TestResource> > set_inserter;
+
+TYPED_TEST(ThreeManagers, CountLikeMaterializedSetAlgebra) {
+	auto const& a = TestFixture::a;
+	auto const& b = TestFixture::b;
+	auto const& c = TestFixture::c;
+	auto const ea = TestFixture::enabled(a);
+	auto const eb = TestFixture::enabled(b);
+	auto const ec = TestFixture::enabled(c);
+
+	EXPECT_EQ(TestFixture::expected_count(ea, eb, std::set_intersection<set_iterator, set_iterator, set_inserter>),
+	          (a & b).count());
+	EXPECT_EQ(TestFixture::expected_count(ea, eb, std::set_union<set_iterator, set_iterator, set_inserter>),
+	          (a | b).count());
+	EXPECT_EQ(TestFixture::expected_count(ea, ec, std::set_difference<set_iterator, set_iterator, set_inserter>),
+	          (a - c).count());
+	EXPECT_EQ(TestFixture::expected_count(eb, ec, std::set_symmetric_difference<set_iterator, set_iterator, set_inserter>),
+	          (b ^ c).count());
+
+	std::set<TestResource> ab;
+	std::set_intersection(ea.begin(), ea.end(), eb.begin(), eb.end(), std::inserter(ab, ab.end()));
+	EXPECT_EQ(TestFixture::expected_count(ab, ec, std::set_difference<set_iterator, set_iterator, set_inserter>),
+	          ((a & b) - c).count());
+	EXPECT_EQ(TestFixture::expected_count(ec, ab, std::set_difference<set_iterator, set_iterator, set_inserter>),
+	          (c - (b & a)).count());
+}
+
+TYPED_TEST(ThreeManagers, AnswerSubsetAndOverlapQueries) {
+	auto const& a = TestFixture::a;
+	auto const& b = TestFixture::b;
+	auto const& c = TestFixture::c;
+
+	EXPECT_TRUE((a & b).is_subset_of(a));
+	EXPECT_TRUE(is_subset_of(a - c, a));
+	EXPECT_FALSE(is_subset_of(a, b));
+	EXPECT_TRUE(overlaps(a, b));
+	EXPECT_FALSE((a - c).overlaps(c));
+	EXPECT_TRUE((b & c).any());
+	EXPECT_FALSE(((b & c) - b).any());
+	EXPECT_EQ(a.available(), expression::make_expression(a).count());
+}
+
+/// Accepts all resources, counting how often it was asked.
+struct CountingPredicate : public redman::DefaultPredicate<TestResource> {
+	explicit CountingPredicate(size_t& _calls) : calls(&_calls) {}
+
+	bool operator()(resource_type const&) const {
+		++*calls;
+		return true;
+	}
+
+	size_t* calls;
+};
+
+TEST(AnExpression, WalksEachOperandOncePerPass) {
+	size_t calls = 0;
+	// Blacklist with a single enabled resource, its successors are found by
+	// scanning the predicate up to the end of the index range.
+	TestManager<ManagerConfig<Blacklist, storage::Set>, CountingPredicate> sparse{CountingPredicate(calls)};
+	sparse.disable_all();
+	sparse.enable(TestResource::begin);
+	TestManager<ManagerConfig<Whitelist, storage::Set> > dense;
+	for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ii += 2)
+		dense.enable(ii);
+
+	calls = 0;
+	EXPECT_EQ(dense.available(), (dense | sparse).count());
+	EXPECT_EQ(dense.available() - 1, (sparse ^ dense).count());
+	size_t n = 0;
+	for (auto cur = (dense | sparse).cursor(); !cur.done(); cur.advance())
+		++n;
+	EXPECT_EQ(dense.available(), n);
+	// Re-seeking the sparse operand for every resource of the result would
+	// evaluate the predicate about |dense| * size times.
+	EXPECT_GT(10 * TestResource::size, calls);
+}
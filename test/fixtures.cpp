@@ -22,3 +22,7 @@ TestResource& TestResource::operator+=(TestResource const& other) {
 	index += other.index;
 	return *this;
 }
+
+TestResource::value_type TestResource::value() const {
+	return index;
+}
@@ -0,0 +1,165 @@
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "redman/test/fixtures.h"
+#include "redman/flat/File.h"
+
+using namespace redman;
+
+class WithTemporaryFile : public ::testing::Test {
+public:
+	WithTemporaryFile() :
+		filename((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string())
+	{}
+
+	~WithTemporaryFile()
+	{
+		boost::filesystem::remove(filename);
+	}
+
+	std::string const filename;
+};
+
+template<typename T>
+class AFlatFile : public WithTemporaryFile {
+public:
+	typedef TestManager<T> manager_type;
+
+	AFlatFile() {
+		sparse.disable_all();
+		for (TestResource::value_type ii = 100; ii < 1337; ii += 250)
+			sparse.enable(ii);
+		sparse.enable(101);
+		sparse.enable(1337);
+
+		dense.enable_all();
+		for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ii += 3)
+			dense.disable(ii);
+	}
+
+	template<typename View>
+	static void expect_same(manager_type const& manager, View const& view) {
+		EXPECT_EQ(manager.available(), view.available());
+		for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ++ii)
+			EXPECT_EQ(manager.has(ii), view.has(ii)) << ii;
+		EXPECT_EQ(std::set<TestResource>(manager.begin(), manager.end()),
+		          std::set<TestResource>(view.begin(), view.end()));
+	}
+
+	manager_type sparse;
+	manager_type dense;
+};
+
+TYPED_TEST_SUITE(AFlatFile, ManagerTypes);
+
+TYPED_TEST(AFlatFile, AnswersQueriesLikeTheWrittenManagers) {
+	typedef typename TestFixture::manager_type manager_type;
+	flat::Writer writer;
+	writer.add("sparse", TestFixture::sparse);
+	writer.add("dense", TestFixture::dense);
+	writer.write(TestFixture::filename);
+
+	auto mapping = flat::MappedResource::open(TestFixture::filename);
+	EXPECT_EQ((std::vector<std::string>{"sparse", "dense"}), mapping->components());
+	EXPECT_FALSE(mapping->has_component("missing"));
+	EXPECT_THROW(mapping->template component<manager_type>("missing"), std::out_of_range);
+
+	auto const sparse = mapping->template component<manager_type>("sparse");
+	auto const dense = mapping->template component<manager_type>("dense");
+	// views keep the mapping alive
+	mapping.reset();
+
+	TestFixture::expect_same(TestFixture::sparse, sparse);
+	TestFixture::expect_same(TestFixture::dense, dense);
+
+	manager_type copy;
+	sparse.copy_to(copy);
+	EXPECT_EQ(TestFixture::sparse, copy);
+	dense.copy_to(copy);
+	EXPECT_EQ(TestFixture::dense, copy);
+}
+
+typedef WithTemporaryFile AFlatFileOnDisk;
+
+TEST_F(AFlatFileOnDisk, IsRejectedIfInvalid) {
+	TestManager<ManagerConfig<Whitelist, storage::Bitset> > manager;
+	manager.enable(5);
+	manager.enable(6);
+	flat::Writer writer;
+	writer.add("manager", manager);
+	writer.write(filename);
+
+	std::string content;
+	{
+		std::ifstream stream(filename, std::ios::binary);
+		content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+	ASSERT_NO_THROW(flat::MappedResource::open(filename));
+
+	auto const expect_rejected = [this](std::string const& data) {
+		{
+			std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+			stream << data;
+		}
+		EXPECT_THROW(flat::MappedResource::open(filename), std::runtime_error);
+	};
+
+	expect_rejected("<?xml");
+	expect_rejected(content.substr(0, content.size() - 8));
+
+	std::string foreign = content;
+	std::swap(foreign[12], foreign[15]);
+	expect_rejected(foreign);
+
+	std::string newer = content;
+	newer[8] = 99;
+	expect_rejected(newer);
+
+	// the single run [5, 7) is the last payload
+	std::string unsorted = content;
+	std::swap(unsorted[content.size() - 8], unsorted[content.size() - 4]);
+	expect_rejected(unsorted);
+
+	// the count of enabled resources stored in the section entry is checked
+	std::string miscounted = content;
+	miscounted[sizeof(flat::FileHeader) + offsetof(flat::SectionEntry, count)] = 3;
+	expect_rejected(miscounted);
+
+	// offset + payload size wraps around to zero
+	std::string wrapped = content;
+	std::uint64_t const offset = std::numeric_limits<std::uint64_t>::max() - 63;
+	std::uint64_t const length = 8;
+	wrapped.replace(sizeof(flat::FileHeader) + offsetof(flat::SectionEntry, offset),
+	                sizeof(offset), reinterpret_cast<char const*>(&offset), sizeof(offset));
+	wrapped.replace(sizeof(flat::FileHeader) + offsetof(flat::SectionEntry, length),
+	                sizeof(length), reinterpret_cast<char const*>(&length), sizeof(length));
+	expect_rejected(wrapped);
+
+	EXPECT_THROW(flat::MappedResource::open(filename + ".missing"), std::runtime_error);
+}
+
+TEST_F(AFlatFileOnDisk, IsReplacedWithoutLeavingTemporaryFiles) {
+	TestManager<ManagerConfig<Whitelist, storage::Set> > manager;
+	flat::Writer writer;
+	writer.add("manager", manager);
+	writer.write(filename);
+	manager.enable(5);
+	writer = flat::Writer();
+	writer.add("manager", manager);
+	writer.write(filename);
+
+	auto const mapping = flat::MappedResource::open(filename);
+	EXPECT_EQ(1, mapping->component<decltype(manager)>("manager").available());
+	auto const directory = boost::filesystem::path(filename).parent_path();
+	auto const name = boost::filesystem::path(filename).filename().native();
+	for (boost::filesystem::directory_iterator it(directory), end; it != end; ++it) {
+		auto const other = it->path().filename().native();
+		EXPECT_FALSE(other != name && other.compare(0, name.size(), name) == 0) << other;
+	}
+}
@@ -1,7 +1,16 @@
 #include "redman/test/test_with_backend.h"
 
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <boost/make_shared.hpp>
 
+#include "redman/backend/CachingBackend.h"
+#include "redman/backend/Compression.h"
+#include "redman/flat/File.h"
 #include "redman/resources/Wafer.h"
 #include "redman/resources/Hicann.h"
 
@@ -142,3 +151,321 @@ TYPED_TEST(AWaferWithBackend, AllowsToInjectFpgaResources) {
 	auto loaded = wafer.get(hi);
 	ASSERT_FALSE(loaded->hslinks()->has(absent));
 }
+
+typedef TestWithBackend<BinaryBackend> ABinaryBackend;
+
+TEST_F(ABinaryBackend, RejectsFilesWithForeignHeader) {
+	Hicann hicann;
+	backend->store("header-test", hicann);
+	auto const file = (backendPath / "header-test.bin").string();
+
+	std::string content;
+	{
+		std::ifstream stream(file, std::ios::binary);
+		content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+	ASSERT_GT(content.size(), 20);
+	EXPECT_EQ("redmanbn", content.substr(0, 8));
+	EXPECT_NO_THROW(backend->load("header-test", hicann));
+
+	auto const rewrite = [&file](std::string const& data) {
+		std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+		stream << data;
+	};
+
+	std::string foreign = content;
+	foreign[12] = foreign[12] == 'L' ? 'B' : 'L';
+	rewrite(foreign);
+	EXPECT_THROW(backend->load("header-test", hicann), std::runtime_error);
+
+	std::string newer = content;
+	newer[8] = 99;
+	rewrite(newer);
+	EXPECT_THROW(backend->load("header-test", hicann), std::runtime_error);
+
+	rewrite("<?xml");
+	EXPECT_THROW(backend->load("header-test", hicann), std::runtime_error);
+}
+
+TEST_F(ABinaryBackend, StoresConcurrentlyWithoutSharingTemporaryFiles) {
+	std::vector<std::thread> writers;
+	for (size_t ii = 0; ii < 4; ++ii) {
+		writers.emplace_back([this, ii]() {
+			Hicann hicann;
+			hicann.neurons()->disable(HMFC::NeuronOnHICANN(halco::common::Enum(ii)));
+			for (size_t jj = 0; jj < 20; ++jj)
+				backend->store("concurrent", hicann);
+		});
+	}
+	for (auto& writer : writers)
+		writer.join();
+
+	Hicann loaded;
+	ASSERT_NO_THROW(backend->load("concurrent", loaded));
+	EXPECT_EQ(511, loaded.neurons()->available());
+	for (boost::filesystem::directory_iterator it(backendPath), end; it != end; ++it)
+		EXPECT_EQ(std::string::npos, it->path().filename().native().find(".tmp"));
+}
+
+typedef TestWithBackend<FlatBackend> AFlatBackend;
+
+TEST_F(AFlatBackend, StoresComponentsForDirectReadOnlyAccess) {
+	auto const absent = HMFC::NeuronOnHICANN(halco::common::Enum(5));
+	Hicann hicann;
+	hicann.neurons()->disable(absent);
+	hicann.synapses()->disable_all();
+	backend->store("flat-hicann", hicann);
+
+	auto const mapping =
+		flat::MappedResource::open((backendPath / "flat-hicann.flat").string());
+	auto const neurons = mapping->component<components::Neurons>("neurons");
+	EXPECT_FALSE(neurons.has(absent));
+	EXPECT_EQ(hicann.neurons()->available(), neurons.available());
+	EXPECT_EQ(0, mapping->component<components::Synapses>("synapses").available());
+
+	Hicann loaded;
+	backend->load("flat-hicann", loaded);
+	EXPECT_EQ(hicann, loaded);
+}
+
+TEST_F(AFlatBackend, RejectsCompression) {
+	backend->config("compression", "zlib");
+	EXPECT_THROW(backend->init(), std::invalid_argument);
+	backend->config("compression", "none");
+	EXPECT_NO_THROW(backend->init());
+}
+
+typedef TestWithBackend<BundleBackend> ABundleBackend;
+
+TEST_F(ABundleBackend, KeepsAllResourcesOfAWaferInOneFile) {
+	Hicann hicann;
+	hicann.neurons()->disable(HMFC::NeuronOnHICANN(halco::common::Enum(7)));
+	Fpga fpga;
+	backend->store("hicann-Wafer(3)-Enum(1)", hicann);
+	backend->store("fpga-3-2", fpga);
+	backend->store("hicann-Wafer(4)-Enum(1)", hicann);
+
+	EXPECT_TRUE(boost::filesystem::exists(backendPath / "wafer-3.bundle"));
+	EXPECT_TRUE(boost::filesystem::exists(backendPath / "wafer-4.bundle"));
+
+	Hicann loaded;
+	backend->load("hicann-Wafer(3)-Enum(1)", loaded);
+	EXPECT_EQ(hicann, loaded);
+	EXPECT_THROW(backend->load("hicann-Wafer(3)-Enum(2)", loaded), backend::not_found_error);
+
+	Hicann many_hicann;
+	Fpga many_fpga;
+	Hicann missing;
+	auto const found = backend->load_many(
+		{"hicann-Wafer(3)-Enum(1)", "fpga-3-2", "hicann-Wafer(3)-Enum(2)"},
+		{&many_hicann, &many_fpga, &missing});
+	EXPECT_EQ((std::vector<bool>{true, true, false}), found);
+	EXPECT_EQ(hicann, many_hicann);
+	EXPECT_EQ(fpga, many_fpga);
+}
+
+TEST_F(ABundleBackend, DetectsCorruptedResources) {
+	Hicann hicann;
+	backend->store("hicann-Wafer(5)-Enum(0)", hicann);
+	auto const file = (backendPath / "wafer-5.bundle").string();
+
+	std::string content;
+	{
+		std::ifstream stream(file, std::ios::binary);
+		content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+	ASSERT_GT(content.size(), 64);
+	EXPECT_EQ("redmanbd", content.substr(0, 8));
+
+	// first record starts right after the 32 byte header
+	content[40] = ~content[40];
+	{
+		std::fstream stream(file, std::ios::binary | std::ios::in | std::ios::out);
+		stream.seekp(40);
+		stream.put(content[40]);
+	}
+	EXPECT_THROW(backend->load("hicann-Wafer(5)-Enum(0)", hicann), std::runtime_error);
+}
+
+TEST_F(ABundleBackend, CompactsRepeatedlyUpdatedBundles) {
+	Hicann hicann;
+	auto const file = backendPath / "wafer-6.bundle";
+	backend->store("hicann-Wafer(6)-Enum(0)", hicann);
+	auto const single = boost::filesystem::file_size(file);
+
+	std::uintmax_t written = single;
+	for (size_t ii = 0; written < (4u << 20); ++ii) {
+		auto const neuron = HMFC::NeuronOnHICANN(halco::common::Enum(ii % 512));
+		if (hicann.neurons()->has(neuron))
+			hicann.neurons()->disable(neuron);
+		else
+			hicann.neurons()->enable(neuron);
+		backend->store("hicann-Wafer(6)-Enum(0)", hicann);
+		written += single;
+	}
+	EXPECT_LT(boost::filesystem::file_size(file), (2u << 20) + 2 * single);
+
+	Hicann loaded;
+	backend->load("hicann-Wafer(6)-Enum(0)", loaded);
+	EXPECT_EQ(hicann, loaded);
+	EXPECT_FALSE(boost::filesystem::exists(file.native() + ".tmp"));
+}
+
+#ifdef REDMAN_WITH_SQLITE
+typedef TestWithBackend<SQLiteBackend> ASQLiteBackend;
+
+TEST_F(ASQLiteBackend, LoadsManyResourcesAtOnce) {
+	size_t const count = 700;
+	std::vector<std::string> ids;
+	std::vector<Hicann> stored(count);
+	for (size_t ii = 0; ii < count; ++ii) {
+		ids.push_back("hicann-Wafer(7)-Enum(" + std::to_string(ii) + ")");
+		stored[ii].neurons()->disable(HMFC::NeuronOnHICANN(halco::common::Enum(ii % 512)));
+	}
+	std::vector<Base const*> to_store;
+	for (auto const& hicann : stored)
+		to_store.push_back(&hicann);
+	backend->store_many(ids, to_store);
+
+	ids.push_back("hicann-Wafer(7)-Enum(1000)");
+	ids.push_back(ids.front());
+	std::vector<Hicann> loaded(ids.size());
+	std::vector<Base*> to_load;
+	for (auto& hicann : loaded)
+		to_load.push_back(&hicann);
+	auto const found = backend->load_many(ids, to_load);
+
+	for (size_t ii = 0; ii < count; ++ii) {
+		EXPECT_TRUE(found[ii]);
+		EXPECT_EQ(stored[ii], loaded[ii]);
+	}
+	EXPECT_FALSE(found[count]);
+	EXPECT_TRUE(found[count + 1]);
+	EXPECT_EQ(stored.front(), loaded.back());
+}
+
+TEST_F(ASQLiteBackend, AllowsConcurrentWriters) {
+	size_t const writers = 4;
+	std::vector<std::thread> threads;
+	for (size_t tt = 0; tt < writers; ++tt) {
+		threads.emplace_back([tt]() {
+			// separate instances, like independent jobs sharing the database
+			auto const other = init_backend(SQLiteBackend::library());
+			other->config("path", backendPath.native());
+			other->init();
+			Fpga fpga;
+			for (size_t ii = 0; ii < 20; ++ii)
+				other->store("fpga-8-" + std::to_string(tt * 100 + ii), fpga);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	for (size_t tt = 0; tt < writers; ++tt) {
+		Fpga fpga;
+		EXPECT_NO_THROW(backend->load("fpga-8-" + std::to_string(tt * 100 + 19), fpga));
+	}
+	Fpga fpga;
+	EXPECT_THROW(backend->load("fpga-8-20", fpga), backend::not_found_error);
+}
+#endif // REDMAN_WITH_SQLITE
+
+TEST(ACompression, RoundTripsAndPassesUncompressedDataThrough) {
+	std::string data;
+	for (size_t ii = 0; ii < 1000; ++ii)
+		data += "<item><class_id>42</class_id><selection></selection></item>\n";
+
+	backend::Compression const zlib("zlib", 9);
+	auto const compressed = zlib.compress(data);
+	EXPECT_TRUE(backend::Compression::is_compressed(compressed));
+	EXPECT_LT(compressed.size() * 10, data.size());
+	EXPECT_EQ(data, backend::Compression::decompress(compressed));
+	EXPECT_EQ(data, backend::Compression::decompress(data));
+	EXPECT_EQ(data, backend::Compression().compress(data));
+
+	EXPECT_THROW(
+		backend::Compression::decompress(compressed.substr(0, compressed.size() / 2)),
+		std::runtime_error);
+	EXPECT_THROW(backend::Compression("zlib", 10), std::invalid_argument);
+	EXPECT_THROW(backend::Compression("lzma"), std::invalid_argument);
+}
+
+template <typename T>
+class ACompressingBackend : public TestWithBackend<T> {};
+#ifdef REDMAN_WITH_SQLITE
+typedef ::testing::Types<XMLBackend, BinaryBackend, BundleBackend, SQLiteBackend>
+	CompressingBackendTypes;
+#else
+typedef ::testing::Types<XMLBackend, BinaryBackend, BundleBackend>
+	CompressingBackendTypes;
+#endif
+TYPED_TEST_SUITE(ACompressingBackend, CompressingBackendTypes);
+
+TYPED_TEST(ACompressingBackend, ReadsCompressedAndUncompressedData) {
+	auto& backend = TestFixture::backend;
+	Hicann hicann;
+	hicann.neurons()->disable(HMFC::NeuronOnHICANN(halco::common::Enum(3)));
+
+	backend->store("hicann-Wafer(9)-Enum(0)", hicann);
+	backend->config("compression", "zlib");
+	backend->config("compression_level", 9);
+	backend->store("hicann-Wafer(9)-Enum(1)", hicann);
+	backend->config("compression", "none");
+
+	Hicann plain, compressed;
+	backend->load("hicann-Wafer(9)-Enum(0)", plain);
+	backend->load("hicann-Wafer(9)-Enum(1)", compressed);
+	EXPECT_EQ(hicann, plain);
+	EXPECT_EQ(hicann, compressed);
+}
+
+typedef TestWithBackend<XMLBackend> AXMLBackend;
+
+TEST_F(AXMLBackend, CompressesFilesIfConfigured) {
+	Hicann hicann;
+	backend->store("plain", hicann);
+	backend->config("compression", "zlib");
+	backend->store("compressed", hicann);
+	backend->config("compression", "none");
+
+	auto const plain = boost::filesystem::file_size(backendPath / "plain.xml");
+	auto const compressed = boost::filesystem::file_size(backendPath / "compressed.xml");
+	EXPECT_LT(compressed * 10, plain);
+
+	backend->config("compression", "zstd");
+	EXPECT_THROW(backend->store("unsupported", hicann), std::invalid_argument);
+	backend->config("compression", "none");
+
+	// levels may be configured as string, invalid ones are rejected by init()
+	backend->config("compression", "zlib");
+	backend->config("compression_level", "1");
+	EXPECT_NO_THROW(backend->init());
+	backend->config("compression_level", "fast");
+	EXPECT_THROW(backend->init(), std::invalid_argument);
+	backend->config("compression", "none");
+	backend->config("compression_level", backend::Compression::default_level);
+}
+
+TEST_F(AXMLBackend, IsReloadedByACachingBackendIfTheFileChanges) {
+	auto const cache = boost::make_shared<backend::CachingBackend>(backend);
+	cache->init();
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+
+	Hicann hicann;
+	cache->store("cached", hicann);
+	Hicann loaded;
+	cache->load("cached", loaded);
+	cache->load("cached", loaded);
+	EXPECT_EQ(1, cache->statistics().hits);
+
+	// written by someone else
+	hicann.neurons()->disable(nrn);
+	backend->store("cached", hicann);
+	cache->load("cached", loaded);
+	EXPECT_FALSE(loaded.neurons()->has(nrn));
+	EXPECT_EQ(1, cache->statistics().invalidations);
+
+	boost::filesystem::remove(backendPath / "cached.xml");
+	EXPECT_THROW(cache->load("cached", loaded), backend::not_found_error);
+	EXPECT_EQ(0, cache->statistics().entries);
+}
@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "redman/test/fixtures.h"
 
 using namespace redman;
@@ -41,3 +43,54 @@ TEST(APredicate, ProvidesRangeBasedForViaADL) {
 
 	EXPECT_NE(begin(pred), end(pred));
 }
+
+TEST(APredicate, HasACompileTimeCardinality) {
+	typedef DefaultPredicate<TestResource> predicate;
+	static_assert(
+		PredicateCardinality<predicate>::value == TestResource::size,
+		"DefaultPredicate accepts the whole index range");
+	EXPECT_EQ(TestResource::size, cardinality(predicate()));
+}
+
+TEST(ACustomPredicate, CountsItsValidResources) {
+	EXPECT_EQ(TestResource::size / 2, cardinality(EvenPredicate()));
+	EXPECT_EQ(200 - TestResource::begin, cardinality(LessThanPredicate(200)));
+}
+
+namespace {
+
+struct CountingPredicate : public DefaultPredicate<TestResource>,
+                           public StaticValidityMask<CountingPredicate> {
+	bool operator()(resource_type const& res) const {
+		++calls;
+		return res.index % 100 == 0;
+	}
+
+	static size_t calls;
+};
+
+size_t CountingPredicate::calls = 0;
+
+} // anonymous
+
+TEST(AMaskedPredicate, IsOnlyEvaluatedToBuildItsMask) {
+	CountingPredicate pred;
+	std::vector<TestResource> expected;
+	for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ++ii)
+		if (ii % 100 == 0)
+			expected.push_back(ii);
+
+	std::vector<TestResource> const first(begin(pred), end(pred));
+	size_t const calls = CountingPredicate::calls;
+	EXPECT_EQ(size_t(TestResource::size), calls);
+
+	std::vector<TestResource> const second(begin(pred), end(pred));
+	EXPECT_EQ(calls, CountingPredicate::calls);
+	EXPECT_EQ(expected, first);
+	EXPECT_EQ(expected, second);
+	EXPECT_EQ(expected.size(), cardinality(pred));
+
+	EXPECT_THROW(PredicateIterator<CountingPredicate>(101, pred), std::invalid_argument);
+	EXPECT_NO_THROW(PredicateIterator<CountingPredicate>(200, pred));
+	EXPECT_EQ(calls, CountingPredicate::calls);
+}
@@ -1,7 +1,13 @@
+#include <sstream>
+#include <vector>
+
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/xml_oarchive.hpp>
+
 #include "redman/test/fixtures.h"
 
-TYPED_TEST_SUITE(AManager, PolicyTypes);
-TYPED_TEST_SUITE(AManagerWithEvenPredicate, PolicyTypes);
+TYPED_TEST_SUITE(AManager, ManagerTypes);
+TYPED_TEST_SUITE(AManagerWithEvenPredicate, ManagerTypes);
 
 using namespace redman;
 
@@ -35,6 +41,27 @@ TYPED_TEST(AManagerWithEvenPredicate, ThrowsWhenProvidedWithInvalidSet) {
 	ASSERT_ANY_THROW(manager.from_set(resources));
 }
 
+TYPED_TEST(AManagerWithEvenPredicate, IteratesOverValidResourcesOnly) {
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	manager.disable(4);
+	manager.disable(8);
+	manager.disable(1336);
+
+	std::vector<TestResource> disabled(
+		manager.begin_disabled(), manager.end_disabled());
+	std::vector<TestResource> const expected{4, 8, 1336};
+	ASSERT_EQ(expected, disabled);
+
+	size_t count = 0;
+	for (auto res : manager.enabled()) {
+		ASSERT_EQ(0, res.index % 2);
+		ASSERT_TRUE(manager.has(res));
+		++count;
+	}
+	ASSERT_EQ(manager.available(), count);
+}
+
 TYPED_TEST(AManager, StartsDisabledOrEnabledBasedOnPolicy) {
 	auto& manager = TestFixture::manager;
 	auto avail = manager.available();
@@ -167,11 +194,11 @@ struct TwoManagers : public ::testing::Test {
 		other.disable(324);
 	}
 
-	redman::ResourceManager<TestResource, T> manager;
-	redman::ResourceManager<TestResource, T> other;
+	TestManager<T> manager;
+	TestManager<T> other;
 };
 
-TYPED_TEST_SUITE(TwoManagers, PolicyTypes);
+TYPED_TEST_SUITE(TwoManagers, ManagerTypes);
 
 TYPED_TEST(TwoManagers, CanBeMerged) {
 	auto& manager = TestFixture::manager;
@@ -221,11 +248,11 @@ public:
 		lt300.enable_all();
 	}
 
-	redman::ResourceManager<TestResource, T, LessThanPredicate> lt200;
-	redman::ResourceManager<TestResource, T, LessThanPredicate> lt300;
+	TestManager<T, LessThanPredicate> lt200;
+	TestManager<T, LessThanPredicate> lt300;
 };
 
-TYPED_TEST_SUITE(TwoParameterizedManagers, PolicyTypes);
+TYPED_TEST_SUITE(TwoParameterizedManagers, ManagerTypes);
 
 TYPED_TEST(TwoParameterizedManagers, CanBeMergedEvenIfThisThrowsAwayElements) {
 	auto& lt200 = TestFixture::lt200;
@@ -245,3 +272,327 @@ TYPED_TEST(TwoParameterizedManagers, CanBeMergedEvenIfThisThrowsAwayElements) {
 
 	ASSERT_ANY_THROW(lt200.from_set(resources));
 }
+
+TYPED_TEST(AManager, SerializesSelectionIndependentOfStorage) {
+	typedef typename TypeParam::policy policy;
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	manager.disable(4);
+	manager.disable(1000);
+
+	std::stringstream stream;
+	{
+		boost::archive::xml_oarchive oa(stream);
+		oa << boost::serialization::make_nvp("manager", manager);
+	}
+
+	// Datasets written with std::set storage have to stay loadable.
+	redman::ResourceManager<TestResource, policy> sparse;
+	{
+		boost::archive::xml_iarchive ia(stream);
+		ia >> boost::serialization::make_nvp("manager", sparse);
+	}
+	ASSERT_EQ(TestResource::size - 2, sparse.available());
+	ASSERT_FALSE(sparse.has(4));
+	ASSERT_FALSE(sparse.has(1000));
+
+	std::stringstream back;
+	{
+		boost::archive::xml_oarchive oa(back);
+		oa << boost::serialization::make_nvp("manager", sparse);
+	}
+
+	TestManager<TypeParam> loaded;
+	{
+		boost::archive::xml_iarchive ia(back);
+		ia >> boost::serialization::make_nvp("manager", loaded);
+	}
+	ASSERT_EQ(manager.available(), loaded.available());
+	ASSERT_TRUE(std::equal(manager.begin(), manager.end(), loaded.begin()));
+}
+
+template <typename Manager>
+std::set<TestResource> enabled_set(Manager const& manager) {
+	return std::set<TestResource>(manager.begin(), manager.end());
+}
+
+TYPED_TEST(AManagerWithEvenPredicate, AgreesWithSetAlgebraOnEnabledResources) {
+	typedef TestManager<TypeParam, EvenPredicate> manager_type;
+
+	manager_type a, b;
+	a.enable_all();
+	b.enable_all();
+	for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ii += 2) {
+		if (ii % 3 == 0)
+			a.disable(ii);
+		if (ii % 5 == 0)
+			b.disable(ii);
+	}
+
+	auto const ea = enabled_set(a);
+	auto const eb = enabled_set(b);
+
+	auto check = [&](void (manager_type::*op)(manager_type const&),
+	                 std::set<TestResource> const& expected) {
+		manager_type result = a;
+		(result.*op)(b);
+		EXPECT_EQ(expected, enabled_set(result));
+		EXPECT_EQ(expected.size(), result.available());
+	};
+
+	std::set<TestResource> expected;
+	std::set_union(ea.begin(), ea.end(), eb.begin(), eb.end(),
+	               std::inserter(expected, expected.end()));
+	check(&manager_type::merge, expected);
+
+	expected.clear();
+	std::set_intersection(ea.begin(), ea.end(), eb.begin(), eb.end(),
+	                      std::inserter(expected, expected.end()));
+	check(&manager_type::intersection, expected);
+
+	expected.clear();
+	std::set_difference(ea.begin(), ea.end(), eb.begin(), eb.end(),
+	                    std::inserter(expected, expected.end()));
+	check(&manager_type::difference, expected);
+
+	expected.clear();
+	std::set_symmetric_difference(ea.begin(), ea.end(), eb.begin(), eb.end(),
+	                              std::inserter(expected, expected.end()));
+	check(&manager_type::symmetric_difference, expected);
+}
+
+TYPED_TEST(AManager, TakesOwnershipOfMovedSet) {
+	auto& manager = TestFixture::manager;
+	std::set<TestResource> resources{2, 4, 8};
+	manager.from_set(std::move(resources));
+	ASSERT_EQ(3, manager.available());
+	ASSERT_TRUE(manager.has(4));
+	ASSERT_FALSE(manager.has(5));
+}
+
+TYPED_TEST(TwoParameterizedManagers, IgnoresRejectedResourcesInSymmetricDifference) {
+	auto& lt200 = TestFixture::lt200;
+	auto& lt300 = TestFixture::lt300;
+
+	lt300.disable(100);
+	ASSERT_NO_THROW(lt200.symmetric_difference(lt300));
+	// 200 to 299 are enabled in lt300 only, but rejected by lt200
+	ASSERT_EQ(1, lt200.available());
+	ASSERT_TRUE(lt200.has(100));
+}
+
+TYPED_TEST(TwoParameterizedManagers, CanBeIntersectedAndDiffed) {
+	auto& lt200 = TestFixture::lt200;
+	auto& lt300 = TestFixture::lt300;
+
+	lt300.disable(100);
+	lt300.disable(250);
+	lt200.intersection(lt300);
+	ASSERT_FALSE(lt200.has(100));
+	ASSERT_EQ(200 - TestResource::begin - 1, lt200.available());
+
+	lt300.difference(lt200);
+	ASSERT_EQ(300 - 200 - 1, lt300.available());
+	ASSERT_FALSE(lt300.has(150));
+	ASSERT_TRUE(lt300.has(299));
+}
+
+TYPED_TEST(AManager, CanBeModifiedWhileIterating) {
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ii += 7)
+		manager.disable(ii);
+	size_t const disabled = TestResource::size - manager.available();
+
+	size_t visited = 0;
+	for (auto res : manager.disabled()) {
+		manager.enable(res);
+		++visited;
+	}
+	EXPECT_EQ(disabled, visited);
+	EXPECT_EQ(TestResource::size, manager.available());
+
+	visited = 0;
+	for (auto res : manager.enabled()) {
+		manager.disable(res);
+		++visited;
+	}
+	EXPECT_EQ(TestResource::size, visited);
+	EXPECT_EQ(0, manager.available());
+}
+
+TYPED_TEST(AManager, UsesIteratorsWithoutPredicateCalls) {
+	typedef TestManager<TypeParam> manager_type;
+	typedef redman::ComplementIterator<
+		redman::DefaultPredicate<TestResource>, typename manager_type::storage_type,
+		std::less<TestResource>, true> expected_complement;
+	static_assert(std::is_same<expected_complement, typename manager_type::complement_iterator>::value,
+	              "DefaultPredicate should not be evaluated during iteration");
+	static_assert(std::is_same<
+		typename manager_type::iterator_type,
+		typename std::conditional<
+			manager_type::policy::stores_enabled,
+			typename manager_type::stored_iterator,
+			typename manager_type::complement_iterator>::type>::value,
+		"enabled() walks the selection of whitelists");
+}
+
+template <typename Manager>
+void expect_order_statistics_match_iteration(Manager const& manager)
+{
+	std::vector<TestResource> const enabled(manager.begin(), manager.end());
+	ASSERT_EQ(manager.available(), enabled.size());
+
+	for (size_t k = 0; k < enabled.size(); ++k) {
+		ASSERT_EQ(enabled[k], manager.select(k));
+		ASSERT_EQ(k, manager.rank(enabled[k]));
+	}
+	EXPECT_THROW(manager.select(enabled.size()), std::out_of_range);
+
+	for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ii += 13) {
+		auto const it = std::lower_bound(enabled.begin(), enabled.end(), TestResource(ii));
+		ASSERT_EQ(size_t(it - enabled.begin()), manager.rank(ii));
+
+		auto const next = manager.next_enabled(ii);
+		auto const next_it = std::upper_bound(enabled.begin(), enabled.end(), TestResource(ii));
+		ASSERT_EQ(next_it != enabled.end(), bool(next));
+		if (next) {
+			ASSERT_EQ(*next_it, *next);
+		}
+
+		auto const prev = manager.prev_enabled(ii);
+		ASSERT_EQ(it != enabled.begin(), bool(prev));
+		if (prev) {
+			ASSERT_EQ(*std::prev(it), *prev);
+		}
+	}
+}
+
+TYPED_TEST(AManager, AnswersOrderStatisticsOnEnabledResources) {
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ii += 3)
+		manager.disable(ii);
+	expect_order_statistics_match_iteration(manager);
+
+	EXPECT_EQ(4, manager.count_range(10, 16));
+	EXPECT_EQ(0, manager.count_range(16, 10));
+	EXPECT_EQ(manager.available(), manager.count_range(TestResource::begin, TestResource::end - 1));
+	EXPECT_EQ(manager.available(), manager.rank(TestResource::end - 1));
+
+	manager.disable_all();
+	EXPECT_EQ(0, manager.rank(100));
+	EXPECT_FALSE(manager.next_enabled(TestResource::begin));
+	EXPECT_FALSE(manager.prev_enabled(TestResource::end - 1));
+	EXPECT_THROW(manager.select(0), std::out_of_range);
+}
+
+TYPED_TEST(AManagerWithEvenPredicate, AnswersOrderStatisticsOnEnabledResources) {
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ii += 10)
+		manager.disable(ii);
+	expect_order_statistics_match_iteration(manager);
+	EXPECT_EQ(3, manager.count_range(10, 18));
+}
+
+TYPED_TEST(TwoParameterizedManagers, AnswerOrderStatisticsOnEnabledResources) {
+	auto& lt200 = TestFixture::lt200;
+	lt200.disable(100);
+	lt200.disable(199);
+	expect_order_statistics_match_iteration(lt200);
+	EXPECT_EQ(200 - TestResource::begin - 2, lt200.count_range(TestResource::begin, 1000));
+	EXPECT_FALSE(lt200.next_enabled(198));
+}
+
+TYPED_TEST(AManager, EnablesAndDisablesBatchesOfResources) {
+	auto& manager = TestFixture::manager;
+	manager.disable_all();
+
+	std::vector<TestResource> batch;
+	for (TestResource::value_type ii = TestResource::end - 1; ii >= 100; ii -= 3)
+		batch.push_back(ii);
+	batch.push_back(1001);
+	ASSERT_EQ(batch.size() - 1, manager.enable_many(batch.begin(), batch.end(), switch_mode::NONTHROW));
+	EXPECT_EQ(batch.size() - 1, manager.available());
+
+	std::vector<bool> available;
+	manager.has_many(batch.begin(), batch.end(), std::back_inserter(available));
+	EXPECT_EQ(std::vector<bool>(batch.size(), true), available);
+
+	std::vector<TestResource> const some{TestResource::end - 1, 100, 101};
+	EXPECT_EQ(2, manager.disable_many(some.begin(), some.end(), switch_mode::NONTHROW));
+	EXPECT_FALSE(manager.has(101));
+	EXPECT_FALSE(manager.has(TestResource::end - 1));
+	EXPECT_TRUE(manager.has(104));
+	EXPECT_EQ(batch.size() - 3, manager.available());
+
+	for (auto res : batch)
+		manager.disable(res, switch_mode::NONTHROW);
+	EXPECT_EQ(0, manager.available());
+}
+
+TYPED_TEST(AManager, ReportsBatchFailuresWithoutModification) {
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	std::vector<TestResource> const disabled{5, 7};
+	manager.disable_many(disabled.begin(), disabled.end());
+
+	std::vector<TestResource> const batch{3, 5, 7};
+	EXPECT_THROW(manager.disable_many(batch.begin(), batch.end()), std::runtime_error);
+	EXPECT_TRUE(manager.has(3));
+	EXPECT_EQ(TestResource::size - 2, manager.available());
+
+	EXPECT_THROW(manager.enable_many(batch.begin(), batch.end()), std::runtime_error);
+	EXPECT_FALSE(manager.has(5));
+	EXPECT_EQ(1, manager.disable_many(batch.begin(), batch.end(), switch_mode::NONTHROW));
+}
+
+TYPED_TEST(AManagerWithEvenPredicate, ValidatesBatchesBeforeModification) {
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	std::vector<TestResource> const batch{2, 3, 4, 5};
+	EXPECT_THROW(manager.disable_many(batch.begin(), batch.end()), std::invalid_argument);
+	EXPECT_TRUE(manager.has(2));
+	EXPECT_TRUE(manager.has(4));
+	EXPECT_EQ(TestResource::size / 2, manager.available());
+
+	std::vector<bool> available;
+	EXPECT_THROW(manager.has_many(batch.begin(), batch.end(), std::back_inserter(available)),
+	             std::invalid_argument);
+}
+
+TYPED_TEST(AManager, SharesItsSelectionWithCopiesUntilModified) {
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	manager.disable(42);
+
+	auto copy = manager;
+	EXPECT_TRUE(copy.shares_selection(manager));
+	EXPECT_EQ(manager, copy);
+
+	copy.enable(42);
+	EXPECT_FALSE(copy.shares_selection(manager));
+	EXPECT_FALSE(manager.has(42));
+	EXPECT_TRUE(copy.has(42));
+
+	auto moved = std::move(copy);
+	EXPECT_TRUE(moved.has(42));
+	copy.disable(42);
+	EXPECT_FALSE(copy.has(42));
+	EXPECT_TRUE(moved.has(42));
+}
+
+TYPED_TEST(AManager, CanBeFrozenIntoAnIndependentSnapshot) {
+	auto& manager = TestFixture::manager;
+	manager.enable_all();
+	manager.disable(42);
+
+	auto const snapshot = freeze(manager);
+	EXPECT_FALSE(snapshot->shares_selection(manager));
+	EXPECT_EQ(manager, *snapshot);
+
+	manager.enable(42);
+	EXPECT_FALSE(snapshot->has(42));
+	EXPECT_EQ(TestResource::size - 1, snapshot->available());
+}
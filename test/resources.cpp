@@ -1,7 +1,20 @@
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/xml_oarchive.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include "redman/Published.h"
 #include "redman/backend/Backend.h"
+#include "redman/backend/CachingBackend.h"
+#include "redman/backend/MockBackend.h"
+#include "redman/backend/OverlayBackend.h"
+#include "redman/resources/FrozenWafer.h"
 #include "redman/resources/Wafer.h"
 #include "redman/resources/Hicann.h"
 #include "redman/resources/Fpga.h"
@@ -162,3 +175,530 @@ TEST(IntersectionTest, IntersectionWorks) {
 	ASSERT_FALSE(hicann_a.neurons()->has(nrn_0));
 	ASSERT_FALSE(hicann_a.neurons()->has(nrn_1));
 }
+
+TEST_F(AHicann, CanBeClonedIndependently) {
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+	hicann.neurons()->disable(nrn);
+
+	auto clone = hicann.clone();
+	ASSERT_TRUE(*clone == hicann);
+	ASSERT_NE(clone->neurons(), hicann.neurons());
+	ASSERT_TRUE(clone->neurons()->shares_selection(*hicann.neurons()));
+
+	clone->neurons()->enable(nrn);
+	ASSERT_TRUE(clone->neurons()->has(nrn));
+	ASSERT_FALSE(hicann.neurons()->has(nrn));
+	ASSERT_FALSE(clone->neurons()->shares_selection(*hicann.neurons()));
+	ASSERT_TRUE(clone->synapses()->shares_selection(*hicann.synapses()));
+}
+
+TEST_F(AWafer, ClonesComponentsAndCachedResources) {
+	HMFC::HICANNOnWafer const hicann{halco::common::Enum(7)};
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+	wafer.get(hicann)->neurons()->disable(nrn);
+
+	auto clone = wafer.clone();
+	clone->hicanns()->disable(hicann);
+	clone->set_get_behavior(Wafer::get_behavior(true));
+	clone->get(hicann)->neurons()->enable(nrn);
+
+	EXPECT_TRUE(wafer.has(hicann));
+	EXPECT_FALSE(wafer.get(hicann)->neurons()->has(nrn));
+	EXPECT_TRUE(clone->get(hicann)->neurons()->has(nrn));
+}
+
+TEST_F(AWafer, CanBeFrozenIntoAnIndependentSnapshot) {
+	HMFC::HICANNOnWafer const hicann{halco::common::Enum(7)};
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+	HMFC::FPGAOnWafer const fpga{halco::common::Enum(3)};
+	wafer.get(hicann)->neurons()->disable(nrn);
+	wafer.prefetch(std::vector<HMFC::HICANNOnWafer>(), {fpga});
+
+	auto const snapshot = wafer.freeze();
+	wafer.get(hicann)->neurons()->enable(nrn);
+	wafer.hicanns()->disable(hicann);
+
+	EXPECT_TRUE(snapshot->has(hicann));
+	ASSERT_TRUE(snapshot->get(hicann));
+	EXPECT_FALSE(snapshot->get(hicann)->neurons()->has(nrn));
+	EXPECT_EQ(384, snapshot->hicanns()->available());
+	EXPECT_TRUE(snapshot->get(fpga));
+	// resources that were not cached are not loaded
+	EXPECT_FALSE(snapshot->get(HMFC::HICANNOnWafer(halco::common::Enum(8))));
+	EXPECT_FALSE(snapshot->get(HMFC::FPGAOnWafer(halco::common::Enum(4))));
+}
+
+TEST_F(AWafer, PublishesSnapshotsToConcurrentReaders) {
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+	wafer.prefetch();
+	Published<FrozenWafer> current(wafer.freeze());
+
+	// Each published snapshot disables the neuron on exactly one enabled HICANN.
+	std::atomic<bool> done(false);
+	std::atomic<size_t> torn(0);
+	std::vector<std::thread> readers;
+	for (size_t ii = 0; ii < 4; ++ii) {
+		readers.emplace_back([&]() {
+			while (!done) {
+				auto const snapshot = current.read();
+				size_t disabled_neurons = 0;
+				for (auto h : snapshot->hicanns()->enabled())
+					disabled_neurons += !snapshot->get(h)->neurons()->has(nrn);
+				if (disabled_neurons != (snapshot->hicanns()->available() < 384 ? 1 : 0))
+					++torn;
+			}
+		});
+	}
+
+	for (size_t ii = 0; ii < 50; ++ii) {
+		HMFC::HICANNOnWafer const hicann{halco::common::Enum(ii)};
+		wafer.get(hicann)->neurons()->enable(nrn, switch_mode::NONTHROW);
+		wafer.hicanns()->disable(hicann);
+		wafer.get(HMFC::HICANNOnWafer(halco::common::Enum(ii + 1)))->neurons()->disable(nrn);
+		current.publish(wafer.freeze());
+	}
+	done = true;
+	for (auto& reader : readers)
+		reader.join();
+
+	EXPECT_EQ(0, torn);
+	EXPECT_EQ(384 - 50, current.load()->hicanns()->available());
+}
+
+namespace {
+
+/// Backend without data counting its loads, each of which takes a while.
+class SlowBackend : public Backend {
+public:
+	SlowBackend(size_t delay_ms = 20) : loads(0), delay(delay_ms) {}
+
+	void init() {}
+
+	void load(std::string const&, resources::Base&)
+	{
+		++loads;
+		std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+		throw not_found_error("no data");
+	}
+
+	void store(std::string const&, resources::Base const&) {}
+
+	std::atomic<size_t> loads;
+	size_t const delay;
+};
+
+} // anonymous
+
+TEST_F(AWafer, LoadsConcurrentlyRequestedResourcesOnlyOnce) {
+	auto const backend = boost::make_shared<SlowBackend>();
+	wafer.set_backend(HMFC::Wafer(), backend);
+	HMFC::HICANNOnWafer const hicann{halco::common::Enum(11)};
+	HMFC::FPGAOnWafer const fpga{halco::common::Enum(5)};
+
+	std::vector<boost::shared_ptr<Hicann> > hicanns(8);
+	std::vector<boost::shared_ptr<Fpga> > fpgas(8);
+	std::vector<std::thread> threads;
+	for (size_t ii = 0; ii < hicanns.size(); ++ii) {
+		threads.emplace_back([&, ii]() {
+			hicanns[ii] = wafer.get(hicann);
+			fpgas[ii] = wafer.get(fpga);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(2, backend->loads);
+	for (size_t ii = 0; ii < hicanns.size(); ++ii) {
+		ASSERT_TRUE(hicanns[ii]);
+		EXPECT_EQ(hicanns[0], hicanns[ii]);
+		EXPECT_EQ(fpgas[0], fpgas[ii]);
+	}
+
+	auto const injected = boost::make_shared<Hicann>();
+	wafer.inject(hicann, injected);
+	EXPECT_EQ(injected, wafer.get(hicann));
+	EXPECT_EQ(2, backend->loads);
+}
+
+TEST_F(AWafer, PrefetchesResourcesInParallel) {
+	auto const backend = boost::make_shared<SlowBackend>(1);
+	wafer.set_backend(HMFC::Wafer(), backend);
+	wafer.hicanns()->disable(HMFC::HICANNOnWafer(halco::common::Enum(3)));
+
+	wafer.prefetch(std::vector<HMFC::HICANNOnWafer>{
+		HMFC::HICANNOnWafer(halco::common::Enum(1)),
+		HMFC::HICANNOnWafer(halco::common::Enum(2))}, {}, 4);
+	EXPECT_EQ(2, backend->loads);
+
+	wafer.prefetch(4);
+	EXPECT_EQ(384 - 1 + 48, backend->loads);
+	EXPECT_FALSE(wafer.get(HMFC::HICANNOnWafer(halco::common::Enum(3))));
+	for (auto h : wafer.hicanns()->enabled())
+		EXPECT_TRUE(wafer.get(h));
+	EXPECT_EQ(384 - 1 + 48, backend->loads);
+}
+
+TEST_F(AWafer, SharesResourcesBetweenPrefetchAndConcurrentGets) {
+	auto const backend = boost::make_shared<SlowBackend>(1);
+	wafer.set_backend(HMFC::Wafer(), backend);
+	std::vector<HMFC::HICANNOnWafer> const hicanns(
+		wafer.hicanns()->begin(), wafer.hicanns()->end());
+
+	std::vector<std::vector<boost::shared_ptr<Hicann> > > results(
+		4, std::vector<boost::shared_ptr<Hicann> >(hicanns.size()));
+	std::vector<std::thread> threads;
+	threads.emplace_back([&]() { wafer.prefetch(hicanns, {}, 4); });
+	for (size_t ii = 0; ii < results.size(); ++ii) {
+		threads.emplace_back([&, ii]() {
+			for (size_t jj = 0; jj < hicanns.size(); ++jj)
+				results[ii][jj] = wafer.get(hicanns[(jj + 97 * ii) % hicanns.size()]);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(hicanns.size(), backend->loads);
+	for (size_t ii = 0; ii < results.size(); ++ii) {
+		for (size_t jj = 0; jj < hicanns.size(); ++jj)
+			EXPECT_EQ(wafer.get(hicanns[(jj + 97 * ii) % hicanns.size()]), results[ii][jj]);
+	}
+}
+
+TEST(AsyncBackendOperations, RoundTripResources) {
+	auto const backend = boost::make_shared<MockBackend>();
+	HMFC::HICANNGlobal const hicann(HMFC::HICANNOnWafer(halco::common::Enum(12)), HMFC::Wafer(3));
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+
+	auto const written = HicannWithBackend::create(backend, hicann);
+	written->neurons()->disable(nrn);
+	written->save_async().get();
+
+	auto loading = HicannWithBackend::create_async(backend, hicann, false);
+	auto const loaded = loading.get();
+	EXPECT_FALSE(loaded->neurons()->has(nrn));
+
+	auto missing = HicannWithBackend::create_async(
+		backend, HMFC::HICANNGlobal(HMFC::HICANNOnWafer(), HMFC::Wafer(3)), false);
+	EXPECT_THROW(missing.get(), not_found_error);
+
+	Wafer wafer(HMFC::Wafer(3));
+	wafer.set_backend(HMFC::Wafer(3), backend);
+	wafer.hicanns()->disable(HMFC::HICANNOnWafer());
+	wafer.save_async().get();
+
+	Wafer other(HMFC::Wafer(3));
+	other.set_backend(HMFC::Wafer(3), backend);
+	other.load_async().get();
+	EXPECT_FALSE(other.has(HMFC::HICANNOnWafer()));
+	auto const result = other.get_async(hicann.toHICANNOnWafer()).get();
+	ASSERT_TRUE(result);
+	EXPECT_FALSE(result->neurons()->has(nrn));
+	EXPECT_EQ(result, other.get_async(hicann.toHICANNOnWafer()).get());
+	EXPECT_FALSE(other.get_async(HMFC::HICANNOnWafer()).get());
+}
+
+namespace {
+
+/// Counts batched calls, storing data sets in memory.
+class BatchCountingBackend : public MockBackend {
+public:
+	BatchCountingBackend() : load_batches(0), store_batches(0) {}
+
+	std::vector<bool> load_many(
+		std::vector<std::string> const& ids, std::vector<resources::Base*> const& resources)
+	{
+		++load_batches;
+		return MockBackend::load_many(ids, resources);
+	}
+
+	void store_many(
+		std::vector<std::string> const& ids, std::vector<resources::Base const*> const& resources)
+	{
+		++store_batches;
+		MockBackend::store_many(ids, resources);
+	}
+
+	std::atomic<size_t> load_batches;
+	std::atomic<size_t> store_batches;
+};
+
+} // anonymous
+
+TEST(ABatchedBackend, LoadsAndStoresWholeWafersInFewCalls) {
+	auto const backend = boost::make_shared<BatchCountingBackend>();
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+
+	Wafer wafer(HMFC::Wafer(5));
+	wafer.set_backend(HMFC::Wafer(5), backend);
+	wafer.prefetch(2);
+	EXPECT_EQ(2, backend->load_batches);
+
+	for (auto h : wafer.hicanns()->enabled())
+		wafer.get(h)->neurons()->disable(nrn);
+	wafer.save_resources();
+	EXPECT_EQ(1, backend->store_batches);
+
+	Wafer other(HMFC::Wafer(5));
+	other.set_backend(HMFC::Wafer(5), backend);
+	other.prefetch(3);
+	EXPECT_EQ(2 + 3, backend->load_batches);
+	for (auto h : other.hicanns()->enabled())
+		EXPECT_FALSE(other.get(h)->neurons()->has(nrn));
+	// all resources are cached, nothing left to load
+	other.prefetch(3);
+	EXPECT_EQ(2 + 3, backend->load_batches);
+
+	auto const hicann = HicannWithBackend::create(
+		backend, HMFC::HICANNGlobal(HMFC::HICANNOnWafer(halco::common::Enum(7)), HMFC::Wafer(5)));
+	EXPECT_FALSE(hicann->neurons()->has(nrn));
+
+	Wafer strict(HMFC::Wafer(6));
+	strict.set_backend(HMFC::Wafer(6), backend, Wafer::backend_behavior(true, false, true));
+	EXPECT_THROW(strict.prefetch(2), not_found_error);
+	EXPECT_ANY_THROW(backend->load_many({"a", "b"}, {nullptr}));
+}
+
+namespace {
+
+/// Counts loads, reporting a revision that can be changed by the test.
+class RevisionedBackend : public MockBackend {
+public:
+	RevisionedBackend() : loads(0), current("1") {}
+
+	void load(std::string const& id, resources::Base& res)
+	{
+		++loads;
+		MockBackend::load(id, res);
+	}
+
+	std::string revision(std::string const&) const
+	{
+		return current;
+	}
+
+	std::atomic<size_t> loads;
+	std::string current;
+};
+
+} // anonymous
+
+TEST(ACachingBackend, ServesRepeatedLoadsFromMemory) {
+	auto const inner = boost::make_shared<RevisionedBackend>();
+	auto const backend = boost::make_shared<CachingBackend>(inner);
+	backend->init();
+	HMFC::HICANNGlobal const id(HMFC::HICANNOnWafer(halco::common::Enum(4)), HMFC::Wafer(2));
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+
+	HicannWithBackend::create(backend, id)->save();
+	for (size_t ii = 0; ii < 3; ++ii)
+		EXPECT_TRUE(HicannWithBackend::create(backend, id, false)->neurons()->has(nrn));
+	// one load finding nothing before saving, one after
+	EXPECT_EQ(2, inner->loads);
+
+	// stores through the cache drop the entry
+	auto const hicann = HicannWithBackend::create(backend, id);
+	hicann->neurons()->disable(nrn);
+	hicann->save();
+	EXPECT_FALSE(HicannWithBackend::create(backend, id, false)->neurons()->has(nrn));
+	EXPECT_EQ(3, inner->loads);
+
+	// changed behind the cache's back
+	Hicann changed;
+	inner->store(HicannWithBackend::backend_id(id), changed);
+	EXPECT_FALSE(HicannWithBackend::create(backend, id, false)->neurons()->has(nrn));
+	inner->current = "2";
+	EXPECT_TRUE(HicannWithBackend::create(backend, id, false)->neurons()->has(nrn));
+	EXPECT_EQ(4, inner->loads);
+
+	auto const stats = backend->statistics();
+	EXPECT_EQ(4, stats.hits);
+	EXPECT_EQ(4, stats.misses);
+	EXPECT_EQ(2, stats.invalidations);
+	EXPECT_EQ(1, stats.entries);
+	EXPECT_LT(0, stats.bytes);
+
+	Hicann missing;
+	EXPECT_THROW(backend->load("missing", missing), not_found_error);
+	EXPECT_EQ(1, backend->statistics().entries);
+
+	backend->config("cache_size", 1);
+	backend->init();
+	EXPECT_EQ(0, backend->statistics().entries);
+	EXPECT_EQ(1, backend->statistics().evictions);
+	EXPECT_TRUE(HicannWithBackend::create(backend, id, false)->neurons()->has(nrn));
+	EXPECT_EQ(0, backend->statistics().entries);
+
+	// sizes may be configured as string, also beyond the range of int
+	backend->config("cache_size", "8589934592");
+	EXPECT_NO_THROW(backend->init());
+	backend->config("cache_size", "-1");
+	EXPECT_THROW(backend->init(), std::invalid_argument);
+	backend->config("cache_size", "64M");
+	EXPECT_THROW(backend->init(), std::invalid_argument);
+	backend->config("cache_size", -1);
+	EXPECT_THROW(backend->init(), std::invalid_argument);
+}
+
+TEST(ACachingBackend, LoadsOnlyUncachedDataSetsInBatches) {
+	auto const inner = boost::make_shared<RevisionedBackend>();
+	auto const backend = boost::make_shared<CachingBackend>(inner);
+	backend->init();
+
+	Wafer wafer(HMFC::Wafer(5));
+	wafer.set_backend(HMFC::Wafer(5), backend);
+	wafer.prefetch(2);
+	wafer.save_resources();
+	size_t const loads = inner->loads;
+
+	Wafer other(HMFC::Wafer(5));
+	other.set_backend(HMFC::Wafer(5), backend);
+	other.prefetch(2);
+	EXPECT_EQ(loads + 384 + 48, inner->loads);
+	backend->reset_statistics();
+
+	Wafer cached(HMFC::Wafer(5));
+	cached.set_backend(HMFC::Wafer(5), backend);
+	cached.prefetch(2);
+	EXPECT_EQ(loads + 384 + 48, inner->loads);
+	EXPECT_EQ(384 + 48, backend->statistics().hits);
+
+	backend->clear();
+	EXPECT_EQ(0, backend->statistics().entries);
+	EXPECT_EQ(0, backend->statistics().bytes);
+}
+
+TEST(ACachingBackend, IsArchivedWithItsWrappedBackend) {
+	auto const backend = boost::make_shared<CachingBackend>(boost::make_shared<MockBackend>());
+	backend->init();
+	HMFC::HICANNGlobal const id(HMFC::HICANNOnWafer(halco::common::Enum(4)), HMFC::Wafer(2));
+	HMFC::NeuronOnHICANN const nrn{halco::common::Enum(3)};
+	auto const hicann = HicannWithBackend::create(backend, id);
+	hicann->neurons()->disable(nrn);
+	hicann->save();
+
+	Wafer wafer(HMFC::Wafer(2));
+	wafer.set_backend(HMFC::Wafer(2), backend);
+	std::stringstream stream;
+	{
+		boost::archive::xml_oarchive oa(stream);
+		oa << boost::serialization::make_nvp("wafer", wafer);
+	}
+	Wafer restored;
+	{
+		boost::archive::xml_iarchive ia(stream);
+		ia >> boost::serialization::make_nvp("wafer", restored);
+	}
+	EXPECT_FALSE(restored.get(id.toHICANNOnWafer())->neurons()->has(nrn));
+}
+
+class AnOverlayBackend : public ::testing::Test {
+public:
+	AnOverlayBackend() :
+		top(boost::make_shared<MockBackend>()),
+		base(boost::make_shared<MockBackend>()),
+		overlay(boost::make_shared<OverlayBackend>(
+			std::vector<boost::shared_ptr<Backend> >{top, base})),
+		id(HMFC::HICANNOnWafer(halco::common::Enum(9)), HMFC::Wafer(4)),
+		shared{halco::common::Enum(1)},
+		local{halco::common::Enum(2)}
+	{
+		auto const hicann = HicannWithBackend::create(base, id);
+		hicann->neurons()->disable(shared);
+		hicann->save();
+		overlay->init();
+	}
+
+	boost::shared_ptr<MockBackend> top;
+	boost::shared_ptr<MockBackend> base;
+	boost::shared_ptr<OverlayBackend> overlay;
+	HMFC::HICANNGlobal id;
+	HMFC::NeuronOnHICANN shared;
+	HMFC::NeuronOnHICANN local;
+};
+
+TEST_F(AnOverlayBackend, StoresToTheTopLayerOnly) {
+	auto const hicann = HicannWithBackend::create(overlay, id, false);
+	EXPECT_FALSE(hicann->neurons()->has(shared));
+	hicann->neurons()->enable(shared);
+	hicann->neurons()->disable(local);
+	hicann->save();
+
+	auto const loaded = HicannWithBackend::create(overlay, id, false);
+	EXPECT_TRUE(loaded->neurons()->has(shared));
+	EXPECT_FALSE(loaded->neurons()->has(local));
+	EXPECT_FALSE(HicannWithBackend::create(base, id, false)->neurons()->has(shared));
+	EXPECT_TRUE(HicannWithBackend::create(base, id, false)->neurons()->has(local));
+
+	Wafer wafer(HMFC::Wafer(4));
+	wafer.set_backend(HMFC::Wafer(4), overlay, Wafer::backend_behavior(true, false, true));
+	wafer.prefetch({id.toHICANNOnWafer()}, {}, 1);
+	EXPECT_FALSE(wafer.get(id.toHICANNOnWafer())->neurons()->has(local));
+	EXPECT_THROW(
+		HicannWithBackend::create(overlay, HMFC::HICANNGlobal(HMFC::HICANNOnWafer(), HMFC::Wafer(4)), false),
+		not_found_error);
+}
+
+TEST_F(AnOverlayBackend, CombinesLayersPerComponent) {
+	auto const hicann = HicannWithBackend::create(top, id);
+	hicann->neurons()->disable(local);
+	hicann->save();
+
+	overlay->config("mode", "intersection");
+	overlay->init();
+	auto intersected = HicannWithBackend::create(overlay, id, false);
+	EXPECT_FALSE(intersected->neurons()->has(shared));
+	EXPECT_FALSE(intersected->neurons()->has(local));
+
+	overlay->config("mode", "merge");
+	overlay->init();
+	auto merged = HicannWithBackend::create(overlay, id, false);
+	EXPECT_TRUE(merged->neurons()->has(shared));
+	EXPECT_TRUE(merged->neurons()->has(local));
+
+	overlay->config("mode", "union");
+	EXPECT_THROW(overlay->init(), std::invalid_argument);
+}
+
+TEST_F(AnOverlayBackend, LoadsDataSetsSpreadOverTheLayers) {
+	HMFC::HICANNGlobal const other(HMFC::HICANNOnWafer(halco::common::Enum(10)), HMFC::Wafer(4));
+	auto const hicann = HicannWithBackend::create(top, other);
+	hicann->neurons()->disable(local);
+	hicann->save();
+
+	std::vector<std::string> const ids{
+		HicannWithBackend::backend_id(id), HicannWithBackend::backend_id(other),
+		HicannWithBackend::backend_id(HMFC::HICANNGlobal(HMFC::HICANNOnWafer(), HMFC::Wafer(4)))};
+	for (std::string const mode : {"first", "intersection", "merge"}) {
+		overlay->config("mode", mode);
+		overlay->init();
+		Hicann from_base, from_top, missing;
+		auto const found = overlay->load_many(ids, {&from_base, &from_top, &missing});
+		EXPECT_EQ((std::vector<bool>{true, true, false}), found) << mode;
+		EXPECT_FALSE(from_base.neurons()->has(shared)) << mode;
+		EXPECT_TRUE(from_base.neurons()->has(local)) << mode;
+		EXPECT_TRUE(from_top.neurons()->has(shared)) << mode;
+		EXPECT_FALSE(from_top.neurons()->has(local)) << mode;
+	}
+}
+
+TEST_F(AnOverlayBackend, IsArchivedWithItsLayers) {
+	overlay->config("mode", "merge");
+	overlay->init();
+
+	std::stringstream stream;
+	{
+		boost::archive::xml_oarchive oa(stream);
+		boost::shared_ptr<Backend> const archived = overlay;
+		oa << boost::serialization::make_nvp("backend", archived);
+	}
+	boost::shared_ptr<Backend> restored;
+	{
+		boost::archive::xml_iarchive ia(stream);
+		ia >> boost::serialization::make_nvp("backend", restored);
+	}
+	auto const restored_overlay = boost::dynamic_pointer_cast<OverlayBackend>(restored);
+	ASSERT_TRUE(restored_overlay);
+	EXPECT_EQ(OverlayBackend::MERGE, restored_overlay->mode());
+	EXPECT_EQ(2, restored_overlay->layers().size());
+	EXPECT_FALSE(HicannWithBackend::create(restored, id, false)->neurons()->has(shared));
+}
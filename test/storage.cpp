@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "redman/test/fixtures.h"
+#include "redman/storage/Adaptive.h"
+#include "redman/storage/Compressed.h"
+#include "redman/storage/Flat.h"
+#include "redman/storage/kernels.h"
+
+using namespace redman::storage;
+
+namespace {
+
+std::vector<kernels::word_type> random_words(std::mt19937_64& rng, size_t n)
+{
+	std::vector<kernels::word_type> words(n);
+	for (auto& w : words)
+		w = rng();
+	return words;
+}
+
+typedef std::size_t (*binary_kernel)(kernels::word_type*, kernels::word_type const*, std::size_t);
+
+void expect_same_result(binary_kernel expected, binary_kernel actual, char const* name)
+{
+	std::mt19937_64 rng(42);
+	for (size_t n = 0; n < 23; ++n) {
+		auto const src = random_words(rng, n);
+		auto lhs = random_words(rng, n);
+		auto rhs = lhs;
+		size_t const expected_count = expected(lhs.data(), src.data(), n);
+		size_t const actual_count = actual(rhs.data(), src.data(), n);
+		EXPECT_EQ(lhs, rhs) << name << ", " << n << " words";
+		EXPECT_EQ(expected_count, actual_count) << name << ", " << n << " words";
+		EXPECT_EQ(kernels::scalar().popcount(lhs.data(), n), actual_count);
+	}
+}
+
+} // anonymous
+
+TEST(BitsetKernels, AgreeWithTheScalarImplementation) {
+	auto const& ref = kernels::scalar();
+	std::mt19937_64 rng(23);
+
+	for (auto impl = kernels::supported(); impl->name; ++impl) {
+		SCOPED_TRACE(impl->name);
+		expect_same_result(ref.merge, impl->merge, "merge");
+		expect_same_result(ref.intersection, impl->intersection, "intersection");
+		expect_same_result(ref.difference, impl->difference, "difference");
+		expect_same_result(ref.symmetric_difference, impl->symmetric_difference,
+		                   "symmetric_difference");
+		expect_same_result(ref.merge_complement, impl->merge_complement, "merge_complement");
+		expect_same_result(ref.symmetric_difference_complement,
+		                   impl->symmetric_difference_complement,
+		                   "symmetric_difference_complement");
+
+		for (size_t n = 0; n < 23; ++n) {
+			auto const a = random_words(rng, n);
+			EXPECT_EQ(ref.popcount(a.data(), n), impl->popcount(a.data(), n));
+			EXPECT_TRUE(impl->equal(a.data(), a.data(), n));
+			for (size_t ii = 0; ii < n; ++ii) {
+				auto b = a;
+				b[ii] ^= kernels::word_type(1) << (ii % 64);
+				EXPECT_FALSE(impl->equal(a.data(), b.data(), n));
+			}
+		}
+	}
+}
+
+TEST(BitsetKernels, UseTheFastestSupportedImplementation) {
+	auto impl = kernels::supported();
+	while ((impl + 1)->name)
+		++impl;
+	EXPECT_EQ(impl, &kernels::active());
+}
+
+TEST(ABitsetSelection, KeepsComplementsWithinTheIndexRange) {
+	typedef redman::DefaultPredicate<TestResource> predicate_type;
+	typedef BitsetSelection<TestResource, predicate_type, std::less<TestResource> > selection_type;
+
+	selection_type selection, other;
+	other.insert(TestResource::begin);
+	other.insert(100);
+	other.insert(TestResource::end - 1);
+
+	selection.merge_complement(other);
+	EXPECT_EQ(TestResource::size - 3, selection.size());
+	EXPECT_EQ(TestResource(TestResource::begin + 1), *selection.begin());
+	EXPECT_FALSE(selection.count(100));
+
+	selection.symmetric_difference_complement(other);
+	EXPECT_TRUE(selection.empty());
+	EXPECT_EQ(selection.end(), selection.begin());
+}
+
+TEST(ABitsetSelection, KeepsItsRankDirectoryUpToDate) {
+	typedef redman::DefaultPredicate<TestResource> predicate_type;
+	typedef BitsetSelection<TestResource, predicate_type, std::less<TestResource> > selection_type;
+
+	selection_type selection, other;
+	for (TestResource::value_type ii = TestResource::begin; ii < TestResource::end; ii += 5)
+		selection.insert(ii);
+	selection.erase(TestResource::begin + 5);
+	other.insert(TestResource::begin + 1);
+	selection.merge(other);
+
+	std::vector<TestResource> const stored(selection.begin(), selection.end());
+	for (std::size_t k = 0; k < stored.size(); ++k) {
+		ASSERT_EQ(stored[k], selection.select(k));
+		ASSERT_EQ(k, selection.rank(stored[k]));
+	}
+	EXPECT_EQ(stored.size() - 1, selection.rank(TestResource::end - 1));
+	EXPECT_EQ(TestResource(TestResource::begin + 1), *selection.prev(TestResource::begin + 10));
+	EXPECT_FALSE(selection.prev(TestResource::begin));
+}
+
+TEST(ABitsetSelection, RebuildsItsRankDirectoryAfterSingleModifications) {
+	typedef redman::DefaultPredicate<TestResource> predicate_type;
+	typedef BitsetSelection<TestResource, predicate_type, std::less<TestResource> > selection_type;
+
+	selection_type selection;
+	selection.insert(TestResource::end - 1);
+	EXPECT_EQ(0u, selection.rank(TestResource::end - 1));
+	selection.insert(TestResource::begin);
+	selection.insert(700);
+	selection.erase(700);
+	selection.insert(900);
+
+	// copies of an outdated directory are rebuilt
+	selection_type const copy(selection);
+	selection_type const* const selections[] = {&selection, &copy};
+	for (auto const sel : selections) {
+		EXPECT_EQ(1u, sel->rank(900));
+		EXPECT_EQ(2u, sel->rank(TestResource::end - 1));
+		EXPECT_EQ(TestResource(900), sel->select(1));
+		EXPECT_EQ(TestResource(TestResource::end - 1), sel->select(2));
+	}
+}
+
+TEST(ACompressedChunk, BehavesLikeASetInEveryRepresentation) {
+	std::mt19937 rng(7);
+	CompressedChunk chunk;
+	std::set<CompressedChunk::size_type> reference;
+
+	auto check = [&]() {
+		ASSERT_EQ(reference.size(), chunk.size());
+		CompressedChunk::size_type pos = chunk.next(0);
+		for (auto val : reference) {
+			ASSERT_EQ(val, pos);
+			pos = chunk.next(pos + 1);
+		}
+		ASSERT_EQ(CompressedChunk::capacity, pos);
+	};
+
+	// sparse values
+	for (int ii = 0; ii < 1000; ++ii) {
+		CompressedChunk::value_type const val = rng() % CompressedChunk::capacity;
+		EXPECT_EQ(reference.insert(val).second, chunk.insert(val));
+	}
+	EXPECT_EQ(CompressedChunk::ARRAY, chunk.kind());
+	check();
+
+	// dense values
+	for (int ii = 0; ii < 20000; ++ii) {
+		CompressedChunk::value_type const val = rng() % CompressedChunk::capacity;
+		EXPECT_EQ(reference.insert(val).second, chunk.insert(val));
+	}
+	EXPECT_EQ(CompressedChunk::BITMAP, chunk.kind());
+	check();
+
+	for (int ii = 0; ii < 40000; ++ii) {
+		CompressedChunk::value_type const val = rng() % CompressedChunk::capacity;
+		EXPECT_EQ(reference.erase(val) != 0, chunk.erase(val));
+		EXPECT_EQ(reference.count(val) != 0, chunk.contains(val));
+	}
+	check();
+
+	// a few long runs
+	chunk.fill(100, 50000);
+	reference.clear();
+	for (CompressedChunk::size_type ii = 100; ii < 50000; ++ii)
+		reference.insert(ii);
+	for (CompressedChunk::value_type val : {20000, 20001, 30000, 99, 50000, 50002}) {
+		EXPECT_EQ(reference.count(val) != 0, chunk.erase(val));
+		EXPECT_TRUE(chunk.insert(val));
+		EXPECT_TRUE(chunk.erase(val));
+		reference.erase(val);
+	}
+	EXPECT_EQ(CompressedChunk::RUN, chunk.kind());
+	EXPECT_GT(100u, chunk.memory());
+	check();
+
+	EXPECT_EQ(0u, chunk.rank(100));
+	EXPECT_EQ(20000u - 100, chunk.rank(20001));
+	EXPECT_EQ(reference.size(), chunk.rank(CompressedChunk::capacity));
+}
+
+TEST(ACompressedChunk, SupportsSetAlgebraAcrossRepresentations) {
+	std::mt19937 rng(11);
+	std::vector<CompressedChunk> chunks(4);
+	std::vector<std::set<CompressedChunk::size_type> > references(4);
+
+	for (size_t ii = 0; ii < 100; ++ii)
+		references[0].insert(rng() % CompressedChunk::capacity);
+	for (size_t ii = 0; ii < 30000; ++ii)
+		references[1].insert(rng() % CompressedChunk::capacity);
+	for (CompressedChunk::size_type ii = 1000; ii < 40000; ++ii)
+		references[2].insert(ii);
+	for (size_t ii = 0; ii < 3000; ++ii)
+		references[3].insert(rng() % 2000 + 30000);
+
+	for (size_t ii = 0; ii < chunks.size(); ++ii) {
+		for (auto val : references[ii])
+			chunks[ii].insert(static_cast<CompressedChunk::value_type>(val));
+		chunks[ii].optimize();
+	}
+
+	typedef std::set<CompressedChunk::size_type> set_type;
+	auto to_set = [](CompressedChunk const& chunk) {
+		set_type result;
+		for (auto pos = chunk.next(0); pos < CompressedChunk::capacity; pos = chunk.next(pos + 1))
+			result.insert(pos);
+		return result;
+	};
+
+	for (size_t a = 0; a < chunks.size(); ++a) {
+		for (size_t b = 0; b < chunks.size(); ++b) {
+			auto const& ra = references[a];
+			auto const& rb = references[b];
+			set_type expected;
+			auto out = std::inserter(expected, expected.end());
+
+			CompressedChunk result = chunks[a];
+			result.merge(chunks[b]);
+			std::set_union(ra.begin(), ra.end(), rb.begin(), rb.end(), out);
+			EXPECT_EQ(expected, to_set(result)) << a << " | " << b;
+			EXPECT_EQ(expected.size(), result.size());
+
+			expected.clear();
+			result = chunks[a];
+			result.intersection(chunks[b]);
+			std::set_intersection(ra.begin(), ra.end(), rb.begin(), rb.end(), out);
+			EXPECT_EQ(expected, to_set(result)) << a << " & " << b;
+
+			expected.clear();
+			result = chunks[a];
+			result.difference(chunks[b]);
+			std::set_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), out);
+			EXPECT_EQ(expected, to_set(result)) << a << " - " << b;
+
+			expected.clear();
+			result = chunks[a];
+			result.symmetric_difference(chunks[b]);
+			std::set_symmetric_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), out);
+			EXPECT_EQ(expected, to_set(result)) << a << " ^ " << b;
+			EXPECT_EQ(expected.size(), result.size());
+			if (a == b)
+				EXPECT_TRUE(result.empty());
+			else
+				EXPECT_NE(chunks[a], chunks[b]);
+		}
+	}
+}
+
+TEST(ACompressedSelection, CountsStoredResourcesInRanges) {
+	typedef redman::DefaultPredicate<TestResource> predicate_type;
+	CompressedSelection<TestResource, predicate_type, std::less<TestResource> > selection;
+
+	for (TestResource::value_type ii = 10; ii < 20; ++ii)
+		selection.insert(ii);
+	selection.insert(500);
+
+	EXPECT_EQ(0u, selection.rank(10));
+	EXPECT_EQ(5u, selection.rank(15));
+	EXPECT_EQ(10u, selection.rank(499));
+	EXPECT_EQ(11u, selection.rank(501));
+	EXPECT_EQ(3u, selection.count_range(12, 15));
+	EXPECT_EQ(2u, selection.count_range(19, 1000));
+	EXPECT_EQ(0u, selection.count_range(15, 12));
+}
+
+TEST(AnAdaptiveSelection, SwitchesRepresentationWithDensity) {
+	typedef redman::DefaultPredicate<TestResource> predicate_type;
+	typedef AdaptiveSelection<TestResource, predicate_type, std::less<TestResource> > selection_type;
+	selection_type selection;
+	std::set<TestResource> reference;
+
+	TestResource::value_type ii = TestResource::begin;
+	for (; reference.size() <= selection_type::dense_limit; ii += 3) {
+		EXPECT_FALSE(selection.dense());
+		selection.insert(ii);
+		reference.insert(ii);
+	}
+	EXPECT_TRUE(selection.dense());
+	EXPECT_TRUE(std::equal(reference.begin(), reference.end(), selection.begin()));
+
+	selection_type const copy = selection;
+	EXPECT_TRUE(copy.dense());
+	EXPECT_EQ(selection, copy);
+
+	while (reference.size() >= selection_type::dense_limit / 2) {
+		EXPECT_TRUE(selection.dense());
+		EXPECT_EQ(1u, selection.erase(*reference.begin()));
+		reference.erase(reference.begin());
+	}
+	EXPECT_FALSE(selection.dense());
+	EXPECT_EQ(reference.size(), selection.size());
+	EXPECT_TRUE(std::equal(reference.begin(), reference.end(), selection.begin()));
+
+	// equal content in different representations
+	selection_type sparse;
+	sparse.assign(reference.begin(), reference.end());
+	selection_type dense = copy;
+	dense.intersection(sparse);
+	EXPECT_EQ(sparse, dense);
+}
+
+TEST(AFlatSelection, AcceptsHintedInsertionAtAnyPosition) {
+	typedef redman::DefaultPredicate<TestResource> predicate_type;
+	FlatSelection<TestResource, predicate_type, std::less<TestResource> > selection;
+
+	selection.insert(selection.end(), 10);
+	selection.insert(selection.end(), 20);
+	selection.insert(selection.end(), 5);
+	selection.insert(selection.begin(), 15);
+	selection.insert(selection.begin(), 15);
+
+	std::vector<TestResource> const expected{5, 10, 15, 20};
+	EXPECT_TRUE(std::equal(expected.begin(), expected.end(), selection.begin()));
+	EXPECT_EQ(expected.size(), selection.size());
+}
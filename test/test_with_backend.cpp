@@ -3,9 +3,6 @@
 
 using namespace redman::backend;
 
-boost::shared_ptr<Backend> TestWithBackend<XMLBackend>::backend;
-boost::filesystem::path TestWithBackend<XMLBackend>::backendPath;
-
 boost::shared_ptr<Backend> init_backend(std::string const& fname) {
 	auto lib = loadLibrary(fname);
 	boost::shared_ptr<Backend> backend = loadBackend(lib);